@@ -23,22 +23,42 @@
 #include "amcl-extensions/ecp_ZZZ.h"
 #include "amcl-extensions/ecp2_ZZZ.h"
 
+#include <ecdaa/basename_session_ZZZ.h>
 #include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/member_bundle_ZZZ.h>
 #include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/merkle_batch_ZZZ.h>
 #include <ecdaa/credential_ZZZ.h>
 #include <ecdaa/issuer_keypair_ZZZ.h>
 #include <ecdaa/signature_ZZZ.h>
 #include <ecdaa/group_public_key_ZZZ.h>
 #include <ecdaa/revocations_ZZZ.h>
+#include <ecdaa/verifier_kit_ZZZ.h>
+#include <ecdaa/verify_cache_ZZZ.h>
 #include <ecdaa/rand.h>
 
 #include <sys/time.h>
 #include <string.h>
 
+static void mul_glv_benchmark();
+static void mul_secret_benchmark();
+static void mul_secret_multi_benchmark();
+static void batch_affine_benchmark();
+
 static void schnorr_sign_benchmark();
 
 static void sign_benchmark();
+static void sign_with_session_benchmark();
+static void member_startup_benchmark();
 static void verify_benchmark();
+static void verify_with_issuer_key_benchmark();
+static void verify_multi_group_benchmark();
+static void verify_cache_hit_benchmark();
+static void verifier_warmup_benchmark();
+static void reject_invalid_benchmark();
+static void batch_verify_benchmark();
+static void merkle_batch_sign_benchmark();
+static void merkle_batch_verify_message_benchmark();
 
 typedef struct sign_and_verify_fixture {
     uint8_t *msg;
@@ -58,10 +78,25 @@ static void teardown(sign_and_verify_fixture* fixture);
 
 int main()
 {
+    mul_glv_benchmark();
+    mul_secret_benchmark();
+    mul_secret_multi_benchmark();
+    batch_affine_benchmark();
+
     schnorr_sign_benchmark();
 
     sign_benchmark();
+    sign_with_session_benchmark();
+    member_startup_benchmark();
     verify_benchmark();
+    verify_with_issuer_key_benchmark();
+    verify_multi_group_benchmark();
+    verify_cache_hit_benchmark();
+    verifier_warmup_benchmark();
+    reject_invalid_benchmark();
+    batch_verify_benchmark();
+    merkle_batch_sign_benchmark();
+    merkle_batch_verify_message_benchmark();
 }
 
 static void setup(sign_and_verify_fixture* fixture)
@@ -98,6 +133,157 @@ static void teardown(sign_and_verify_fixture* fixture)
     (void)fixture;
 }
 
+static void mul_glv_benchmark()
+{
+    unsigned rounds = 2500;
+
+    printf("Starting ecp::mul_glv_benchmark (%u iterations)...\n", rounds);
+
+    BIG_XXX scalar;
+    ecp_ZZZ_random_mod_order(&scalar, benchmark_randomness);
+
+    ECP_ZZZ point;
+    ecp_ZZZ_set_to_generator(&point);
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        ecp_ZZZ_mul_glv(&point, scalar);
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("%llu usec (%6llu muls/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void mul_secret_multi_benchmark()
+{
+    unsigned rounds = 2500;
+
+    printf("Starting ecp::mul_secret_multi_benchmark (%u iterations, %u points)...\n", rounds, ECP_ZZZ_MUL_SECRET_MULTI_MAX);
+
+    BIG_XXX scalar;
+    ecp_ZZZ_random_mod_order(&scalar, benchmark_randomness);
+
+    ECP_ZZZ points[ECP_ZZZ_MUL_SECRET_MULTI_MAX];
+    ECP_ZZZ *point_ptrs[ECP_ZZZ_MUL_SECRET_MULTI_MAX];
+    for (unsigned j = 0; j < ECP_ZZZ_MUL_SECRET_MULTI_MAX; j++) {
+        ecp_ZZZ_set_to_generator(&points[j]);
+        point_ptrs[j] = &points[j];
+    }
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        ecp_ZZZ_mul_secret_multi(point_ptrs, ECP_ZZZ_MUL_SECRET_MULTI_MAX, scalar, benchmark_randomness);
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("%llu usec (%6llu point-muls/s)\n",
+            elapsed,
+            rounds * ECP_ZZZ_MUL_SECRET_MULTI_MAX * 1000000ULL / elapsed);
+}
+
+static void mul_secret_benchmark()
+{
+    unsigned rounds = 2500;
+
+    printf("Starting ecp::mul_secret_benchmark (%u iterations)...\n", rounds);
+
+    BIG_XXX scalar;
+    ecp_ZZZ_random_mod_order(&scalar, benchmark_randomness);
+
+    ECP_ZZZ point;
+    ecp_ZZZ_set_to_generator(&point);
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        ecp_ZZZ_mul_secret(&point, scalar, benchmark_randomness);
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("%llu usec (%6llu muls/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void batch_affine_benchmark()
+{
+    enum { num_points = ECP_ZZZ_BATCH_AFFINE_CHUNK };
+    unsigned rounds = 250;
+
+    printf("Starting ecp::batch_affine_benchmark (%u iterations of %u points)...\n", rounds, num_points);
+
+    ECP_ZZZ generator;
+    ecp_ZZZ_set_to_generator(&generator);
+
+    // Projective points (ie. z != 1)
+    ECP_ZZZ projective[num_points];
+    ECP_ZZZ_copy(&projective[0], &generator);
+    ECP_ZZZ_dbl(&projective[0]);
+    for (unsigned j = 1; j < num_points; j++) {
+        ECP_ZZZ_copy(&projective[j], &projective[j-1]);
+        ECP_ZZZ_add(&projective[j], &generator);
+    }
+
+    ECP_ZZZ points[num_points];
+    ECP_ZZZ *point_ptrs[num_points];
+    for (unsigned j = 0; j < num_points; j++)
+        point_ptrs[j] = &points[j];
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        for (unsigned j = 0; j < num_points; j++) {
+            ECP_ZZZ_copy(&points[j], &projective[j]);
+            ECP_ZZZ_affine(&points[j]);
+        }
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("one at a time: %llu usec (%6llu points/s)\n",
+            elapsed,
+            rounds * num_points * 1000000ULL / elapsed);
+
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        for (unsigned j = 0; j < num_points; j++)
+            ECP_ZZZ_copy(&points[j], &projective[j]);
+        ecp_ZZZ_batch_affine(point_ptrs, num_points);
+    }
+
+    gettimeofday(&tv2, NULL);
+    elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("batched:       %llu usec (%6llu points/s)\n",
+            elapsed,
+            rounds * num_points * 1000000ULL / elapsed);
+}
+
 void schnorr_sign_benchmark()
 {
     unsigned rounds = 2500;
@@ -163,6 +349,106 @@ static void sign_benchmark()
             rounds * 1000000ULL / elapsed);
 }
 
+static void sign_with_session_benchmark()
+{
+    unsigned rounds = 250;
+
+    printf("Starting sign-and-verify::sign_with_session_benchmark (%u iterations)...\n", rounds);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_basename_session_ZZZ session;
+    BENCHMARK_ASSERT(0 == ecdaa_basename_session_ZZZ_init(&session, fixture.basename, fixture.basename_len, &fixture.sk, benchmark_randomness));
+
+    struct ecdaa_signature_ZZZ sig;
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign_with_session(&sig, fixture.msg, fixture.msg_len, &session, &fixture.sk, &fixture.cred, benchmark_randomness));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    teardown(&fixture);
+
+    printf("%llu usec (%6llu signs/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void member_startup_benchmark()
+{
+    unsigned rounds = 100;
+
+    printf("Starting sign-and-verify::member_startup_benchmark (%u iterations)...\n", rounds);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    // What a device reads at startup, as separate files (but already in memory, so no I/O is timed)...
+    uint8_t sk_buffer[ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH];
+    uint8_t cred_buffer[ECDAA_CREDENTIAL_ZZZ_LENGTH];
+    uint8_t gpk_buffer[ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH];
+    ecdaa_member_secret_key_ZZZ_serialize(sk_buffer, &fixture.sk);
+    ecdaa_credential_ZZZ_serialize(cred_buffer, &fixture.cred);
+    ecdaa_group_public_key_ZZZ_serialize(gpk_buffer, &fixture.ipk.gpk);
+
+    // ... or as one bundle
+    struct ecdaa_member_bundle_ZZZ *bundle;
+    BENCHMARK_ASSERT(0 == ecdaa_member_bundle_ZZZ_new(&bundle, &fixture.sk, &fixture.cred, &fixture.ipk.gpk));
+    BENCHMARK_ASSERT(0 == ecdaa_member_bundle_ZZZ_add_basename(bundle, fixture.basename, fixture.basename_len, benchmark_randomness));
+    size_t bundle_len = ecdaa_member_bundle_ZZZ_length(bundle);
+    uint8_t bundle_buffer[bundle_len];
+    ecdaa_member_bundle_ZZZ_serialize(bundle_buffer, bundle);
+    ecdaa_member_bundle_ZZZ_free(bundle);
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        struct ecdaa_member_secret_key_ZZZ sk;
+        struct ecdaa_credential_ZZZ cred;
+        struct ecdaa_group_public_key_ZZZ gpk;
+        struct ecdaa_basename_session_ZZZ session;
+        BENCHMARK_ASSERT(0 == ecdaa_member_secret_key_ZZZ_deserialize(&sk, sk_buffer));
+        BENCHMARK_ASSERT(0 == ecdaa_credential_ZZZ_deserialize(&cred, cred_buffer));
+        BENCHMARK_ASSERT(0 == ecdaa_group_public_key_ZZZ_deserialize(&gpk, gpk_buffer));
+        BENCHMARK_ASSERT(0 == ecdaa_basename_session_ZZZ_init(&session, fixture.basename, fixture.basename_len, &sk, benchmark_randomness));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("separate files: %llu usec (%6llu startups/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_member_bundle_ZZZ_deserialize(&bundle, bundle_buffer, bundle_len));
+        ecdaa_member_bundle_ZZZ_free(bundle);
+    }
+
+    gettimeofday(&tv2, NULL);
+    elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    teardown(&fixture);
+
+    printf("bundle:         %llu usec (%6llu startups/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
 static void verify_benchmark()
 {
     unsigned rounds = 250;
@@ -194,3 +480,382 @@ static void verify_benchmark()
             elapsed,
             rounds * 1000000ULL / elapsed);
 }
+
+static void verify_with_issuer_key_benchmark()
+{
+    unsigned rounds = 250;
+
+    printf("Starting sign-and-verify::verify_with_issuer_key_benchmark (%u iterations)...\n", rounds);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+
+    BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, benchmark_randomness));
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_verify_with_issuer_key(&sig, &fixture.isk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, benchmark_randomness));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    teardown(&fixture);
+
+    printf("%llu usec (%6llu verifications/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void verify_multi_group_benchmark()
+{
+    unsigned rounds = 250;
+    enum { num_groups = 4 };
+
+    printf("Starting sign-and-verify::verify_multi_group_benchmark (%u iterations, %u groups)...\n", rounds, num_groups);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    // The signer's group is the last candidate
+    struct ecdaa_issuer_public_key_ZZZ other_ipks[num_groups - 1];
+    struct ecdaa_issuer_secret_key_ZZZ other_isks[num_groups - 1];
+    struct ecdaa_group_public_key_ZZZ *gpks[num_groups];
+    struct ecdaa_revocations_ZZZ *revocations[num_groups];
+    for (size_t i = 0; i < num_groups - 1; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_issuer_key_pair_ZZZ_generate(&other_ipks[i], &other_isks[i], benchmark_randomness));
+        gpks[i] = &other_ipks[i].gpk;
+        revocations[i] = &fixture.revocations;
+    }
+    gpks[num_groups - 1] = &fixture.ipk.gpk;
+    revocations[num_groups - 1] = &fixture.revocations;
+
+    struct ecdaa_signature_ZZZ sig;
+
+    BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, benchmark_randomness));
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        size_t group_index;
+        BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revocations, num_groups, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    teardown(&fixture);
+
+    printf("%llu usec (%6llu verifications/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void verify_cache_hit_benchmark()
+{
+    unsigned rounds = 25000;
+
+    printf("Starting sign-and-verify::verify_cache_hit_benchmark (%u iterations)...\n", rounds);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+
+    BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, benchmark_randomness));
+
+    uint8_t sig_buffer[ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+    ecdaa_signature_ZZZ_serialize(sig_buffer, &sig, 1);
+
+    struct ecdaa_verify_cache_ZZZ *cache;
+    BENCHMARK_ASSERT(0 == ecdaa_verify_cache_ZZZ_new(&cache, 1024));
+    ecdaa_verify_cache_ZZZ_set_revocations(cache, &fixture.revocations);
+
+    // Populate the cache, so every timed verification is a hit
+    BENCHMARK_ASSERT(0 == ecdaa_verify_cache_ZZZ_deserialize_and_verify(cache, &fixture.ipk.gpk, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, 1));
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_verify_cache_ZZZ_deserialize_and_verify(cache, &fixture.ipk.gpk, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, 1));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    ecdaa_verify_cache_ZZZ_free(cache);
+    teardown(&fixture);
+
+    printf("%llu usec (%6llu verifications/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void verifier_warmup_benchmark()
+{
+    enum { num_revocations = 1000 };
+    unsigned rounds = 20;
+    const char *kit_file = "/tmp/ecdaa-benchmark-verifier-kit";
+
+    printf("Starting sign-and-verify::verifier_warmup_benchmark (%u iterations, %u revocations of each kind)...\n", rounds, num_revocations);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    // What each verifier process reads at startup: the serialized gpk and revocation lists...
+    static struct ecdaa_member_secret_key_ZZZ sk_list[num_revocations];
+    static ECP_ZZZ bsn_list[num_revocations];
+    static uint8_t sk_buffer[num_revocations * ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH];
+    static uint8_t bsn_buffer[num_revocations * ECP_ZZZ_LENGTH];
+    for (unsigned i = 0; i < num_revocations; i++) {
+        ecp_ZZZ_random_mod_order(&sk_list[i].sk, benchmark_randomness);
+        ecdaa_member_secret_key_ZZZ_serialize(sk_buffer + i*ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH, &sk_list[i]);
+
+        ecp_ZZZ_set_to_generator(&bsn_list[i]);
+        ECP_ZZZ_mul(&bsn_list[i], sk_list[i].sk);
+        ecp_ZZZ_serialize(bsn_buffer + i*ECP_ZZZ_LENGTH, &bsn_list[i]);
+    }
+    uint8_t gpk_buffer[ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH];
+    ecdaa_group_public_key_ZZZ_serialize(gpk_buffer, &fixture.ipk.gpk);
+
+    // ... or one verifier kit
+    struct ecdaa_revocations_ZZZ revocations = {.sk_length = num_revocations, .sk_list = sk_list,
+                                                .bsn_length = num_revocations, .bsn_list = bsn_list};
+    BENCHMARK_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(kit_file, &fixture.ipk.gpk, &revocations));
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        struct ecdaa_group_public_key_ZZZ gpk;
+        BENCHMARK_ASSERT(0 == ecdaa_group_public_key_ZZZ_deserialize(&gpk, gpk_buffer));
+        for (unsigned j = 0; j < num_revocations; j++) {
+            BENCHMARK_ASSERT(0 == ecdaa_member_secret_key_ZZZ_deserialize(&sk_list[j], sk_buffer + j*ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH));
+            BENCHMARK_ASSERT(0 == ecp_ZZZ_deserialize(&bsn_list[j], bsn_buffer + j*ECP_ZZZ_LENGTH));
+        }
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("deserialize: %llu usec (%6llu warm-ups/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        struct ecdaa_verifier_kit_ZZZ *kit;
+        BENCHMARK_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&kit, kit_file));
+        ecdaa_verifier_kit_ZZZ_close(kit);
+    }
+
+    gettimeofday(&tv2, NULL);
+    elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    remove(kit_file);
+    teardown(&fixture);
+
+    printf("kit:         %llu usec (%6llu warm-ups/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void reject_invalid_benchmark()
+{
+    enum { sk_rev_length = 10 };
+    unsigned rounds = 250;
+
+    printf("Starting sign-and-verify::reject_invalid_benchmark (%u iterations, %u sk revocations)...\n", rounds, sk_rev_length);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list[sk_rev_length];
+    for (unsigned i = 0; i < sk_rev_length; i++)
+        ecp_ZZZ_random_mod_order(&sk_rev_list[i].sk, benchmark_randomness);
+    struct ecdaa_revocations_ZZZ revocations = {.sk_length=sk_rev_length, .sk_list=sk_rev_list, .bsn_length=0, .bsn_list=NULL};
+
+    struct ecdaa_signature_ZZZ sig;
+
+    BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, benchmark_randomness));
+
+    // A bogus signature: valid-looking, but not over this message
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    uint32_t wrong_msg_len = strlen((char*)wrong_msg);
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 != ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &revocations, wrong_msg, wrong_msg_len, fixture.basename, fixture.basename_len));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    printf("verify:           %llu usec (%6llu rejections/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 != ecdaa_signature_ZZZ_verify_fail_fast(&sig, &fixture.ipk.gpk, &revocations, wrong_msg, wrong_msg_len, fixture.basename, fixture.basename_len));
+    }
+
+    gettimeofday(&tv2, NULL);
+    elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    teardown(&fixture);
+
+    printf("verify_fail_fast: %llu usec (%6llu rejections/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
+
+static void batch_verify_benchmark()
+{
+    enum { batch_size = 25 };
+    unsigned rounds = 10;
+
+    printf("Starting sign-and-verify::batch_verify_benchmark (%u batches of %u)...\n", rounds, batch_size);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sigs[batch_size];
+    uint8_t *messages[batch_size];
+    uint32_t message_lens[batch_size];
+    int results[batch_size];
+    for (unsigned i = 0; i < batch_size; i++) {
+        messages[i] = fixture.msg;
+        message_lens[i] = fixture.msg_len;
+        BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sigs[i], fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, benchmark_randomness));
+    }
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_batch_verify(results, sigs, messages, message_lens, batch_size, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len, benchmark_randomness));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    teardown(&fixture);
+
+    printf("%llu usec (%6llu verifications/s)\n",
+            elapsed,
+            rounds * batch_size * 1000000ULL / elapsed);
+}
+
+#define MERKLE_BATCH_BENCHMARK_MESSAGES 256
+
+static void merkle_batch_sign_benchmark()
+{
+    unsigned rounds = 25;
+    uint32_t num_messages = MERKLE_BATCH_BENCHMARK_MESSAGES;
+
+    printf("Starting sign-and-verify::merkle_batch_sign_benchmark (%u iterations of %u messages)...\n", rounds, num_messages);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *messages[MERKLE_BATCH_BENCHMARK_MESSAGES];
+    uint32_t message_lens[MERKLE_BATCH_BENCHMARK_MESSAGES];
+    for (uint32_t i = 0; i < num_messages; i++) {
+        messages[i] = fixture.msg;
+        message_lens[i] = fixture.msg_len;
+    }
+
+    struct ecdaa_merkle_proof_ZZZ *proofs = malloc(num_messages * sizeof(struct ecdaa_merkle_proof_ZZZ));
+    BENCHMARK_ASSERT(NULL != proofs);
+
+    struct ecdaa_merkle_batch_ZZZ batch;
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, proofs, messages, message_lens, num_messages, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, benchmark_randomness));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    free(proofs);
+    teardown(&fixture);
+
+    printf("%llu usec (%6llu messages signed/s)\n",
+            elapsed,
+            rounds * num_messages * 1000000ULL / elapsed);
+}
+
+static void merkle_batch_verify_message_benchmark()
+{
+    unsigned rounds = 25000;
+    uint32_t num_messages = MERKLE_BATCH_BENCHMARK_MESSAGES;
+
+    printf("Starting sign-and-verify::merkle_batch_verify_message_benchmark (%u iterations, batches of %u)...\n", rounds, num_messages);
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *messages[MERKLE_BATCH_BENCHMARK_MESSAGES];
+    uint32_t message_lens[MERKLE_BATCH_BENCHMARK_MESSAGES];
+    for (uint32_t i = 0; i < num_messages; i++) {
+        messages[i] = fixture.msg;
+        message_lens[i] = fixture.msg_len;
+    }
+
+    struct ecdaa_merkle_proof_ZZZ *proofs = malloc(num_messages * sizeof(struct ecdaa_merkle_proof_ZZZ));
+    BENCHMARK_ASSERT(NULL != proofs);
+
+    struct ecdaa_merkle_batch_ZZZ batch;
+    BENCHMARK_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, proofs, messages, message_lens, num_messages, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, benchmark_randomness));
+    BENCHMARK_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify(&batch, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len));
+
+    struct timeval tv1;
+    gettimeofday(&tv1, NULL);
+
+    for (unsigned i = 0; i < rounds; i++) {
+        uint32_t index = i % num_messages;
+        BENCHMARK_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify_message(&batch, &proofs[index], messages[index], message_lens[index]));
+    }
+
+    struct timeval tv2;
+    gettimeofday(&tv2, NULL);
+    unsigned long long elapsed = (tv2.tv_usec + tv2.tv_sec * 1000000) -
+        (tv1.tv_usec + tv1.tv_sec * 1000000);
+
+    free(proofs);
+    teardown(&fixture);
+
+    printf("%llu usec (%6llu verifications/s)\n",
+            elapsed,
+            rounds * 1000000ULL / elapsed);
+}
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+/*
+ * Compares sign and verify throughput across every compiled-in curve.
+ *
+ * This file is expanded in "tool" mode (each templated line is
+ * duplicated once per curve), so the per-curve benchmark bodies are
+ * generated by the CURVE_COMPARISON_BENCHMARK macro below.
+ */
+
+#include "ecdaa-benchmark-utils.h"
+
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <sys/time.h>
+#include <string.h>
+
+struct curve_throughput {
+    unsigned long long signs_per_sec;
+    unsigned long long verifies_per_sec;
+};
+
+static unsigned long long elapsed_usec(struct timeval *start)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    unsigned long long elapsed = (now.tv_usec + now.tv_sec * 1000000) -
+        (start->tv_usec + start->tv_sec * 1000000);
+    return elapsed ? elapsed : 1;
+}
+
+#define CURVE_COMPARISON_BENCHMARK(curve) \
+static void compare_ ## curve(struct curve_throughput *out, unsigned rounds) \
+{ \
+    uint8_t *msg = (uint8_t*) "Test message"; \
+    uint32_t msg_len = (uint32_t)strlen((char*)msg); \
+    uint8_t *basename = (uint8_t*) "BASENAME"; \
+    uint32_t basename_len = (uint32_t)strlen((char*)basename); \
+    uint8_t nonce[] = "NONCE"; \
+\
+    struct ecdaa_issuer_public_key_ ## curve ipk; \
+    struct ecdaa_issuer_secret_key_ ## curve isk; \
+    BENCHMARK_ASSERT(0 == ecdaa_issuer_key_pair_ ## curve ## _generate(&ipk, &isk, benchmark_randomness)); \
+\
+    struct ecdaa_member_public_key_ ## curve pk; \
+    struct ecdaa_member_secret_key_ ## curve sk; \
+    BENCHMARK_ASSERT(0 == ecdaa_member_key_pair_ ## curve ## _generate(&pk, &sk, nonce, sizeof(nonce), benchmark_randomness)); \
+\
+    struct ecdaa_credential_ ## curve cred; \
+    struct ecdaa_credential_ ## curve ## _signature cred_sig; \
+    BENCHMARK_ASSERT(0 == ecdaa_credential_ ## curve ## _generate(&cred, &cred_sig, &isk, &pk, benchmark_randomness)); \
+\
+    struct ecdaa_revocations_ ## curve revocations = {0, NULL, 0, NULL}; \
+    struct ecdaa_signature_ ## curve sig; \
+\
+    struct timeval start; \
+    gettimeofday(&start, NULL); \
+    for (unsigned i = 0; i < rounds; i++) { \
+        BENCHMARK_ASSERT(0 == ecdaa_signature_ ## curve ## _sign(&sig, msg, msg_len, basename, basename_len, &sk, &cred, benchmark_randomness)); \
+    } \
+    out->signs_per_sec = rounds * 1000000ULL / elapsed_usec(&start); \
+\
+    gettimeofday(&start, NULL); \
+    for (unsigned i = 0; i < rounds; i++) { \
+        BENCHMARK_ASSERT(0 == ecdaa_signature_ ## curve ## _verify(&sig, &ipk.gpk, &revocations, msg, msg_len, basename, basename_len)); \
+    } \
+    out->verifies_per_sec = rounds * 1000000ULL / elapsed_usec(&start); \
+}
+
+CURVE_COMPARISON_BENCHMARK(ZZZ)
+
+struct curve_comparison {
+    const char *name;
+    void (*run)(struct curve_throughput *out, unsigned rounds);
+    struct curve_throughput result;
+};
+
+static struct curve_comparison curves[] = {
+    {"ZZZ", compare_ZZZ, {0, 0}},
+};
+
+int main(int argc, char *argv[])
+{
+    unsigned rounds = 250;
+    if (argc > 1)
+        rounds = (unsigned)strtoul(argv[1], NULL, 10);
+    BENCHMARK_ASSERT(rounds > 0);
+
+    size_t num_curves = sizeof(curves) / sizeof(curves[0]);
+
+    printf("Starting curve_comparison (%u iterations per curve)...\n", rounds);
+
+    // FP256BN is the baseline, if it was compiled in.
+    struct curve_throughput *baseline = NULL;
+    for (size_t i = 0; i < num_curves; i++) {
+        curves[i].run(&curves[i].result, rounds);
+        if (0 == strcmp(curves[i].name, "FP256BN"))
+            baseline = &curves[i].result;
+    }
+
+    printf("%-10s %12s %12s %10s %10s\n", "curve", "signs/s", "verifies/s", "sign x", "verify x");
+    for (size_t i = 0; i < num_curves; i++) {
+        printf("%-10s %12llu %12llu",
+               curves[i].name,
+               curves[i].result.signs_per_sec,
+               curves[i].result.verifies_per_sec);
+        if (NULL != baseline && 0 != baseline->signs_per_sec && 0 != baseline->verifies_per_sec) {
+            printf(" %10.2f %10.2f",
+                   (double)curves[i].result.signs_per_sec / (double)baseline->signs_per_sec,
+                   (double)curves[i].result.verifies_per_sec / (double)baseline->verifies_per_sec);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,250 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ecdaa-benchmark-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <string.h>
+
+// Each thread signs/verifies with its own member key and credential,
+// while the issuer's group public key and the revocation lists are shared.
+// This mirrors a verifier host handling many members concurrently.
+
+typedef enum {
+    SCALING_SIGN,
+    SCALING_VERIFY,
+} scaling_operation;
+
+struct shared_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+};
+
+struct thread_fixture {
+    struct shared_fixture *shared;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_signature_ZZZ sig;
+    scaling_operation operation;
+    unsigned rounds;
+};
+
+static int urandom_fd = -1;
+
+static void threadsafe_randomness(void *buf, size_t buflen);
+
+static void shared_setup(struct shared_fixture *shared, size_t num_revoked);
+static void shared_teardown(struct shared_fixture *shared);
+static void thread_setup(struct thread_fixture *fixture, struct shared_fixture *shared);
+
+static void *worker(void *arg);
+
+static void scaling_benchmark(scaling_operation operation,
+                              const char *name,
+                              const char *unit,
+                              unsigned rounds,
+                              unsigned max_threads,
+                              size_t num_revoked);
+
+int main(int argc, char *argv[])
+{
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned max_threads = online > 0 ? (unsigned)online : 1;
+    unsigned rounds = 100;
+    size_t num_revoked = 100;
+
+    if (argc > 1)
+        max_threads = (unsigned)strtoul(argv[1], NULL, 10);
+    if (argc > 2)
+        rounds = (unsigned)strtoul(argv[2], NULL, 10);
+    if (argc > 3)
+        num_revoked = (size_t)strtoul(argv[3], NULL, 10);
+    BENCHMARK_ASSERT(max_threads > 0 && rounds > 0);
+
+    urandom_fd = open("/dev/urandom", O_RDONLY);
+    BENCHMARK_ASSERT(urandom_fd >= 0);
+
+    scaling_benchmark(SCALING_SIGN, "sign_benchmark", "signs", rounds, max_threads, num_revoked);
+    scaling_benchmark(SCALING_VERIFY, "verify_benchmark", "verifications", rounds, max_threads, num_revoked);
+
+    close(urandom_fd);
+}
+
+static void threadsafe_randomness(void *buf, size_t buflen)
+{
+    // A single read(2) on a shared descriptor is safe to call concurrently,
+    // unlike the buffered FILE* used by benchmark_randomness.
+    uint8_t *out = buf;
+    while (buflen > 0) {
+        ssize_t read_ret = read(urandom_fd, out, buflen);
+        BENCHMARK_ASSERT(read_ret > 0);
+        out += read_ret;
+        buflen -= (size_t)read_ret;
+    }
+}
+
+static void shared_setup(struct shared_fixture *shared, size_t num_revoked)
+{
+    ecp_ZZZ_random_mod_order(&shared->isk.x, threadsafe_randomness);
+    ecp2_ZZZ_set_to_generator(&shared->ipk.gpk.X);
+    ECP2_ZZZ_mul(&shared->ipk.gpk.X, shared->isk.x);
+
+    ecp_ZZZ_random_mod_order(&shared->isk.y, threadsafe_randomness);
+    ecp2_ZZZ_set_to_generator(&shared->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&shared->ipk.gpk.Y, shared->isk.y);
+
+    shared->msg = (uint8_t*) "Test message";
+    shared->msg_len = strlen((char*)shared->msg);
+
+    shared->basename = (uint8_t*) "BASENAME";
+    shared->basename_len = (uint32_t)strlen((char*)shared->basename);
+
+    // Fill both revocation lists with unrelated keys and basename signatures,
+    // so every verify scans them in full without rejecting the signature.
+    shared->revocations.sk_length=num_revoked;
+    shared->revocations.sk_list=NULL;
+    shared->revocations.bsn_length=num_revoked;
+    shared->revocations.bsn_list=NULL;
+    if (num_revoked > 0) {
+        shared->revocations.sk_list = malloc(num_revoked * sizeof(struct ecdaa_member_secret_key_ZZZ));
+        shared->revocations.bsn_list = malloc(num_revoked * sizeof(ECP_ZZZ));
+        BENCHMARK_ASSERT(NULL != shared->revocations.sk_list && NULL != shared->revocations.bsn_list);
+    }
+    for (size_t i = 0; i < num_revoked; i++) {
+        ecp_ZZZ_random_mod_order(&shared->revocations.sk_list[i].sk, threadsafe_randomness);
+
+        BIG_XXX bsn_exp;
+        ecp_ZZZ_random_mod_order(&bsn_exp, threadsafe_randomness);
+        ecp_ZZZ_set_to_generator(&shared->revocations.bsn_list[i]);
+        ECP_ZZZ_mul(&shared->revocations.bsn_list[i], bsn_exp);
+    }
+}
+
+static void shared_teardown(struct shared_fixture *shared)
+{
+    free(shared->revocations.sk_list);
+    free(shared->revocations.bsn_list);
+}
+
+static void thread_setup(struct thread_fixture *fixture, struct shared_fixture *shared)
+{
+    fixture->shared = shared;
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, threadsafe_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    BENCHMARK_ASSERT(0 == ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &shared->isk, &fixture->pk, threadsafe_randomness));
+
+    BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign(&fixture->sig, shared->msg, shared->msg_len, shared->basename, shared->basename_len, &fixture->sk, &fixture->cred, threadsafe_randomness));
+}
+
+static void *worker(void *arg)
+{
+    struct thread_fixture *fixture = arg;
+    struct shared_fixture *shared = fixture->shared;
+
+    for (unsigned i = 0; i < fixture->rounds; i++) {
+        if (SCALING_SIGN == fixture->operation) {
+            BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_sign(&fixture->sig, shared->msg, shared->msg_len, shared->basename, shared->basename_len, &fixture->sk, &fixture->cred, threadsafe_randomness));
+        } else {
+            BENCHMARK_ASSERT(0 == ecdaa_signature_ZZZ_verify(&fixture->sig, &shared->ipk.gpk, &shared->revocations, shared->msg, shared->msg_len, shared->basename, shared->basename_len));
+        }
+    }
+
+    return NULL;
+}
+
+static void scaling_benchmark(scaling_operation operation,
+                              const char *name,
+                              const char *unit,
+                              unsigned rounds,
+                              unsigned max_threads,
+                              size_t num_revoked)
+{
+    printf("Starting scaling::%s (%u iterations per thread, 1..%u threads, %zu revoked keys and basename signatures)...\n",
+           name, rounds, max_threads, num_revoked);
+
+    struct shared_fixture shared;
+    shared_setup(&shared, num_revoked);
+
+    struct thread_fixture *fixtures = malloc(max_threads * sizeof(struct thread_fixture));
+    pthread_t *threads = malloc(max_threads * sizeof(pthread_t));
+    BENCHMARK_ASSERT(NULL != fixtures && NULL != threads);
+
+    for (unsigned i = 0; i < max_threads; i++) {
+        thread_setup(&fixtures[i], &shared);
+        fixtures[i].operation = operation;
+        fixtures[i].rounds = rounds;
+    }
+
+    double single_thread_rate = 0;
+    for (unsigned num_threads = 1; num_threads <= max_threads; num_threads++) {
+        struct timespec ts1;
+        clock_gettime(CLOCK_MONOTONIC, &ts1);
+
+        for (unsigned i = 0; i < num_threads; i++)
+            BENCHMARK_ASSERT(0 == pthread_create(&threads[i], NULL, worker, &fixtures[i]));
+        for (unsigned i = 0; i < num_threads; i++)
+            BENCHMARK_ASSERT(0 == pthread_join(threads[i], NULL));
+
+        struct timespec ts2;
+        clock_gettime(CLOCK_MONOTONIC, &ts2);
+        unsigned long long elapsed = (ts2.tv_sec - ts1.tv_sec) * 1000000ULL +
+            (ts2.tv_nsec - ts1.tv_nsec) / 1000;
+
+        double rate = (double)num_threads * rounds * 1000000.0 / elapsed;
+        if (1 == num_threads)
+            single_thread_rate = rate;
+
+        // Efficiency is the achieved throughput relative to perfect linear scaling
+        printf("%3u threads: %llu usec (%6.0f %s/s, %5.1f%% efficiency)\n",
+               num_threads,
+               elapsed,
+               rate,
+               unit,
+               100.0 * rate / (num_threads * single_thread_rate));
+    }
+
+    free(threads);
+    free(fixtures);
+
+    shared_teardown(&shared);
+}
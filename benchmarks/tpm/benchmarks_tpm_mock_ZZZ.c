@@ -0,0 +1,167 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../ecdaa-benchmark-utils.h"
+#include "tcti_mock_ZZZ.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa-tpm/member_keypair_TPM_ZZZ.h>
+#include <ecdaa-tpm/signature_TPM_ZZZ.h>
+#include <ecdaa-tpm/tpm_context.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include <time.h>
+#include <string.h>
+
+// Measures the TPM signing paths against the in-process mock TPM,
+// for a range of emulated TPM command latencies.
+// The "overhead" column is the time spent beyond the emulated TPM latency,
+// i.e. host-side work that isn't overlapped with the TPM.
+
+#define MOCK_KEY_HANDLE 0x81000001
+#define BATCH_SIZE 10
+
+struct mock_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    uint8_t serialized_public_key[ECP_ZZZ_LENGTH];
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct tcti_mock_ZZZ mock;
+    struct ecdaa_tpm_context tpm_ctx;
+};
+
+static void setup(struct mock_fixture *fixture);
+static void teardown(struct mock_fixture *fixture);
+
+static unsigned long long elapsed_usec(struct timespec *start);
+
+static void latency_benchmark(uint32_t latency_usec, unsigned rounds);
+
+int main(int argc, char *argv[])
+{
+    unsigned rounds = 50;
+    if (argc > 1)
+        rounds = (unsigned)strtoul(argv[1], NULL, 10);
+    BENCHMARK_ASSERT(rounds > 0);
+
+    const uint32_t latencies_usec[] = {0, 1000, 5000, 20000};
+    for (size_t i = 0; i < sizeof(latencies_usec)/sizeof(latencies_usec[0]); i++)
+        latency_benchmark(latencies_usec[i], rounds);
+}
+
+static void setup(struct mock_fixture *fixture)
+{
+    BENCHMARK_ASSERT(0 == tcti_mock_ZZZ_init(&fixture->mock, MOCK_KEY_HANDLE, NULL, 0, benchmark_randomness));
+    BENCHMARK_ASSERT(0 == ecdaa_tpm_context_init(&fixture->tpm_ctx, MOCK_KEY_HANDLE, NULL, 0, tcti_mock_ZZZ_tcti(&fixture->mock)));
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, benchmark_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, benchmark_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    tcti_mock_ZZZ_serialize_public_key(fixture->serialized_public_key, &fixture->mock);
+    BENCHMARK_ASSERT(0 == ecdaa_member_key_pair_TPM_ZZZ_generate(&fixture->pk, fixture->serialized_public_key, (uint8_t*)"nonce", 5, &fixture->tpm_ctx));
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    BENCHMARK_ASSERT(0 == ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, benchmark_randomness));
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+}
+
+static void teardown(struct mock_fixture *fixture)
+{
+    ecdaa_tpm_context_free(&fixture->tpm_ctx);
+    Tss2_Tcti_Finalize(tcti_mock_ZZZ_tcti(&fixture->mock));
+}
+
+static unsigned long long elapsed_usec(struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000000ULL + (end.tv_nsec - start->tv_nsec) / 1000;
+}
+
+static void print_result(const char *name, unsigned long long elapsed, unsigned operations, unsigned long long tpm_usec_per_operation)
+{
+    double per_operation = (double)elapsed / operations;
+    printf("\t%-10s %9.1f usec/op (overhead %9.1f usec/op)\n",
+           name,
+           per_operation,
+           per_operation - (double)tpm_usec_per_operation);
+}
+
+static void latency_benchmark(uint32_t latency_usec, unsigned rounds)
+{
+    printf("Starting tpm_mock::latency_benchmark (%u usec per TPM command, %u iterations)...\n", latency_usec, rounds);
+
+    struct mock_fixture *fixture = malloc(sizeof(struct mock_fixture));
+    BENCHMARK_ASSERT(NULL != fixture);
+    setup(fixture);
+
+    tcti_mock_ZZZ_set_latency(&fixture->mock, latency_usec, latency_usec);
+
+    // Each operation below issues one TPM2_Commit and one TPM2_Sign
+    unsigned long long tpm_usec = 2ULL * latency_usec;
+
+    struct timespec start;
+    struct ecdaa_member_public_key_ZZZ pk;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < rounds; i++)
+        BENCHMARK_ASSERT(0 == ecdaa_member_key_pair_TPM_ZZZ_generate(&pk, fixture->serialized_public_key, (uint8_t*)"nonce", 5, &fixture->tpm_ctx));
+    print_result("keygen", elapsed_usec(&start), rounds, tpm_usec);
+
+    struct ecdaa_signature_ZZZ sig;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < rounds; i++)
+        BENCHMARK_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign(&sig, fixture->msg, fixture->msg_len, fixture->basename, fixture->basename_len, &fixture->cred, benchmark_randomness, &fixture->tpm_ctx));
+    print_result("sign", elapsed_usec(&start), rounds, tpm_usec);
+
+    struct ecdaa_signature_ZZZ sigs[BATCH_SIZE];
+    const uint8_t *messages[BATCH_SIZE];
+    uint32_t message_lens[BATCH_SIZE];
+    for (unsigned i = 0; i < BATCH_SIZE; i++) {
+        messages[i] = fixture->msg;
+        message_lens[i] = fixture->msg_len;
+    }
+    unsigned batches = (rounds + BATCH_SIZE - 1) / BATCH_SIZE;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned i = 0; i < batches; i++)
+        BENCHMARK_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_batch(sigs, messages, message_lens, BATCH_SIZE, fixture->basename, fixture->basename_len, &fixture->cred, benchmark_randomness, &fixture->tpm_ctx));
+    print_result("sign_batch", elapsed_usec(&start), batches * BATCH_SIZE, tpm_usec);
+
+    teardown(fixture);
+    free(fixture);
+}
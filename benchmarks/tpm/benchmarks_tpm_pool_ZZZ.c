@@ -0,0 +1,262 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../ecdaa-benchmark-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa-tpm/member_keypair_TPM_ZZZ.h>
+#include <ecdaa-tpm/signature_TPM_ZZZ.h>
+#include <ecdaa-tpm/tpm_context.h>
+#include <ecdaa-tpm/tpm_context_pool.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include <tss2/tss2_sys.h>
+#include <tss2/tss2_tcti_mssim.h>
+#include <tss2/tss2_tcti_device.h>
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <string.h>
+
+// Measures signing throughput through an `ecdaa_tpm_context_pool`,
+// for 1..max_threads signing threads sharing `pool_size` TPM connections.
+//
+// Each pool slot opens its own TCTI connection, so the TPM must accept concurrent connections:
+// use the kernel resource manager (`/dev/tpmrm0`),
+// or (with `-DUSE_TCP_TPM`) a simulator behind a resource manager listening on port 2321.
+//
+// The TPM key is read from `pub_key.txt` and `handle.txt`, as in the TPM tests.
+
+struct pooled_connection {
+    struct ecdaa_tpm_context tpm_ctx;
+    unsigned char tcti_buffer[256];
+    TSS2_TCTI_CONTEXT *tcti_context;
+};
+
+struct shared_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_tpm_context_pool pool;
+    unsigned rounds;
+};
+
+static int urandom_fd = -1;
+
+static void threadsafe_randomness(void *buf, size_t buflen);
+
+static int read_key_files(uint8_t *public_key, TPM2_HANDLE *key_handle);
+static void connection_init(struct pooled_connection *conn, TPM2_HANDLE key_handle);
+static void connection_free(struct pooled_connection *conn);
+
+static void *worker(void *arg);
+
+static void pool_sign_benchmark(unsigned pool_size, unsigned max_threads, unsigned rounds);
+
+int main(int argc, char *argv[])
+{
+    unsigned pool_size = 4;
+    unsigned max_threads = 8;
+    unsigned rounds = 20;
+
+    if (argc > 1)
+        pool_size = (unsigned)strtoul(argv[1], NULL, 10);
+    if (argc > 2)
+        max_threads = (unsigned)strtoul(argv[2], NULL, 10);
+    if (argc > 3)
+        rounds = (unsigned)strtoul(argv[3], NULL, 10);
+    BENCHMARK_ASSERT(pool_size > 0 && pool_size <= ECDAA_TPM_CONTEXT_POOL_MAX_SIZE);
+    BENCHMARK_ASSERT(max_threads > 0 && rounds > 0);
+
+    urandom_fd = open("/dev/urandom", O_RDONLY);
+    BENCHMARK_ASSERT(urandom_fd >= 0);
+
+    pool_sign_benchmark(pool_size, max_threads, rounds);
+
+    close(urandom_fd);
+}
+
+static void threadsafe_randomness(void *buf, size_t buflen)
+{
+    uint8_t *out = buf;
+    while (buflen > 0) {
+        ssize_t read_ret = read(urandom_fd, out, buflen);
+        BENCHMARK_ASSERT(read_ret > 0);
+        out += read_ret;
+        buflen -= (size_t)read_ret;
+    }
+}
+
+static int read_key_files(uint8_t *public_key, TPM2_HANDLE *key_handle)
+{
+    int ret = 0;
+
+    FILE *pub_key_file_ptr = fopen("pub_key.txt", "r");
+    if (NULL == pub_key_file_ptr)
+        return -1;
+    for (unsigned i=0; i < ECP_ZZZ_LENGTH; i++) {
+        unsigned byt;
+        if (fscanf(pub_key_file_ptr, "%02X", &byt) != 1) {
+            ret = -1;
+            break;
+        }
+        public_key[i] = (uint8_t)byt;
+    }
+    (void)fclose(pub_key_file_ptr);
+    if (0 != ret)
+        return -1;
+
+    FILE *handle_file_ptr = fopen("handle.txt", "r");
+    if (NULL == handle_file_ptr)
+        return -1;
+    *key_handle = 0;
+    for (int i=(sizeof(TPM2_HANDLE)-1); i >= 0; i--) {
+        unsigned byt;
+        if (fscanf(handle_file_ptr, "%02X", &byt) != 1) {
+            ret = -1;
+            break;
+        }
+        *key_handle += byt<<(i*8);
+    }
+    (void)fclose(handle_file_ptr);
+
+    return ret;
+}
+
+static void connection_init(struct pooled_connection *conn, TPM2_HANDLE key_handle)
+{
+    memset(conn->tcti_buffer, 0, sizeof(conn->tcti_buffer));
+    conn->tcti_context = (TSS2_TCTI_CONTEXT*)conn->tcti_buffer;
+
+    size_t size;
+#ifdef USE_TCP_TPM
+    const char *mssim_conf = "host=localhost,port=2321";
+    BENCHMARK_ASSERT(TSS2_RC_SUCCESS == Tss2_Tcti_Mssim_Init(NULL, &size, mssim_conf));
+    BENCHMARK_ASSERT(size <= sizeof(conn->tcti_buffer));
+    BENCHMARK_ASSERT(TSS2_RC_SUCCESS == Tss2_Tcti_Mssim_Init(conn->tcti_context, &size, mssim_conf));
+#else
+    const char *device_conf = "/dev/tpmrm0";
+    BENCHMARK_ASSERT(TSS2_RC_SUCCESS == Tss2_Tcti_Device_Init(NULL, &size, device_conf));
+    BENCHMARK_ASSERT(size <= sizeof(conn->tcti_buffer));
+    BENCHMARK_ASSERT(TSS2_RC_SUCCESS == Tss2_Tcti_Device_Init(conn->tcti_context, &size, device_conf));
+#endif
+
+    BENCHMARK_ASSERT(0 == ecdaa_tpm_context_init(&conn->tpm_ctx, key_handle, NULL, 0, conn->tcti_context));
+}
+
+static void connection_free(struct pooled_connection *conn)
+{
+    ecdaa_tpm_context_free(&conn->tpm_ctx);
+    Tss2_Tcti_Finalize(conn->tcti_context);
+}
+
+static void *worker(void *arg)
+{
+    struct shared_fixture *shared = arg;
+
+    struct ecdaa_signature_ZZZ sig;
+    for (unsigned i = 0; i < shared->rounds; i++) {
+        BENCHMARK_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_pooled(&sig, shared->msg, shared->msg_len, shared->basename, shared->basename_len, &shared->cred, threadsafe_randomness, &shared->pool));
+    }
+
+    return NULL;
+}
+
+static void pool_sign_benchmark(unsigned pool_size, unsigned max_threads, unsigned rounds)
+{
+    printf("Starting tpm_pool::sign_benchmark (%u connections, %u iterations per thread, 1..%u threads)...\n", pool_size, rounds, max_threads);
+
+    uint8_t serialized_public_key[ECP_ZZZ_LENGTH];
+    TPM2_HANDLE key_handle;
+    BENCHMARK_ASSERT(0 == read_key_files(serialized_public_key, &key_handle));
+
+    struct pooled_connection connections[ECDAA_TPM_CONTEXT_POOL_MAX_SIZE];
+    struct ecdaa_tpm_context *contexts[ECDAA_TPM_CONTEXT_POOL_MAX_SIZE];
+    for (unsigned i = 0; i < pool_size; i++) {
+        connection_init(&connections[i], key_handle);
+        contexts[i] = &connections[i].tpm_ctx;
+    }
+
+    struct shared_fixture *shared = malloc(sizeof(struct shared_fixture));
+    pthread_t *threads = malloc(max_threads * sizeof(pthread_t));
+    BENCHMARK_ASSERT(NULL != shared && NULL != threads);
+
+    BENCHMARK_ASSERT(0 == ecdaa_tpm_context_pool_init(&shared->pool, contexts, pool_size));
+
+    ecp_ZZZ_random_mod_order(&shared->isk.x, threadsafe_randomness);
+    ecp2_ZZZ_set_to_generator(&shared->ipk.gpk.X);
+    ECP2_ZZZ_mul(&shared->ipk.gpk.X, shared->isk.x);
+
+    ecp_ZZZ_random_mod_order(&shared->isk.y, threadsafe_randomness);
+    ecp2_ZZZ_set_to_generator(&shared->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&shared->ipk.gpk.Y, shared->isk.y);
+
+    uint8_t *nonce = (uint8_t*)"nonce";
+    BENCHMARK_ASSERT(0 == ecdaa_member_key_pair_TPM_ZZZ_generate(&shared->pk, serialized_public_key, nonce, 5, contexts[0]));
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    BENCHMARK_ASSERT(0 == ecdaa_credential_ZZZ_generate(&shared->cred, &cred_sig, &shared->isk, &shared->pk, threadsafe_randomness));
+
+    shared->msg = (uint8_t*) "Test message";
+    shared->msg_len = (uint32_t)strlen((char*)shared->msg);
+
+    shared->basename = (uint8_t*) "BASENAME";
+    shared->basename_len = (uint32_t)strlen((char*)shared->basename);
+
+    shared->rounds = rounds;
+
+    for (unsigned num_threads = 1; num_threads <= max_threads; num_threads++) {
+        struct timespec ts1;
+        clock_gettime(CLOCK_MONOTONIC, &ts1);
+
+        for (unsigned i = 0; i < num_threads; i++)
+            BENCHMARK_ASSERT(0 == pthread_create(&threads[i], NULL, worker, shared));
+        for (unsigned i = 0; i < num_threads; i++)
+            BENCHMARK_ASSERT(0 == pthread_join(threads[i], NULL));
+
+        struct timespec ts2;
+        clock_gettime(CLOCK_MONOTONIC, &ts2);
+        unsigned long long elapsed = (ts2.tv_sec - ts1.tv_sec) * 1000000ULL +
+            (ts2.tv_nsec - ts1.tv_nsec) / 1000;
+
+        printf("%3u threads: %llu usec (%6.1f signs/s)\n",
+               num_threads,
+               elapsed,
+               (double)num_threads * rounds * 1000000.0 / elapsed);
+    }
+
+    ecdaa_tpm_context_pool_free(&shared->pool);
+    for (unsigned i = 0; i < pool_size; i++)
+        connection_free(&connections[i]);
+
+    free(threads);
+    free(shared);
+}
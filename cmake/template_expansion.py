@@ -16,11 +16,13 @@ big_replacements = {
         'BN254': '256_56',
         'BN254CX': '256_56',
         'BLS383': '384_56',
+        'BLS381': '384_58',
         'FP256BN': '256_56'},
     '32': {
         'BN254': '256_28',
         'BN254CX': '256_28',
         'BLS383': '384_29',
+        'BLS381': '384_29',
         'FP256BN': '256_28'},
     '16': {
         'BN254': '256_13',
@@ -32,11 +34,13 @@ fp_replacements = {
         'BN254': 'BN254',
         'BN254CX': 'BN254CX',
         'BLS383': 'BLS383',
+        'BLS381': 'BLS381',
         'FP256BN': 'FP256BN'},
     '32': {
         'BN254': 'BN254',
         'BN254CX': 'BN254CX',
         'BLS383': 'BLS383',
+        'BLS381': 'BLS381',
         'FP256BN': 'FP256BN'},
     '16': {
         'BN254': 'BN254',
@@ -18,6 +18,12 @@
 
 #include "./ecp2_ZZZ.h"
 
+#include "internal-utilities/instrumentation.h"
+
+#include <amcl/pair_ZZZ.h>
+
+static int ecp2_ZZZ_in_subgroup(ECP2_ZZZ *point);
+
 size_t ecp2_ZZZ_length(void)
 {
     return ECP2_ZZZ_LENGTH;
@@ -53,6 +59,24 @@ void ecp2_ZZZ_serialize(uint8_t *buffer_out,
 
 int ecp2_ZZZ_deserialize(ECP2_ZZZ *point_out,
                          uint8_t *buffer)
+{
+    // 1-5) Format, range, on-curve, and identity checks
+    int ret = ecp2_ZZZ_deserialize_trusted(point_out, buffer);
+    if (0 != ret)
+        return ret;
+
+    // 6) Check that point is in the proper subgroup
+    //  (step 4 in X9.62 Sec 5.2.2)
+    int in_subgroup = 0;
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP2_SUBGROUP_CHECK, in_subgroup = ecp2_ZZZ_in_subgroup(point_out));
+    if (!in_subgroup)
+        return -1;
+
+    return 0;
+}
+
+int ecp2_ZZZ_deserialize_trusted(ECP2_ZZZ *point_out,
+                                 uint8_t *buffer)
 {
     // 1) Check that serialized point was properly formatted.
     if (0x4 != buffer[0])
@@ -95,19 +119,57 @@ int ecp2_ZZZ_deserialize(ECP2_ZZZ *point_out,
         return -1;
     }
 
-    // 6) Check that point is in the proper subgroup
-    //  (step 4 in X9.62 Sec 5.2.2)
-    //  (check order*point == inf).
+    return 0;
+}
+
+void ecp2_ZZZ_mul_gls(ECP2_ZZZ *point, BIG_XXX scalar)
+{
+    PAIR_ZZZ_G2mul(point, scalar);
+}
+
+static int ecp2_ZZZ_in_subgroup(ECP2_ZZZ *point)
+{
+#if CURVE_PAIRING_TYPE_ZZZ == BLS
+    // On BLS curves, the untwist-Frobenius-twist endomorphism psi
+    //  acts on G2 as multiplication by the curve parameter u,
+    //  and only points in G2 satisfy psi(P) == [u]P
+    //  (Scott, "A note on group membership tests for G1, G2 and GT
+    //  on BLS pairing-friendly curves").
+    //  This takes one multiplication by the 64-bit |u|,
+    //  rather than one by the full group order.
+    BIG_XXX fra, frb;
+    BIG_XXX_rcopy(fra, Fra_YYY);
+    BIG_XXX_rcopy(frb, Frb_YYY);
+    FP2_YYY frobenius;
+    FP2_YYY_from_BIGs(&frobenius, fra, frb);
+#if SEXTIC_TWIST_ZZZ == M_TYPE
+    FP2_YYY_inv(&frobenius, &frobenius);
+    FP2_YYY_norm(&frobenius);
+#endif
+
+    ECP2_ZZZ endo;
+    ECP2_ZZZ_copy(&endo, point);
+    ECP2_ZZZ_frob(&endo, &frobenius);
+
+    BIG_XXX u;
+    BIG_XXX_rcopy(u, CURVE_Bnx_ZZZ);
+    ECP2_ZZZ multiple;
+    ECP2_ZZZ_copy(&multiple, point);
+    ECP2_ZZZ_mul(&multiple, u);
+#if SIGN_OF_X_ZZZ == NEGATIVEX
+    ECP2_ZZZ_neg(&multiple);   // CURVE_Bnx_ZZZ holds |u|
+#endif
+
+    return ECP2_ZZZ_equals(&endo, &multiple);
+#else
+    // Check order*point == inf.
     ECP2_ZZZ point_copy;
-    ECP2_ZZZ_copy(&point_copy, point_out);
+    ECP2_ZZZ_copy(&point_copy, point);
 
     BIG_XXX curve_order;
     BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
     ECP2_ZZZ_mul(&point_copy, curve_order);
 
-    if (!ECP2_ZZZ_isinf(&point_copy)) {
-        return -1;
-    }
-
-    return 0;
+    return ECP2_ZZZ_isinf(&point_copy);
+#endif
 }
@@ -56,6 +56,31 @@ void ecp2_ZZZ_serialize(uint8_t *buffer_out,
 int ecp2_ZZZ_deserialize(ECP2_ZZZ *point_out,
                          uint8_t *buffer);
 
+/*
+ * Same as `ecp2_ZZZ_deserialize`, but without the subgroup check
+ * (the only expensive step, as it's a full scalar multiplication).
+ *
+ * Only for points read back from trusted storage,
+ * which were fully checked before they were stored.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the point is not on the curve
+ */
+int ecp2_ZZZ_deserialize_trusted(ECP2_ZZZ *point_out,
+                                 uint8_t *buffer);
+
+/*
+ * Multiply `point` by `scalar` in-place, using the GLS (psi) endomorphism decomposition
+ * (on curves where AMCL enables it, else plain `ECP2_ZZZ_mul`).
+ *
+ * Constant-time, like `ECP2_ZZZ_mul`.
+ *
+ * `point` MUST be in the prime-order subgroup (the decomposition is only valid there),
+ * so this must NOT be used for subgroup checks.
+ */
+void ecp2_ZZZ_mul_gls(ECP2_ZZZ *point, BIG_XXX scalar);
+
 #ifdef __cplusplus
 }
 #endif
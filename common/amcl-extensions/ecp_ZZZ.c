@@ -20,6 +20,31 @@
 #include "./big_XXX.h"
 
 #include "internal-utilities/rand_pool.h"
+#include "internal-utilities/instrumentation.h"
+#include "internal-utilities/explicit_bzero.h"
+
+#include <amcl/pair_ZZZ.h>
+
+#include <assert.h>
+
+// Bits of randomness in the multiple of the group order added to secret scalars
+#define SCALAR_BLINDING_BYTES 8
+
+#define SECRET_MUL_WINDOW_BITS 4
+#define SECRET_MUL_TABLE_SIZE (1 << SECRET_MUL_WINDOW_BITS)
+
+// Counter values ecp_ZZZ_fromhash tries before giving up
+#define FROMHASH_MAX_TRIES 232
+
+static void ecp_ZZZ_cmove(ECP_ZZZ *point, ECP_ZZZ *other, unsigned move);
+static void ecp_ZZZ_select(ECP_ZZZ *selected_out, ECP_ZZZ *table, unsigned digit);
+static void ecp_ZZZ_blind_scalar(DBIG_XXX blinded_out,
+                                 BIG_XXX scalar,
+                                 void (*get_random)(void *buf, size_t buflen));
+static int ecp_ZZZ_blinded_scalar_bits(void);
+static int ecp_ZZZ_comb_spacing(void);
+static unsigned dbig_XXX_bit(DBIG_XXX value, int bit);
+static int ecp_ZZZ_in_subgroup(ECP_ZZZ *point);
 
 size_t ecp_ZZZ_length(void)
 {
@@ -44,8 +69,77 @@ void ecp_ZZZ_serialize(uint8_t *buffer_out,
     ECP_ZZZ_toOctet(&as_oct, point);
 }
 
+void ecp_ZZZ_batch_affine(ECP_ZZZ **points,
+                          size_t num_points)
+{
+    FP_YYY one;
+    FP_YYY_one(&one);
+
+    ECP_ZZZ *chunk[ECP_ZZZ_BATCH_AFFINE_CHUNK];
+    FP_YYY prefix[ECP_ZZZ_BATCH_AFFINE_CHUNK];
+    size_t i = 0;
+    while (i < num_points) {
+        // 1) Gather the next chunk of points that need converting,
+        //      and the running products of their z-coordinates:
+        //      prefix[j] = z_0 * z_1 * ... * z_j
+        size_t chunk_len = 0;
+        for (; i < num_points && chunk_len < ECP_ZZZ_BATCH_AFFINE_CHUNK; i++) {
+            if (ECP_ZZZ_isinf(points[i]) || FP_YYY_equals(&points[i]->z, &one))
+                continue;
+
+            chunk[chunk_len] = points[i];
+            if (0 == chunk_len)
+                FP_YYY_copy(&prefix[0], &points[i]->z);
+            else
+                FP_YYY_mul(&prefix[chunk_len], &prefix[chunk_len-1], &points[i]->z);
+            chunk_len++;
+        }
+        if (0 == chunk_len)
+            break;
+
+        // 2) One inversion, of the product of all z's
+        FP_YYY inverse;
+        FP_YYY_inv(&inverse, &prefix[chunk_len-1]);
+
+        // 3) Walk back, peeling off 1/z_j = (z_0 ... z_(j-1)) / (z_0 ... z_j)
+        FP_YYY iz;
+        for (size_t j = chunk_len; j-- > 0;) {
+            if (0 == j) {
+                FP_YYY_copy(&iz, &inverse);
+            } else {
+                FP_YYY_mul(&iz, &inverse, &prefix[j-1]);
+                FP_YYY_mul(&inverse, &inverse, &chunk[j]->z);
+            }
+
+            FP_YYY_mul(&chunk[j]->x, &chunk[j]->x, &iz);
+            FP_YYY_mul(&chunk[j]->y, &chunk[j]->y, &iz);
+            FP_YYY_reduce(&chunk[j]->x);
+            FP_YYY_reduce(&chunk[j]->y);
+            FP_YYY_copy(&chunk[j]->z, &one);
+        }
+    }
+}
+
 int ecp_ZZZ_deserialize(ECP_ZZZ *point_out,
                         uint8_t *buffer)
+{
+    // 1-5) Format, range, on-curve, and identity checks
+    int ret = ecp_ZZZ_deserialize_trusted(point_out, buffer);
+    if (0 != ret)
+        return ret;
+
+    // 6) Check that point is in the proper subgroup
+    //  (step 4 in X9.62 Sec 5.2.2)
+    int in_subgroup = 0;
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_SUBGROUP_CHECK, in_subgroup = ecp_ZZZ_in_subgroup(point_out));
+    if (!in_subgroup)
+        return -1;
+
+    return 0;
+}
+
+int ecp_ZZZ_deserialize_trusted(ECP_ZZZ *point_out,
+                                uint8_t *buffer)
 {
     // 1) Check that serialized point was properly formatted.
     if (0x4 != buffer[0])
@@ -78,29 +172,17 @@ int ecp_ZZZ_deserialize(ECP_ZZZ *point_out,
         return -1;
     }
 
-    // 6) Check that point is in the proper subgroup
-    //  (step 4 in X9.62 Sec 5.2.2)
-    //  (order*point == inf is equivalent to cofactor*point != inf).
-    ECP_ZZZ point_copy;
-    ECP_ZZZ_copy(&point_copy, point_out);
-
-    BIG_XXX cof;
-    BIG_XXX_rcopy(cof, CURVE_Cof_ZZZ);
-    ECP_ZZZ_mul(&point_copy, cof);
-
-    if (ECP_ZZZ_isinf(&point_copy)) {
-        return -1;
-    }
-
     return 0;
 }
 
 int32_t ecp_ZZZ_fromhash(ECP_ZZZ *point_out, const uint8_t *message, uint32_t message_length)
 {
+    ECDAA_INSTRUMENTATION_BEGIN(start);
+
     BIG_XXX curve_order;
     BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
 
-    for (int32_t i=0; i < 232; i++) {
+    for (int32_t i=0; i < FROMHASH_MAX_TRIES; i++) {
         BIG_XXX x;
         big_XXX_from_two_message_hash(&x, (uint8_t*)&i, sizeof(i), message, message_length);
         BIG_XXX_mod(x, curve_order);
@@ -121,14 +203,160 @@ int32_t ecp_ZZZ_fromhash(ECP_ZZZ *point_out, const uint8_t *message, uint32_t me
                 }
             }
 
+            ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_HASH_TO_CURVE, (uint64_t)i + 1, start);
             return i;
         }
     }
 
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_HASH_TO_CURVE, FROMHASH_MAX_TRIES, start);
+
     // If we reach here, we ran out of tries, so return error.
     return -1;
 }
 
+void ecp_ZZZ_mul_glv(ECP_ZZZ *point, BIG_XXX scalar)
+{
+    PAIR_ZZZ_G1mul(point, scalar);
+}
+
+void ecp_ZZZ_mul_secret(ECP_ZZZ *point,
+                        BIG_XXX scalar,
+                        void (*get_random)(void *buf, size_t buflen))
+{
+    ECP_ZZZ *points[1] = {point};
+    ecp_ZZZ_mul_secret_multi(points, 1, scalar, get_random);
+}
+
+void ecp_ZZZ_mul_secret_multi(ECP_ZZZ **points,
+                              size_t num_points,
+                              BIG_XXX scalar,
+                              void (*get_random)(void *buf, size_t buflen))
+{
+    assert(num_points <= ECP_ZZZ_MUL_SECRET_MULTI_MAX);
+
+    // 1) Blind the scalar: k' = k + r*n, for random r
+    DBIG_XXX blinded;
+    ecp_ZZZ_blind_scalar(blinded, scalar, get_random);
+
+    // 2) Precompute table[j][i] = [i]P_j
+    ECP_ZZZ table[ECP_ZZZ_MUL_SECRET_MULTI_MAX][SECRET_MUL_TABLE_SIZE];
+    for (size_t j = 0; j < num_points; j++) {
+        ECP_ZZZ_inf(&table[j][0]);
+        ECP_ZZZ_copy(&table[j][1], points[j]);
+        ECP_ZZZ_copy(&table[j][2], points[j]);
+        ECP_ZZZ_dbl(&table[j][2]);
+        for (int i = 3; i < SECRET_MUL_TABLE_SIZE; i++) {
+            ECP_ZZZ_copy(&table[j][i], &table[j][i-1]);
+            ECP_ZZZ_add(&table[j][i], points[j]);
+        }
+    }
+
+    // 3) Fixed-window double-and-add over every bit k' could have,
+    //      whatever its actual length, for all points in lockstep
+    //      (each window's digit is extracted once, and used for every point).
+    //      AMCL's addition formulas are complete, so adding table[j][0] (infinity) needs no special case.
+    int num_windows = (ecp_ZZZ_blinded_scalar_bits() + SECRET_MUL_WINDOW_BITS - 1) / SECRET_MUL_WINDOW_BITS;
+
+    ECP_ZZZ accumulator[ECP_ZZZ_MUL_SECRET_MULTI_MAX];
+    for (size_t j = 0; j < num_points; j++)
+        ECP_ZZZ_inf(&accumulator[j]);
+    ECP_ZZZ selected;
+    for (int window = num_windows - 1; window >= 0; window--) {
+        unsigned digit = 0;
+        for (int i = SECRET_MUL_WINDOW_BITS - 1; i >= 0; i--)
+            digit = (digit << 1) | dbig_XXX_bit(blinded, window * SECRET_MUL_WINDOW_BITS + i);
+
+        for (size_t j = 0; j < num_points; j++) {
+            for (int i = 0; i < SECRET_MUL_WINDOW_BITS; i++)
+                ECP_ZZZ_dbl(&accumulator[j]);
+
+            ecp_ZZZ_select(&selected, table[j], digit);
+
+            ECP_ZZZ_add(&accumulator[j], &selected);
+        }
+    }
+
+    ECP_ZZZ *accumulator_ptrs[ECP_ZZZ_MUL_SECRET_MULTI_MAX];
+    for (size_t j = 0; j < num_points; j++)
+        accumulator_ptrs[j] = &accumulator[j];
+    ecp_ZZZ_batch_affine(accumulator_ptrs, num_points);
+    for (size_t j = 0; j < num_points; j++)
+        ECP_ZZZ_copy(points[j], &accumulator[j]);
+
+    // Clear sensitive intermediate memory.
+    explicit_bzero(blinded, sizeof(DBIG_XXX));
+    explicit_bzero(accumulator, sizeof(accumulator));
+    explicit_bzero(&selected, sizeof(ECP_ZZZ));
+}
+
+void ecp_ZZZ_fixed_base_table_init(ECP_ZZZ table_out[ECP_ZZZ_FIXED_BASE_TABLE_SIZE],
+                                   ECP_ZZZ *base)
+{
+    // Comb with SECRET_MUL_WINDOW_BITS teeth, spaced `spacing` bits apart:
+    //  table_out[j] = sum over the set bits t of j, of [2^(t*spacing)]base
+    int spacing = ecp_ZZZ_comb_spacing();
+
+    ECP_ZZZ teeth[SECRET_MUL_WINDOW_BITS];
+    ECP_ZZZ_copy(&teeth[0], base);
+    for (int t = 1; t < SECRET_MUL_WINDOW_BITS; t++) {
+        ECP_ZZZ_copy(&teeth[t], &teeth[t-1]);
+        for (int i = 0; i < spacing; i++)
+            ECP_ZZZ_dbl(&teeth[t]);
+    }
+
+    ECP_ZZZ_inf(&table_out[0]);
+    for (int j = 1; j < ECP_ZZZ_FIXED_BASE_TABLE_SIZE; j++) {
+        // Highest set bit of j, plus the entry for the rest of j
+        int t = SECRET_MUL_WINDOW_BITS - 1;
+        while (0 == (j & (1 << t)))
+            t--;
+        ECP_ZZZ_copy(&table_out[j], &table_out[j & ~(1 << t)]);
+        ECP_ZZZ_add(&table_out[j], &teeth[t]);
+    }
+
+    ECP_ZZZ *table_ptrs[ECP_ZZZ_FIXED_BASE_TABLE_SIZE];
+    for (int j = 0; j < ECP_ZZZ_FIXED_BASE_TABLE_SIZE; j++)
+        table_ptrs[j] = &table_out[j];
+    ecp_ZZZ_batch_affine(table_ptrs, ECP_ZZZ_FIXED_BASE_TABLE_SIZE);
+}
+
+void ecp_ZZZ_mul_secret_fixed_base(ECP_ZZZ *point_out,
+                                   ECP_ZZZ table[ECP_ZZZ_FIXED_BASE_TABLE_SIZE],
+                                   BIG_XXX scalar,
+                                   void (*get_random)(void *buf, size_t buflen))
+{
+    // 1) Blind the scalar: k' = k + r*n, for random r
+    DBIG_XXX blinded;
+    ecp_ZZZ_blind_scalar(blinded, scalar, get_random);
+
+    // 2) Comb: one doubling and one (constant-time) table addition per column,
+    //      the column's digit being bits {i, i+spacing, i+2*spacing, ...} of k'.
+    int spacing = ecp_ZZZ_comb_spacing();
+
+    ECP_ZZZ accumulator;
+    ECP_ZZZ_inf(&accumulator);
+    ECP_ZZZ selected;
+    for (int column = spacing - 1; column >= 0; column--) {
+        ECP_ZZZ_dbl(&accumulator);
+
+        unsigned digit = 0;
+        for (int t = SECRET_MUL_WINDOW_BITS - 1; t >= 0; t--)
+            digit = (digit << 1) | dbig_XXX_bit(blinded, t * spacing + column);
+
+        ecp_ZZZ_select(&selected, table, digit);
+
+        ECP_ZZZ_add(&accumulator, &selected);
+    }
+
+    ECP_ZZZ_affine(&accumulator);
+    ECP_ZZZ_copy(point_out, &accumulator);
+
+    // Clear sensitive intermediate memory.
+    explicit_bzero(blinded, sizeof(DBIG_XXX));
+    explicit_bzero(&accumulator, sizeof(ECP_ZZZ));
+    explicit_bzero(&selected, sizeof(ECP_ZZZ));
+}
+
 void ecp_ZZZ_random_mod_order(BIG_XXX *big_out,
                               void (*get_random)(void *buf, size_t buflen))
 {
@@ -163,3 +391,103 @@ void ecp_ZZZ_random_mod_order(BIG_XXX *big_out,
     BIG_XXX_dmod(*big_out,d,curve_order);
 }
 
+static void ecp_ZZZ_cmove(ECP_ZZZ *point, ECP_ZZZ *other, unsigned move)
+{
+    // Branch-free: every byte is read and written, whatever `move` is
+    uint8_t mask = (uint8_t)(0u - move);
+    uint8_t *dst = (uint8_t*)point;
+    uint8_t *src = (uint8_t*)other;
+    for (size_t i = 0; i < sizeof(ECP_ZZZ); i++)
+        dst[i] ^= (uint8_t)(mask & (dst[i] ^ src[i]));
+}
+
+static void ecp_ZZZ_select(ECP_ZZZ *selected_out, ECP_ZZZ *table, unsigned digit)
+{
+    // Read every entry, keeping the one for this digit
+    ECP_ZZZ_copy(selected_out, &table[0]);
+    for (unsigned i = 1; i < SECRET_MUL_TABLE_SIZE; i++) {
+        // 1 iff digit == i (digit ^ i is less than the table size)
+        unsigned match = ((digit ^ i) - 1) >> (8*sizeof(unsigned) - 1);
+        ecp_ZZZ_cmove(selected_out, &table[i], match);
+    }
+}
+
+static void ecp_ZZZ_blind_scalar(DBIG_XXX blinded_out,
+                                 BIG_XXX scalar,
+                                 void (*get_random)(void *buf, size_t buflen))
+{
+    BIG_XXX curve_order;
+    BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
+
+    // k' = k + r*n, for random r
+    //  ([k']P == [k]P, since P has order n)
+    uint8_t r_bytes[MODBYTES_XXX] = {0};
+    get_random(r_bytes + MODBYTES_XXX - SCALAR_BLINDING_BYTES, SCALAR_BLINDING_BYTES);
+    BIG_XXX r;
+    BIG_XXX_fromBytes(r, (char*)r_bytes);
+
+    BIG_XXX_mul(blinded_out, r, curve_order);
+    DBIG_XXX k;
+    BIG_XXX_dscopy(k, scalar);
+    for (int i = 0; i < DNLEN_XXX; i++)
+        blinded_out[i] += k[i];
+    BIG_XXX_dnorm(blinded_out);
+
+    explicit_bzero(r_bytes, sizeof(r_bytes));
+    explicit_bzero(r, sizeof(BIG_XXX));
+    explicit_bzero(k, sizeof(DBIG_XXX));
+}
+
+static int ecp_ZZZ_blinded_scalar_bits(void)
+{
+    // Every bit a blinded scalar could have, whatever its actual length
+    BIG_XXX curve_order;
+    BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
+    return BIG_XXX_nbits(curve_order) + 8*SCALAR_BLINDING_BYTES + 1;
+}
+
+static int ecp_ZZZ_comb_spacing(void)
+{
+    return (ecp_ZZZ_blinded_scalar_bits() + SECRET_MUL_WINDOW_BITS - 1) / SECRET_MUL_WINDOW_BITS;
+}
+
+static unsigned dbig_XXX_bit(DBIG_XXX value, int bit)
+{
+    return (unsigned)((value[bit / BASEBITS_XXX] >> (bit % BASEBITS_XXX)) & 1);
+}
+
+static int ecp_ZZZ_in_subgroup(ECP_ZZZ *point)
+{
+#if CURVE_PAIRING_TYPE_ZZZ == BN
+    // The cofactor is 1, so every non-identity point on the curve
+    //  has prime order, and no multiplication is needed.
+    (void)point;
+    return 1;
+#else
+    // On BLS curves, the GLV endomorphism phi(x,y) = (beta*x,y)
+    //  acts on G1 as multiplication by -u^2 (u the curve parameter),
+    //  and only points in G1 satisfy phi(P) == -[u^2]P
+    //  (Scott, "A note on group membership tests for G1, G2 and GT
+    //  on BLS pairing-friendly curves").
+    //  This takes two multiplications by the 64-bit |u|,
+    //  rather than one by the full group order.
+    BIG_XXX u;
+    BIG_XXX_rcopy(u, CURVE_Bnx_ZZZ);
+
+    ECP_ZZZ multiple;
+    ECP_ZZZ_copy(&multiple, point);
+    ECP_ZZZ_mul(&multiple, u);
+    if (ECP_ZZZ_equals(&multiple, point))
+        return 0;   // [u]P == P only for low-order points
+    ECP_ZZZ_mul(&multiple, u);
+    ECP_ZZZ_neg(&multiple);
+
+    FP_YYY beta;
+    FP_YYY_rcopy(&beta, CURVE_Cru_ZZZ);
+    ECP_ZZZ endo;
+    ECP_ZZZ_copy(&endo, point);
+    FP_YYY_mul(&(endo.x), &(endo.x), &beta);
+
+    return ECP_ZZZ_equals(&endo, &multiple);
+#endif
+}
@@ -45,6 +45,20 @@ void ecp_ZZZ_set_to_generator(ECP_ZZZ *point);
 void ecp_ZZZ_serialize(uint8_t *buffer_out,
                        ECP_ZZZ *point);
 
+/*
+ * Convert `points` to affine coordinates in-place
+ * (as `ECP_ZZZ_affine` does for one point),
+ * sharing one field inversion among each `ECP_ZZZ_BATCH_AFFINE_CHUNK` points
+ * (Montgomery's trick).
+ *
+ * Points already in affine coordinates, or at infinity, are left alone.
+ * Serializing a point converts it to affine coordinates first,
+ * so calling this before serializing several points saves all but one inversion.
+ */
+#define ECP_ZZZ_BATCH_AFFINE_CHUNK 64
+void ecp_ZZZ_batch_affine(ECP_ZZZ **points,
+                          size_t num_points);
+
 /*
  * De-serialize an ECP_ZZZ point.
  *
@@ -57,6 +71,20 @@ void ecp_ZZZ_serialize(uint8_t *buffer_out,
 int ecp_ZZZ_deserialize(ECP_ZZZ *point_out,
                         uint8_t *buffer);
 
+/*
+ * Same as `ecp_ZZZ_deserialize`, but without the subgroup check
+ * (the only expensive step, as it's a full scalar multiplication).
+ *
+ * Only for points read back from trusted storage,
+ * which were fully checked before they were stored.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the point is not on the curve
+ */
+int ecp_ZZZ_deserialize_trusted(ECP_ZZZ *point_out,
+                                uint8_t *buffer);
+
 /*
  * Hash a message into an ECP_ZZZ point.
  *
@@ -75,6 +103,76 @@ int ecp_ZZZ_deserialize(ECP_ZZZ *point_out,
  */
 int32_t ecp_ZZZ_fromhash(ECP_ZZZ *point_out, const uint8_t *message, uint32_t message_length);
 
+/*
+ * Multiply `point` by `scalar` in-place, using the GLV endomorphism decomposition
+ * (on curves where AMCL enables it, else plain `ECP_ZZZ_mul`).
+ *
+ * Like `ECP_ZZZ_mul`, the number of windows depends on the scalar's bit-length,
+ * so this is meant for public scalars (cf. `ecp_ZZZ_mul_secret`).
+ *
+ * `point` MUST be in the prime-order subgroup (the decomposition is only valid there),
+ * so this must NOT be used for subgroup checks or cofactor clearing.
+ */
+void ecp_ZZZ_mul_glv(ECP_ZZZ *point, BIG_XXX scalar);
+
+/*
+ * Multiply `point` by the secret `scalar` in-place, hardened against side-channels.
+ *
+ * The scalar is first blinded with a random multiple of the group order,
+ * then a fixed-window ladder runs over a fixed number of bits,
+ * reading every table entry for every window (so neither the running time
+ * nor the memory-access pattern depends on the scalar).
+ * This is slower than `ecp_ZZZ_mul_glv` (whose window count depends on the scalar's bit-length),
+ * so it's used only where the scalar is secret (keys, nonces, credential randomizers);
+ * verification, where every scalar is public, keeps using `ecp_ZZZ_mul_glv`.
+ *
+ * `point` MUST be in the prime-order subgroup.
+ */
+void ecp_ZZZ_mul_secret(ECP_ZZZ *point,
+                        BIG_XXX scalar,
+                        void (*get_random)(void *buf, size_t buflen));
+
+#define ECP_ZZZ_MUL_SECRET_MULTI_MAX 4
+
+/*
+ * Multiply each of `points` by the same secret `scalar` in-place.
+ *
+ * Equivalent to calling `ecp_ZZZ_mul_secret` on each point,
+ * but the scalar is blinded and split into windows only once,
+ * and the points go through the ladder in lockstep.
+ *
+ * `num_points` MUST be at most `ECP_ZZZ_MUL_SECRET_MULTI_MAX`,
+ * and every point MUST be in the prime-order subgroup.
+ */
+void ecp_ZZZ_mul_secret_multi(ECP_ZZZ **points,
+                              size_t num_points,
+                              BIG_XXX scalar,
+                              void (*get_random)(void *buf, size_t buflen));
+
+#define ECP_ZZZ_FIXED_BASE_TABLE_SIZE 16
+
+/*
+ * Precompute the table used by `ecp_ZZZ_mul_secret_fixed_base` for `base`.
+ *
+ * Worth it when the same (public) base is multiplied by many secret scalars.
+ * `base` MUST be in the prime-order subgroup.
+ */
+void ecp_ZZZ_fixed_base_table_init(ECP_ZZZ table_out[ECP_ZZZ_FIXED_BASE_TABLE_SIZE],
+                                   ECP_ZZZ *base);
+
+/*
+ * Set `point_out` to [scalar]base, for the secret `scalar`,
+ * using a table from `ecp_ZZZ_fixed_base_table_init`.
+ *
+ * Hardened the same way as `ecp_ZZZ_mul_secret` (blinded scalar, fixed number of steps,
+ * every table entry read at each step), but uses a comb,
+ * so it needs about a quarter of the doublings.
+ */
+void ecp_ZZZ_mul_secret_fixed_base(ECP_ZZZ *point_out,
+                                   ECP_ZZZ table[ECP_ZZZ_FIXED_BASE_TABLE_SIZE],
+                                   BIG_XXX scalar,
+                                   void (*get_random)(void *buf, size_t buflen));
+
 /*
  * Generate a uniformly-distributed pseudo-random number,
  * between [0, n], where n is the order of the EC group.
@@ -18,6 +18,8 @@
 
 #include "./pairing_ZZZ.h"
 
+#include "internal-utilities/instrumentation.h"
+
 #include <amcl/fp2_ZZZ.h>
 #include <amcl/pair_ZZZ.h>
 
@@ -25,6 +27,31 @@ void compute_pairing_ZZZ(FP12_YYY *pairing_out,
                          ECP_ZZZ *g1_point,
                          ECP2_ZZZ *g2_point)
 {
+    ECDAA_INSTRUMENTATION_BEGIN(start);
+
     PAIR_ZZZ_ate(pairing_out, g2_point, g1_point);
     PAIR_ZZZ_fexp(pairing_out);
+
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_PAIRING, 1, start);
+}
+
+void compute_pairing_product_ZZZ(FP12_YYY *pairing_out,
+                                 ECP_ZZZ *g1_one,
+                                 ECP2_ZZZ *g2_one,
+                                 ECP_ZZZ *g1_two,
+                                 ECP2_ZZZ *g2_two,
+                                 ECP_ZZZ *g1_three,
+                                 ECP2_ZZZ *g2_three)
+{
+    ECDAA_INSTRUMENTATION_BEGIN(start);
+
+    PAIR_ZZZ_double_ate(pairing_out, g2_one, g1_one, g2_two, g1_two);
+
+    FP12_YYY third;
+    PAIR_ZZZ_ate(&third, g2_three, g1_three);
+    FP12_YYY_mul(pairing_out, &third);
+
+    PAIR_ZZZ_fexp(pairing_out);
+
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_PAIRING, 3, start);
 }
@@ -37,6 +37,22 @@ void compute_pairing_ZZZ(FP12_YYY *pairing_out,
                          ECP_ZZZ *g1_point,
                          ECP2_ZZZ *g2_point);
 
+/*
+ * Compute the product of three optimal Ate pairings,
+ *  e(g1_one, g2_one) * e(g1_two, g2_two) * e(g1_three, g2_three).
+ *
+ * The Miller loops for the first two pairings are interleaved,
+ * and all three share one final exponentiation,
+ * so this is much cheaper than three calls to `compute_pairing_ZZZ`.
+ */
+void compute_pairing_product_ZZZ(FP12_YYY *pairing_out,
+                                 ECP_ZZZ *g1_one,
+                                 ECP2_ZZZ *g2_one,
+                                 ECP_ZZZ *g1_two,
+                                 ECP2_ZZZ *g2_two,
+                                 ECP_ZZZ *g1_three,
+                                 ECP2_ZZZ *g2_three);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "instrumentation.h"
+
+#ifdef ECDAA_INSTRUMENTATION
+
+#include <stddef.h>
+#include <time.h>
+
+// Counters are updated with relaxed atomics, so concurrent callers never lose counts,
+// but a snapshot taken while operations are running may be mid-update.
+static struct ecdaa_instrumentation_counter counters[ECDAA_INSTRUMENTATION_EVENT_COUNT];
+
+static ecdaa_instrumentation_callback registered_callback = NULL;
+static void *registered_user_data = NULL;
+
+uint64_t ecdaa_instrumentation_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void ecdaa_instrumentation_record(enum ecdaa_instrumentation_event event,
+                                  uint64_t items,
+                                  uint64_t start_ns)
+{
+    uint64_t elapsed = ecdaa_instrumentation_now() - start_ns;
+
+    __atomic_fetch_add(&counters[event].calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&counters[event].items, items, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&counters[event].nanoseconds, elapsed, __ATOMIC_RELAXED);
+
+    if (NULL != registered_callback)
+        registered_callback(event, items, elapsed, registered_user_data);
+}
+
+void ecdaa_instrumentation_load(struct ecdaa_instrumentation_counter *counter_out,
+                                enum ecdaa_instrumentation_event event)
+{
+    counter_out->calls = __atomic_load_n(&counters[event].calls, __ATOMIC_RELAXED);
+    counter_out->items = __atomic_load_n(&counters[event].items, __ATOMIC_RELAXED);
+    counter_out->nanoseconds = __atomic_load_n(&counters[event].nanoseconds, __ATOMIC_RELAXED);
+}
+
+void ecdaa_instrumentation_clear(void)
+{
+    for (unsigned i = 0; i < ECDAA_INSTRUMENTATION_EVENT_COUNT; i++) {
+        __atomic_store_n(&counters[i].calls, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&counters[i].items, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&counters[i].nanoseconds, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void ecdaa_instrumentation_register(ecdaa_instrumentation_callback callback,
+                                    void *user_data)
+{
+    registered_callback = callback;
+    registered_user_data = user_data;
+}
+
+#else
+
+// ISO C forbids an empty translation unit
+typedef int ecdaa_instrumentation_disabled;
+
+#endif
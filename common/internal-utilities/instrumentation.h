@@ -0,0 +1,89 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_INTERNAL_INSTRUMENTATION_H
+#define ECDAA_INTERNAL_INSTRUMENTATION_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/instrumentation.h>
+
+#include <stdint.h>
+
+#ifdef ECDAA_INSTRUMENTATION
+
+/*
+ * Monotonic timestamp, in nanoseconds.
+ */
+uint64_t ecdaa_instrumentation_now(void);
+
+/*
+ * Add one call covering `items` items, which started at `start_ns`, to the counter for `event`,
+ * and forward it to the registered callback (if any).
+ */
+void ecdaa_instrumentation_record(enum ecdaa_instrumentation_event event,
+                                  uint64_t items,
+                                  uint64_t start_ns);
+
+/*
+ * Copy the cumulative counter for `event` (which must be a known event) into `counter_out`.
+ */
+void ecdaa_instrumentation_load(struct ecdaa_instrumentation_counter *counter_out,
+                                enum ecdaa_instrumentation_event event);
+
+/*
+ * Zero all counters.
+ */
+void ecdaa_instrumentation_clear(void);
+
+/*
+ * Set the callback `ecdaa_instrumentation_record` forwards to (`NULL` for none).
+ */
+void ecdaa_instrumentation_register(ecdaa_instrumentation_callback callback,
+                                    void *user_data);
+
+#define ECDAA_INSTRUMENTATION_BEGIN(start) \
+    uint64_t start = ecdaa_instrumentation_now()
+
+#define ECDAA_INSTRUMENTATION_END(event, items, start) \
+    ecdaa_instrumentation_record((event), (items), (start))
+
+#else
+
+// Without ECDAA_INSTRUMENTATION the hooks compile away entirely
+// (`items` is not evaluated, so it must not have side effects).
+#define ECDAA_INSTRUMENTATION_BEGIN(start)
+#define ECDAA_INSTRUMENTATION_END(event, items, start) ((void)0)
+
+#endif
+
+#define ECDAA_INSTRUMENTED(event, statement) \
+    do { \
+        ECDAA_INSTRUMENTATION_BEGIN(ecdaa_instrumentation_start_); \
+        statement; \
+        ECDAA_INSTRUMENTATION_END((event), 1, ecdaa_instrumentation_start_); \
+    } while(0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
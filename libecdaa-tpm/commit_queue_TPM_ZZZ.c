@@ -0,0 +1,169 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa-tpm/commit_queue_TPM_ZZZ.h>
+
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa-tpm/tpm_context.h>
+
+#include "schnorr-tpm/schnorr_TPM_ZZZ.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "internal-utilities/explicit_bzero.h"
+
+static
+int prepare_commit_ZZZ(struct ecdaa_tpm_prepared_commit_ZZZ *entry_out,
+                       struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                       ecdaa_rand_func get_random,
+                       struct ecdaa_tpm_context *tpm_ctx);
+
+int ecdaa_tpm_commit_queue_ZZZ_init(struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                                    size_t capacity,
+                                    struct ecdaa_credential_ZZZ *cred,
+                                    const uint8_t *basename,
+                                    uint32_t basename_len)
+{
+    if (0 == capacity || capacity > ECDAA_TPM_COMMIT_QUEUE_MAX_LENGTH)
+        return -1;
+
+    if ((NULL == basename) != (0 == basename_len))
+        return -1;
+
+    queue->capacity = capacity;
+    queue->head = 0;
+    queue->length = 0;
+
+    queue->cred = cred;
+    queue->basename = basename;
+    queue->basename_len = basename_len;
+
+    return 0;
+}
+
+int ecdaa_tpm_commit_queue_ZZZ_refill(struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                                      ecdaa_rand_func get_random,
+                                      struct ecdaa_tpm_context *tpm_ctx)
+{
+    while (queue->length < queue->capacity) {
+        size_t tail = (queue->head + queue->length) % queue->capacity;
+        if (0 != prepare_commit_ZZZ(&queue->entries[tail], queue, get_random, tpm_ctx))
+            return -1;
+
+        ++queue->length;
+    }
+
+    return 0;
+}
+
+size_t ecdaa_tpm_commit_queue_ZZZ_length(struct ecdaa_tpm_commit_queue_ZZZ *queue)
+{
+    return queue->length;
+}
+
+void ecdaa_tpm_commit_queue_ZZZ_clear(struct ecdaa_tpm_commit_queue_ZZZ *queue)
+{
+    explicit_bzero(queue->entries, sizeof(queue->entries));
+    queue->head = 0;
+    queue->length = 0;
+}
+
+int ecdaa_tpm_commit_queue_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
+                                    const uint8_t* message,
+                                    uint32_t message_len,
+                                    struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                                    ecdaa_rand_func get_random,
+                                    struct ecdaa_tpm_context *tpm_ctx)
+{
+    int ret = -1;
+
+    int attempts = 1;
+    while (attempts < MAX_TPM_SIGN_ATTEMPTS) {
+        // 1) Take the oldest prepared commit (making one now, if none are left)
+        struct ecdaa_tpm_prepared_commit_ZZZ entry;
+        if (0 == queue->length) {
+            if (0 != prepare_commit_ZZZ(&entry, queue, get_random, tpm_ctx))
+                return -1;
+        } else {
+            entry = queue->entries[queue->head];
+            explicit_bzero(&queue->entries[queue->head], sizeof(queue->entries[queue->head]));
+            queue->head = (queue->head + 1) % queue->capacity;
+            --queue->length;
+        }
+
+        // 2) Finish the Schnorr-like signature on W concatenated with the message,
+        //  where the basepoint is S.
+        ret = schnorr_sign_with_commit_TPM_ZZZ(&signature_out->c,
+                                               &signature_out->s,
+                                               &signature_out->n,
+                                               &signature_out->K,
+                                               &entry.commit,
+                                               message,
+                                               message_len,
+                                               &entry.S,
+                                               &entry.W,
+                                               queue->basename,
+                                               queue->basename_len,
+                                               tpm_ctx);
+        if (0 == ret) {
+            ECP_ZZZ_copy(&signature_out->R, &entry.R);
+            ECP_ZZZ_copy(&signature_out->S, &entry.S);
+            ECP_ZZZ_copy(&signature_out->T, &entry.T);
+            ECP_ZZZ_copy(&signature_out->W, &entry.W);
+        }
+
+        explicit_bzero(&entry, sizeof(entry));
+
+        if (-4 != ret)
+            break;
+
+        ++attempts;
+    }
+
+    // A failed TPM2_Sign most likely means the TPM no longer knows our commits.
+    if (-2 == ret)
+        ecdaa_tpm_commit_queue_ZZZ_clear(queue);
+
+    return (0 == ret) ? 0 : -1;
+}
+
+int prepare_commit_ZZZ(struct ecdaa_tpm_prepared_commit_ZZZ *entry_out,
+                       struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                       ecdaa_rand_func get_random,
+                       struct ecdaa_tpm_context *tpm_ctx)
+{
+    // 1) Randomize credential
+    BIG_XXX l;
+    ecp_ZZZ_random_mod_order(&l, get_random);
+
+    ECP_ZZZ_copy(&entry_out->R, &queue->cred->A);
+    ECP_ZZZ_copy(&entry_out->S, &queue->cred->B);
+    ECP_ZZZ_copy(&entry_out->T, &queue->cred->C);
+    ECP_ZZZ_copy(&entry_out->W, &queue->cred->D);
+    ECP_ZZZ *points[4] = {&entry_out->R, &entry_out->S, &entry_out->T, &entry_out->W};
+    ecp_ZZZ_mul_secret_multi(points, 4, l, get_random);
+
+    BIG_XXX_zero(l);
+
+    // 2) Commit, with basepoint S
+    return schnorr_commit_TPM_ZZZ(&entry_out->commit,
+                                  &entry_out->S,
+                                  queue->basename,
+                                  queue->basename_len,
+                                  tpm_ctx);
+}
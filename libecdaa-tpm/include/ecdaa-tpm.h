@@ -22,6 +22,8 @@
 
 #include <ecdaa-tpm/member_keypair_TPM_ZZZ.h>
 #include <ecdaa-tpm/signature_TPM_ZZZ.h>
+#include <ecdaa-tpm/commit_queue_TPM_ZZZ.h>
 #include <ecdaa-tpm/tpm_context.h>
+#include <ecdaa-tpm/tpm_context_pool.h>
 
 #endif
@@ -0,0 +1,156 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_COMMIT_QUEUE_TPM_ZZZ_H
+#define ECDAA_COMMIT_QUEUE_TPM_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/rand.h>
+
+#include <amcl/ecp_ZZZ.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ecdaa_tpm_context;
+struct ecdaa_credential_ZZZ;
+
+#ifndef ECDAA_TPM_COMMIT_QUEUE_MAX_LENGTH
+#define ECDAA_TPM_COMMIT_QUEUE_MAX_LENGTH 8
+#endif
+
+/*
+ * Outputs of one TPM2_Commit.
+ *
+ * `L` and `K` are only set if the commit was for a basename.
+ */
+struct ecdaa_tpm_commit_ZZZ {
+    uint16_t counter;
+    ECP_ZZZ R;
+    ECP_ZZZ L;
+    ECP_ZZZ K;
+};
+
+/*
+ * A randomized credential (cf. `ecdaa_signature_ZZZ`),
+ * plus a TPM2_Commit for its `S` point.
+ */
+struct ecdaa_tpm_prepared_commit_ZZZ {
+    ECP_ZZZ R;
+    ECP_ZZZ S;
+    ECP_ZZZ T;
+    ECP_ZZZ W;
+    struct ecdaa_tpm_commit_ZZZ commit;
+};
+
+/*
+ * Commit-ahead queue for TPM signing.
+ *
+ * TPM2_Commit is issued ahead of time (by `ecdaa_tpm_commit_queue_ZZZ_refill`,
+ * e.g. whenever the caller is idle), so that `ecdaa_tpm_commit_queue_ZZZ_sign`
+ * usually only needs the final TPM2_Sign round-trip.
+ *
+ * All signatures from one queue use the same credential and basename.
+ *
+ * The TPM only tracks a limited number of outstanding commits
+ * (and forgets them on reset), so `capacity` should be kept small.
+ */
+struct ecdaa_tpm_commit_queue_ZZZ {
+    struct ecdaa_tpm_prepared_commit_ZZZ entries[ECDAA_TPM_COMMIT_QUEUE_MAX_LENGTH];
+    size_t capacity;
+    size_t head;
+    size_t length;
+
+    struct ecdaa_credential_ZZZ *cred;
+    const uint8_t *basename;
+    uint32_t basename_len;
+};
+
+/*
+ * Initialize an empty commit queue.
+ *
+ * `cred` and `basename` are NOT copied, and must remain valid
+ * as long as the queue is used.
+ *
+ * To create unlinkable signatures,
+ * `basename` must be `NULL` *and* `basename_len` must be `0`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `capacity` is 0 or larger than `ECDAA_TPM_COMMIT_QUEUE_MAX_LENGTH`,
+ *      or if one (but not both) of `basename` and `basename_len` is zero
+ */
+int ecdaa_tpm_commit_queue_ZZZ_init(struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                                    size_t capacity,
+                                    struct ecdaa_credential_ZZZ *cred,
+                                    const uint8_t *basename,
+                                    uint32_t basename_len);
+
+/*
+ * Randomize the credential and call TPM2_Commit
+ * until the queue holds `capacity` prepared commits.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if TPM2_Commit fails (any commits already made are kept)
+ */
+int ecdaa_tpm_commit_queue_ZZZ_refill(struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                                      ecdaa_rand_func get_random,
+                                      struct ecdaa_tpm_context *tpm_ctx);
+
+/*
+ * Number of prepared commits currently in the queue.
+ */
+size_t ecdaa_tpm_commit_queue_ZZZ_length(struct ecdaa_tpm_commit_queue_ZZZ *queue);
+
+/*
+ * Discard (and clear) all prepared commits.
+ *
+ * Must be called if the TPM was reset, or the signing key reloaded.
+ */
+void ecdaa_tpm_commit_queue_ZZZ_clear(struct ecdaa_tpm_commit_queue_ZZZ *queue);
+
+/*
+ * Create an ECDAA signature, using a TPM and a prepared commit from `queue`
+ * (using the queue's credential and basename).
+ *
+ * If the queue is empty, a commit is made first (as in `ecdaa_signature_TPM_ZZZ_sign`).
+ *
+ * If TPM2_Sign fails, the queue is cleared, since its commits are likely stale.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if unable to create signature
+ */
+int ecdaa_tpm_commit_queue_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
+                                    const uint8_t* message,
+                                    uint32_t message_len,
+                                    struct ecdaa_tpm_commit_queue_ZZZ *queue,
+                                    ecdaa_rand_func get_random,
+                                    struct ecdaa_tpm_context *tpm_ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
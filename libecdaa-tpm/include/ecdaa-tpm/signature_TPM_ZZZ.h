@@ -26,10 +26,15 @@ extern "C" {
 
 #include <ecdaa/signature_ZZZ.h>
 #include <ecdaa/rand.h>
+#include <ecdaa-tpm/commit_queue_TPM_ZZZ.h>
 
+#include <tss2/tss2_tpm2_types.h>
+
+#include <stddef.h>
 #include <stdint.h>
 
 struct ecdaa_tpm_context;
+struct ecdaa_tpm_context_pool;
 
 /*
  * Create an ECDAA signature, using a TPM.
@@ -50,6 +55,111 @@ int ecdaa_signature_TPM_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
                                  ecdaa_rand_func get_random,
                                  struct ecdaa_tpm_context *tpm_ctx);
 
+/*
+ * Create ECDAA signatures on `num_messages` messages, using a TPM
+ *  (as for `ecdaa_signature_TPM_ZZZ_sign`, with the same basename and credential for each).
+ *
+ * The TPM2_Commit and TPM2_Sign commands for consecutive signatures are pipelined,
+ *  so the host-side work for each signature happens while the TPM is busy
+ *  and the TPM never waits on the host between commands.
+ *
+ * Message i is `messages[i]`, of length `message_lens[i]`,
+ *  and its signature is written to `signatures_out[i]`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if unable to create all signatures (none of `signatures_out` should then be used)
+ */
+int ecdaa_signature_TPM_ZZZ_sign_batch(struct ecdaa_signature_ZZZ *signatures_out,
+                                       const uint8_t* const *messages,
+                                       const uint32_t *message_lens,
+                                       size_t num_messages,
+                                       const uint8_t* basename,
+                                       uint32_t basename_len,
+                                       struct ecdaa_credential_ZZZ *cred,
+                                       ecdaa_rand_func get_random,
+                                       struct ecdaa_tpm_context *tpm_ctx);
+
+/*
+ * Create an ECDAA signature, using a TPM context taken from `pool`
+ *  (cf. `ecdaa_signature_TPM_ZZZ_sign`).
+ *
+ * Blocks until a context is available.
+ * May be called concurrently from multiple threads,
+ *  as long as `get_random` is thread-safe.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if unable to create signature
+ */
+int ecdaa_signature_TPM_ZZZ_sign_pooled(struct ecdaa_signature_ZZZ *signature_out,
+                                        const uint8_t* message,
+                                        uint32_t message_len,
+                                        const uint8_t* basename,
+                                        uint32_t basename_len,
+                                        struct ecdaa_credential_ZZZ *cred,
+                                        ecdaa_rand_func get_random,
+                                        struct ecdaa_tpm_context_pool *pool);
+
+/*
+ * In-progress asynchronous TPM signature (cf. `ecdaa_signature_TPM_ZZZ_sign_async_start`).
+ */
+struct ecdaa_signature_TPM_ZZZ_async {
+    int state;
+    int attempts;
+
+    struct ecdaa_signature_ZZZ *signature_out;
+    const uint8_t *message;
+    uint32_t message_len;
+    const uint8_t *basename;
+    uint32_t basename_len;
+
+    struct ecdaa_tpm_commit_ZZZ commit;
+    TPM2B_DIGEST digest;
+
+    struct ecdaa_tpm_context *tpm_ctx;
+};
+
+/*
+ * Start creating an ECDAA signature using a TPM, without blocking on the TPM
+ *  (as for `ecdaa_signature_TPM_ZZZ_sign`).
+ *
+ * This randomizes the credential and sends TPM2_Commit.
+ * The signature is then completed by calling `ecdaa_signature_TPM_ZZZ_sign_async_step`,
+ *  e.g. whenever the TPM's poll handles (cf. `ecdaa_tpm_context_get_poll_handles`) are readable.
+ *
+ * `signature_out`, `message`, `basename`, and `tpm_ctx` must remain valid until the signature completes,
+ *  and `tpm_ctx` must not be used for anything else in the meantime.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if unable to start the signature
+ */
+int ecdaa_signature_TPM_ZZZ_sign_async_start(struct ecdaa_signature_TPM_ZZZ_async *async,
+                                             struct ecdaa_signature_ZZZ *signature_out,
+                                             const uint8_t* message,
+                                             uint32_t message_len,
+                                             const uint8_t* basename,
+                                             uint32_t basename_len,
+                                             struct ecdaa_credential_ZZZ *cred,
+                                             ecdaa_rand_func get_random,
+                                             struct ecdaa_tpm_context *tpm_ctx);
+
+/*
+ * Advance an asynchronous TPM signature,
+ *  waiting at most `timeout` milliseconds for the TPM
+ *  (`0` never blocks, `TSS2_TCTI_TIMEOUT_BLOCK` waits indefinitely).
+ *
+ * Must be called until it returns something other than 1.
+ *
+ * Returns:
+ * 0 if the signature is complete
+ * 1 if waiting on the TPM (call again later)
+ * -1 if unable to create signature
+ */
+int ecdaa_signature_TPM_ZZZ_sign_async_step(struct ecdaa_signature_TPM_ZZZ_async *async,
+                                            int32_t timeout);
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,6 +63,20 @@ int ecdaa_tpm_context_init(struct ecdaa_tpm_context *tpm_ctx,
 
 void ecdaa_tpm_context_free(struct ecdaa_tpm_context *tpm_ctx);
 
+/*
+ * Get the TCTI's poll handles (e.g. file descriptors, on Linux),
+ *  which become readable when a response to an asynchronous command is ready.
+ *
+ * As with `Tss2_Tcti_GetPollHandles`, if `handles` is NULL only `num_handles` is set.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the TCTI doesn't support polling (check tpm-ctx->last_return_code)
+ */
+int ecdaa_tpm_context_get_poll_handles(struct ecdaa_tpm_context *tpm_ctx,
+                                       TSS2_TCTI_POLL_HANDLE *handles,
+                                       size_t *num_handles);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,105 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_TPM_CONTEXT_POOL_H
+#define ECDAA_TPM_CONTEXT_POOL_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ECDAA_TPM_CONTEXT_POOL_MAX_SIZE
+#define ECDAA_TPM_CONTEXT_POOL_MAX_SIZE 16
+#endif
+
+#include <pthread.h>
+#include <stddef.h>
+
+struct ecdaa_tpm_context;
+
+/*
+ * A set of `ecdaa_tpm_context`s shared by multiple threads.
+ *
+ * An `ecdaa_tpm_context` (and its TCTI connection) may only be used by one thread at a time,
+ * so each thread acquires a context from the pool for the duration of a TPM operation.
+ * Waiting threads are served in the order they called `ecdaa_tpm_context_pool_acquire`,
+ * and successive acquisitions rotate through the contexts.
+ *
+ * Each context must have its own TCTI connection
+ * (e.g. several connections to a TPM resource manager, or one per vTPM),
+ * and all must use the same signing key.
+ */
+struct ecdaa_tpm_context_pool {
+    struct ecdaa_tpm_context *contexts[ECDAA_TPM_CONTEXT_POOL_MAX_SIZE];
+    int in_use[ECDAA_TPM_CONTEXT_POOL_MAX_SIZE];
+    size_t num_contexts;
+    size_t num_available;
+    size_t next_context;
+
+    unsigned long next_ticket;
+    unsigned long now_serving;
+
+    pthread_mutex_t lock;
+    pthread_cond_t available;
+};
+
+/*
+ * Initialize a pool of the `num_contexts` (already initialized) contexts in `contexts`.
+ *
+ * The contexts are NOT copied, and must remain valid until `ecdaa_tpm_context_pool_free`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `num_contexts` is 0 or larger than `ECDAA_TPM_CONTEXT_POOL_MAX_SIZE`,
+ *      or any context is NULL
+ * -2 if the pool's lock can't be created
+ */
+int ecdaa_tpm_context_pool_init(struct ecdaa_tpm_context_pool *pool,
+                                struct ecdaa_tpm_context **contexts,
+                                size_t num_contexts);
+
+/*
+ * Free the pool's resources (the contexts themselves are NOT freed).
+ *
+ * No contexts may be in use.
+ */
+void ecdaa_tpm_context_pool_free(struct ecdaa_tpm_context_pool *pool);
+
+/*
+ * Take a context from the pool, blocking until one is available.
+ *
+ * The context must be returned with `ecdaa_tpm_context_pool_release`.
+ */
+struct ecdaa_tpm_context *ecdaa_tpm_context_pool_acquire(struct ecdaa_tpm_context_pool *pool);
+
+/*
+ * Return a context taken by `ecdaa_tpm_context_pool_acquire`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `tpm_ctx` isn't an acquired context of this pool
+ */
+int ecdaa_tpm_context_pool_release(struct ecdaa_tpm_context_pool *pool,
+                                   struct ecdaa_tpm_context *tpm_ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,6 +29,7 @@ struct ecdaa_prng;
 #define MAX_TPM_SIGN_ATTEMPTS 10
 
 #include <ecdaa-tpm/tpm_context.h>
+#include <ecdaa-tpm/commit_queue_TPM_ZZZ.h>
 
 #include <amcl/big_XXX.h>
 #include <amcl/ecp_ZZZ.h>
@@ -73,6 +74,82 @@ int schnorr_sign_TPM_ZZZ(BIG_XXX *c_out,
                          uint32_t basename_length,
                          struct ecdaa_tpm_context *tpm_ctx);
 
+/*
+ * Perform only the TPM2_Commit half of `schnorr_sign_TPM_ZZZ`.
+ *
+ * The returned commit can be used (exactly once) by `schnorr_sign_with_commit_TPM_ZZZ`,
+ *  with the same basepoint and basename.
+ *
+ *  Returns:
+ *   0 on success
+ *   -1 if TPM2_Commit fails, or if one (but not both) of basename and basename_length is zero
+ */
+int schnorr_commit_TPM_ZZZ(struct ecdaa_tpm_commit_ZZZ *commit_out,
+                           ECP_ZZZ *basepoint,
+                           const uint8_t *basename,
+                           uint32_t basename_length,
+                           struct ecdaa_tpm_context *tpm_ctx);
+
+/*
+ * Perform the TPM2_Sign half of `schnorr_sign_TPM_ZZZ`, using a commit
+ *  previously obtained from `schnorr_commit_TPM_ZZZ`.
+ *
+ * The commit is consumed by the TPM, whether or not this succeeds.
+ *
+ *  Returns:
+ *   0 on success
+ *   -1 if one (but not both) of basename and basename_length is zero
+ *   -2 if TPM2_Sign fails
+ *   -3 if the basename can't be hashed into a G1 point
+ *   -4 if TPM2_Sign returns a nonce with fewer than MODBYTES_XXX bytes (retry with a new commit)
+ */
+int schnorr_sign_with_commit_TPM_ZZZ(BIG_XXX *c_out,
+                                     BIG_XXX *s_out,
+                                     BIG_XXX *n_out,
+                                     ECP_ZZZ *K_out,
+                                     struct ecdaa_tpm_commit_ZZZ *commit,
+                                     const uint8_t *msg_in,
+                                     uint32_t msg_len,
+                                     ECP_ZZZ *basepoint,
+                                     ECP_ZZZ *public_key,
+                                     const uint8_t *basename,
+                                     uint32_t basename_length,
+                                     struct ecdaa_tpm_context *tpm_ctx);
+
+/*
+ * Compute the digest c' to be signed by TPM2_Sign (the first half of `schnorr_sign_with_commit_TPM_ZZZ`).
+ *
+ * K_out is set (from the commit, or to the generator if there's no basename).
+ *
+ *  Returns:
+ *   0 on success
+ *   -1 if one (but not both) of basename and basename_length is zero
+ *   -3 if the basename can't be hashed into a G1 point
+ */
+int schnorr_digest_TPM_ZZZ(TPM2B_DIGEST *digest_out,
+                           ECP_ZZZ *K_out,
+                           struct ecdaa_tpm_commit_ZZZ *commit,
+                           const uint8_t *msg_in,
+                           uint32_t msg_len,
+                           ECP_ZZZ *basepoint,
+                           ECP_ZZZ *public_key,
+                           const uint8_t *basename,
+                           uint32_t basename_length);
+
+/*
+ * Compute c_out, s_out, and n_out from the TPM2_Sign response for `digest`
+ *  (the second half of `schnorr_sign_with_commit_TPM_ZZZ`).
+ *
+ *  Returns:
+ *   0 on success
+ *   -4 if TPM2_Sign returned a nonce with fewer than MODBYTES_XXX bytes (retry with a new commit)
+ */
+int schnorr_complete_TPM_ZZZ(BIG_XXX *c_out,
+                             BIG_XXX *s_out,
+                             BIG_XXX *n_out,
+                             TPMT_SIGNATURE *signature,
+                             TPM2B_DIGEST *digest);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,15 +21,42 @@
 #include <ecdaa/credential_ZZZ.h>
 #include <ecdaa/signature_ZZZ.h>
 #include <ecdaa-tpm/tpm_context.h>
+#include <ecdaa-tpm/tpm_context_pool.h>
 
 #include "schnorr-tpm/schnorr_TPM_ZZZ.h"
+#include "tpm/commit_ZZZ.h"
+#include "tpm/sign.h"
 
 #include "amcl-extensions/ecp_ZZZ.h"
+#include "internal-utilities/explicit_bzero.h"
+
+enum {
+    ASYNC_COMMITTING = 1,
+    ASYNC_SIGNING,
+    ASYNC_DONE,
+    ASYNC_FAILED
+};
+
+static
+void randomize_basepoint_ZZZ(BIG_XXX *l_out,
+                             struct ecdaa_credential_ZZZ *cred,
+                             ecdaa_rand_func get_random,
+                             struct ecdaa_signature_ZZZ *signature_out);
+
+static
+void randomize_rest_of_credential_ZZZ(BIG_XXX l,
+                                      struct ecdaa_credential_ZZZ *cred,
+                                      ecdaa_rand_func get_random,
+                                      struct ecdaa_signature_ZZZ *signature_out);
 
 static
-void randomize_credential_ZZZ(struct ecdaa_credential_ZZZ *cred,
-                              ecdaa_rand_func get_random,
-                              struct ecdaa_signature_ZZZ *signature_out);
+int async_start_commit(struct ecdaa_signature_TPM_ZZZ_async *async);
+
+static
+int async_finish_commit(struct ecdaa_signature_TPM_ZZZ_async *async, int32_t timeout);
+
+static
+int async_finish_sign(struct ecdaa_signature_TPM_ZZZ_async *async, int32_t timeout);
 
 int ecdaa_signature_TPM_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
                                  const uint8_t* message,
@@ -40,12 +67,53 @@ int ecdaa_signature_TPM_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
                                  ecdaa_rand_func get_random,
                                  struct ecdaa_tpm_context *tpm_ctx)
 {
-    // 1) Randomize credential
-    randomize_credential_ZZZ(cred, get_random, signature_out);
+    // Only S is needed for TPM2_Commit,
+    //  so the rest of the credential is randomized while the TPM is busy with it.
+
+    // 1) Randomize S, the basepoint for the commit
+    BIG_XXX l;
+    randomize_basepoint_ZZZ(&l, cred, get_random, signature_out);
+
+    // 2) Send TPM2_Commit
+    struct ecdaa_tpm_commit_ZZZ commit;
+    int commit_ret = tpm_commit_ZZZ_async_start(tpm_ctx,
+                                                &signature_out->S,
+                                                basename,
+                                                basename_len,
+                                                &commit.K,
+                                                &commit.L);
+
+    // 3) Randomize R, T, and W
+    randomize_rest_of_credential_ZZZ(l, cred, get_random, signature_out);
+
+    if (0 != commit_ret)
+        return -1;
+
+    // 4) Wait for the TPM2_Commit response
+    if (0 != tpm_commit_ZZZ_async_finish(tpm_ctx, TSS2_TCTI_TIMEOUT_BLOCK, &commit.K, &commit.L, &commit.R))
+        return -1;
+    commit.counter = tpm_ctx->commit_counter;
 
-    // 2) Create a Schnorr-like signature on W concatenated with the message,
+    // 5) Create a Schnorr-like signature on W concatenated with the message,
     //  where the basepoint is S.
-    int sign_ret = schnorr_sign_TPM_ZZZ(&signature_out->c,
+    int sign_ret = schnorr_sign_with_commit_TPM_ZZZ(&signature_out->c,
+                                                    &signature_out->s,
+                                                    &signature_out->n,
+                                                    &signature_out->K,
+                                                    &commit,
+                                                    message,
+                                                    message_len,
+                                                    &signature_out->S,
+                                                    &signature_out->W,
+                                                    basename,
+                                                    basename_len,
+                                                    tpm_ctx);
+    explicit_bzero(&commit, sizeof(commit));
+
+    // 6) If the TPM's nonce was too short, retry with fresh commits
+    //  (cf. `schnorr_sign_TPM_ZZZ`).
+    if (-4 == sign_ret) {
+        sign_ret = schnorr_sign_TPM_ZZZ(&signature_out->c,
                                         &signature_out->s,
                                         &signature_out->n,
                                         &signature_out->K,
@@ -56,36 +124,344 @@ int ecdaa_signature_TPM_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
                                         basename,
                                         basename_len,
                                         tpm_ctx);
+    }
 
     return sign_ret;
 }
 
-void randomize_credential_ZZZ(struct ecdaa_credential_ZZZ *cred,
-                              ecdaa_rand_func get_random,
-                              struct ecdaa_signature_ZZZ *signature_out)
+int ecdaa_signature_TPM_ZZZ_sign_batch(struct ecdaa_signature_ZZZ *signatures_out,
+                                       const uint8_t* const *messages,
+                                       const uint32_t *message_lens,
+                                       size_t num_messages,
+                                       const uint8_t* basename,
+                                       uint32_t basename_len,
+                                       struct ecdaa_credential_ZZZ *cred,
+                                       ecdaa_rand_func get_random,
+                                       struct ecdaa_tpm_context *tpm_ctx)
 {
-    // 1) Choose random l <- Z_p
+    // Only one command can be outstanding on tpm_ctx, so the pipeline is
+    //  Commit(0), Sign(0), Commit(1), Sign(1), ...
+    //  with the host work for neighbouring signatures done while each command runs.
+
+    if (0 == num_messages)
+        return 0;
+
+    int ret = 0;
     BIG_XXX l;
-    ecp_ZZZ_random_mod_order(&l, get_random);
+    struct ecdaa_tpm_commit_ZZZ commit;
+    struct ecdaa_tpm_commit_ZZZ next_commit;
+    TPM2B_DIGEST digest;
+    TPMT_SIGNATURE tpm_signature;
 
-    // 2) Multiply the four points in the credential by l,
-    //  and save to the four points in the signature
+    // Prime the pipeline with the first signature's commit
+    randomize_basepoint_ZZZ(&l, cred, get_random, &signatures_out[0]);
+    ret = tpm_commit_ZZZ_async_start(tpm_ctx,
+                                     &signatures_out[0].S,
+                                     basename,
+                                     basename_len,
+                                     &commit.K,
+                                     &commit.L);
+    randomize_rest_of_credential_ZZZ(l, cred, get_random, &signatures_out[0]);
+    if (0 != ret)
+        return -1;
+    if (0 != tpm_commit_ZZZ_async_finish(tpm_ctx, TSS2_TCTI_TIMEOUT_BLOCK, &commit.K, &commit.L, &commit.R))
+        return -1;
+    commit.counter = tpm_ctx->commit_counter;
 
-    // 2i) Multiply cred->A by l and save to sig->R (R = l*A)
-    ECP_ZZZ_copy(&signature_out->R, &cred->A);
-    ECP_ZZZ_mul(&signature_out->R, l);
+    for (size_t i = 0; i < num_messages; i++) {
+        struct ecdaa_signature_ZZZ *sig = &signatures_out[i];
+        struct ecdaa_signature_ZZZ *next_sig = (i + 1 < num_messages) ? &signatures_out[i + 1] : NULL;
 
-    // 2ii) Multiply cred->B by l and save to sig->S (S = l*B)
+        // 1) Send TPM2_Sign for this signature
+        ret = schnorr_digest_TPM_ZZZ(&digest,
+                                     &sig->K,
+                                     &commit,
+                                     messages[i],
+                                     message_lens[i],
+                                     &sig->S,
+                                     &sig->W,
+                                     basename,
+                                     basename_len);
+        if (0 != ret)
+            break;
+        tpm_ctx->commit_counter = commit.counter;
+        ret = tpm_sign_async_start(tpm_ctx, &digest);
+        if (0 != ret)
+            break;
+
+        // 2) Randomize the next signature's basepoint while the TPM signs
+        if (NULL != next_sig)
+            randomize_basepoint_ZZZ(&l, cred, get_random, next_sig);
+
+        // 3) Receive the TPM2_Sign response
+        ret = tpm_sign_async_finish(tpm_ctx, TSS2_TCTI_TIMEOUT_BLOCK, &tpm_signature);
+        if (0 != ret)
+            break;
+
+        // 4) Send TPM2_Commit for the next signature
+        if (NULL != next_sig) {
+            ret = tpm_commit_ZZZ_async_start(tpm_ctx,
+                                             &next_sig->S,
+                                             basename,
+                                             basename_len,
+                                             &next_commit.K,
+                                             &next_commit.L);
+            if (0 != ret)
+                break;
+        }
+
+        // 5) While the TPM commits, finish this signature and randomize the rest of the next one
+        int complete_ret = schnorr_complete_TPM_ZZZ(&sig->c,
+                                                    &sig->s,
+                                                    &sig->n,
+                                                    &tpm_signature,
+                                                    &digest);
+        if (NULL != next_sig)
+            randomize_rest_of_credential_ZZZ(l, cred, get_random, next_sig);
+
+        // 6) Receive the TPM2_Commit response
+        if (NULL != next_sig) {
+            ret = tpm_commit_ZZZ_async_finish(tpm_ctx,
+                                              TSS2_TCTI_TIMEOUT_BLOCK,
+                                              &next_commit.K,
+                                              &next_commit.L,
+                                              &next_commit.R);
+            if (0 != ret)
+                break;
+            next_commit.counter = tpm_ctx->commit_counter;
+        }
+
+        // 7) If the TPM's nonce was too short, redo this signature with fresh commits
+        //  (cf. `schnorr_sign_TPM_ZZZ`).
+        //  The next signature's commit stays valid, since the TPM tracks each commit separately.
+        if (-4 == complete_ret) {
+            complete_ret = schnorr_sign_TPM_ZZZ(&sig->c,
+                                                &sig->s,
+                                                &sig->n,
+                                                &sig->K,
+                                                messages[i],
+                                                message_lens[i],
+                                                &sig->S,
+                                                &sig->W,
+                                                basename,
+                                                basename_len,
+                                                tpm_ctx);
+        }
+        ret = complete_ret;
+        if (0 != ret)
+            break;
+
+        if (NULL != next_sig)
+            commit = next_commit;
+    }
+
+    // Clear sensitive intermediate memory.
+    BIG_XXX_zero(l);
+    explicit_bzero(&commit, sizeof(commit));
+    explicit_bzero(&next_commit, sizeof(next_commit));
+
+    return (0 == ret) ? 0 : -1;
+}
+
+int ecdaa_signature_TPM_ZZZ_sign_pooled(struct ecdaa_signature_ZZZ *signature_out,
+                                        const uint8_t* message,
+                                        uint32_t message_len,
+                                        const uint8_t* basename,
+                                        uint32_t basename_len,
+                                        struct ecdaa_credential_ZZZ *cred,
+                                        ecdaa_rand_func get_random,
+                                        struct ecdaa_tpm_context_pool *pool)
+{
+    struct ecdaa_tpm_context *tpm_ctx = ecdaa_tpm_context_pool_acquire(pool);
+
+    int ret = ecdaa_signature_TPM_ZZZ_sign(signature_out,
+                                           message,
+                                           message_len,
+                                           basename,
+                                           basename_len,
+                                           cred,
+                                           get_random,
+                                           tpm_ctx);
+
+    (void)ecdaa_tpm_context_pool_release(pool, tpm_ctx);
+
+    return (0 == ret) ? 0 : -1;
+}
+
+int ecdaa_signature_TPM_ZZZ_sign_async_start(struct ecdaa_signature_TPM_ZZZ_async *async,
+                                             struct ecdaa_signature_ZZZ *signature_out,
+                                             const uint8_t* message,
+                                             uint32_t message_len,
+                                             const uint8_t* basename,
+                                             uint32_t basename_len,
+                                             struct ecdaa_credential_ZZZ *cred,
+                                             ecdaa_rand_func get_random,
+                                             struct ecdaa_tpm_context *tpm_ctx)
+{
+    async->state = ASYNC_FAILED;
+    async->attempts = 1;
+    async->signature_out = signature_out;
+    async->message = message;
+    async->message_len = message_len;
+    async->basename = basename;
+    async->basename_len = basename_len;
+    async->tpm_ctx = tpm_ctx;
+
+    // 1) Randomize S, the basepoint for the commit
+    BIG_XXX l;
+    randomize_basepoint_ZZZ(&l, cred, get_random, signature_out);
+
+    // 2) Send TPM2_Commit
+    int commit_ret = async_start_commit(async);
+
+    // 3) Randomize R, T, and W while the TPM works
+    randomize_rest_of_credential_ZZZ(l, cred, get_random, signature_out);
+
+    if (0 != commit_ret)
+        return -1;
+
+    return 0;
+}
+
+int ecdaa_signature_TPM_ZZZ_sign_async_step(struct ecdaa_signature_TPM_ZZZ_async *async,
+                                            int32_t timeout)
+{
+    int ret;
+
+    switch (async->state) {
+        case ASYNC_COMMITTING:
+            ret = async_finish_commit(async, timeout);
+            break;
+        case ASYNC_SIGNING:
+            ret = async_finish_sign(async, timeout);
+            break;
+        case ASYNC_DONE:
+            return 0;
+        default:
+            return -1;
+    }
+
+    if (ret < 0) {
+        async->state = ASYNC_FAILED;
+        explicit_bzero(&async->commit, sizeof(async->commit));
+        return -1;
+    }
+
+    return ret;
+}
+
+int async_start_commit(struct ecdaa_signature_TPM_ZZZ_async *async)
+{
+    int ret = tpm_commit_ZZZ_async_start(async->tpm_ctx,
+                                         &async->signature_out->S,
+                                         async->basename,
+                                         async->basename_len,
+                                         &async->commit.K,
+                                         &async->commit.L);
+    if (0 != ret)
+        return -1;
+
+    async->state = ASYNC_COMMITTING;
+
+    return 0;
+}
+
+int async_finish_commit(struct ecdaa_signature_TPM_ZZZ_async *async, int32_t timeout)
+{
+    // 1) Receive TPM2_Commit response
+    int ret = tpm_commit_ZZZ_async_finish(async->tpm_ctx,
+                                          timeout,
+                                          &async->commit.K,
+                                          &async->commit.L,
+                                          &async->commit.R);
+    if (1 == ret)
+        return 1;
+    if (0 != ret)
+        return -1;
+    async->commit.counter = async->tpm_ctx->commit_counter;
+
+    // 2) Compute the digest (on W concatenated with the message, where the basepoint is S)
+    ret = schnorr_digest_TPM_ZZZ(&async->digest,
+                                 &async->signature_out->K,
+                                 &async->commit,
+                                 async->message,
+                                 async->message_len,
+                                 &async->signature_out->S,
+                                 &async->signature_out->W,
+                                 async->basename,
+                                 async->basename_len);
+    if (0 != ret)
+        return -1;
+
+    // 3) Send TPM2_Sign
+    if (0 != tpm_sign_async_start(async->tpm_ctx, &async->digest))
+        return -1;
+
+    async->state = ASYNC_SIGNING;
+
+    return 1;
+}
+
+int async_finish_sign(struct ecdaa_signature_TPM_ZZZ_async *async, int32_t timeout)
+{
+    // 1) Receive TPM2_Sign response
+    TPMT_SIGNATURE signature;
+    int ret = tpm_sign_async_finish(async->tpm_ctx, timeout, &signature);
+    if (1 == ret)
+        return 1;
+    if (0 != ret)
+        return -1;
+
+    // 2) Finish the signature
+    ret = schnorr_complete_TPM_ZZZ(&async->signature_out->c,
+                                   &async->signature_out->s,
+                                   &async->signature_out->n,
+                                   &signature,
+                                   &async->digest);
+    if (-4 == ret) {
+        // The TPM's nonce was too short, so start over with a new commit
+        //  (cf. `schnorr_sign_TPM_ZZZ`).
+        ++async->attempts;
+        if (async->attempts >= MAX_TPM_SIGN_ATTEMPTS)
+            return -1;
+        if (0 != async_start_commit(async))
+            return -1;
+        return 1;
+    }
+    if (0 != ret)
+        return -1;
+
+    explicit_bzero(&async->commit, sizeof(async->commit));
+    async->state = ASYNC_DONE;
+
+    return 0;
+}
+
+void randomize_basepoint_ZZZ(BIG_XXX *l_out,
+                             struct ecdaa_credential_ZZZ *cred,
+                             ecdaa_rand_func get_random,
+                             struct ecdaa_signature_ZZZ *signature_out)
+{
+    // 1) Choose random l <- Z_p
+    ecp_ZZZ_random_mod_order(l_out, get_random);
+
+    // 2) Multiply cred->B by l and save to sig->S (S = l*B)
     ECP_ZZZ_copy(&signature_out->S, &cred->B);
-    ECP_ZZZ_mul(&signature_out->S, l);
+    ecp_ZZZ_mul_secret(&signature_out->S, *l_out, get_random);
+}
 
-    // 2iii) Multiply cred->C by l and save to sig->T (T = l*C)
+void randomize_rest_of_credential_ZZZ(BIG_XXX l,
+                                      struct ecdaa_credential_ZZZ *cred,
+                                      ecdaa_rand_func get_random,
+                                      struct ecdaa_signature_ZZZ *signature_out)
+{
+    // Multiply cred->A, cred->C, cred->D by l and save to sig->R, sig->T, sig->W
+    //  (R = l*A, T = l*C, W = l*D)
+    ECP_ZZZ_copy(&signature_out->R, &cred->A);
     ECP_ZZZ_copy(&signature_out->T, &cred->C);
-    ECP_ZZZ_mul(&signature_out->T, l);
-
-    // 2iv) Multiply cred->D by l and save to sig->W (W = l*D)
     ECP_ZZZ_copy(&signature_out->W, &cred->D);
-    ECP_ZZZ_mul(&signature_out->W, l);
+    ECP_ZZZ *points[3] = {&signature_out->R, &signature_out->T, &signature_out->W};
+    ecp_ZZZ_mul_secret_multi(points, 3, l, get_random);
 
     // Clear sensitive intermediate memory.
     BIG_XXX_zero(l);
@@ -26,6 +26,32 @@
 
 #include <string.h>
 
+struct commit_inputs {
+    TPM2B_ECC_POINT P1_tpm;
+    TPM2B_SENSITIVE_DATA s2_tpm;
+    TPM2B_ECC_POINT y2_tpm;
+};
+
+struct commit_outputs {
+    TPM2B_ECC_POINT K_tpm;
+    TPM2B_ECC_POINT L_tpm;
+    TPM2B_ECC_POINT E_tpm;
+};
+
+static
+int prepare_commit_inputs(struct commit_inputs *inputs_out,
+                          ECP_ZZZ *P1,
+                          const uint8_t *s2,
+                          uint32_t s2_length,
+                          ECP_ZZZ *K,
+                          ECP_ZZZ *L);
+
+static
+int convert_commit_outputs(struct commit_outputs *outputs,
+                           ECP_ZZZ *K,
+                           ECP_ZZZ *L,
+                           ECP_ZZZ *E);
+
 static
 void ecp_to_tpm_format(TPM2B_ECC_POINT *tpm_out, ECP_ZZZ *point_in);
 
@@ -40,57 +66,25 @@ int tpm_commit_ZZZ(struct ecdaa_tpm_context *tpm_ctx,
                    ECP_ZZZ *L,
                    ECP_ZZZ *E)
 {
-    TPM2B_ECC_POINT P1_tpm = {.size=0};
-    TPM2B_SENSITIVE_DATA s2_tpm = {.size=0};
-    ECP_ZZZ y2;
-    TPM2B_ECC_POINT y2_tpm = {.size=0};
-    TPM2B_ECC_POINT K_tpm = {.size=0};
-    TPM2B_ECC_POINT L_tpm = {.size=0};
-    TPM2B_ECC_POINT E_tpm = {.size=0};
-
-    if (NULL != P1) {
-        ecp_to_tpm_format(&P1_tpm, P1);
-    }
+    struct commit_inputs inputs;
+    struct commit_outputs outputs = {.K_tpm={.size=0}, .L_tpm={.size=0}, .E_tpm={.size=0}};
 
     int ret = 0;
 
     do {
-        if (NULL != s2 || 0 != s2_length) {
-            // If any of these is non-zero, ALL must be non-zero.
-            if (NULL == s2 || 0 == s2_length || NULL == K || NULL == L) {
-                ret = -3;
-                break;
-            }
-
-            int32_t hash_ret;
-
-            if (s2_length > (sizeof(s2_tpm.buffer) - sizeof(hash_ret))) {
-                ret = -3;
-                break;
-            }
-
-            hash_ret = ecp_ZZZ_fromhash(&y2, s2, s2_length);
-            if (hash_ret < 0) {
-                ret = -3;
-                break;
-            }
-            ecp_to_tpm_format(&y2_tpm, &y2);
-
-            // Concatenate (hash_ret | s2)
-            s2_tpm.size = (uint16_t)s2_length + sizeof(hash_ret);
-            memcpy(s2_tpm.buffer, &hash_ret, sizeof(hash_ret));
-            memcpy(s2_tpm.buffer + sizeof(hash_ret), s2, s2_length);
-        }
+        ret = prepare_commit_inputs(&inputs, P1, s2, s2_length, K, L);
+        if (0 != ret)
+            break;
 
         tpm_ctx->last_return_code = Tss2_Sys_Commit(tpm_ctx->sapi_context,
                                                     tpm_ctx->key_handle,
                                                     &tpm_ctx->key_authentication_cmd,
-                                                    &P1_tpm,
-                                                    &s2_tpm,
-                                                    &y2_tpm.point.y,
-                                                    &K_tpm,
-                                                    &L_tpm,
-                                                    &E_tpm,
+                                                    &inputs.P1_tpm,
+                                                    &inputs.s2_tpm,
+                                                    &inputs.y2_tpm.point.y,
+                                                    &outputs.K_tpm,
+                                                    &outputs.L_tpm,
+                                                    &outputs.E_tpm,
                                                     &tpm_ctx->commit_counter,
                                                     &tpm_ctx->last_auth_response_cmd);
 
@@ -99,49 +93,176 @@ int tpm_commit_ZZZ(struct ecdaa_tpm_context *tpm_ctx,
             break;
         }
 
-        if (K_tpm.size > 4) {
-            if (NULL == K) {
-                ret = -2;
-                break;
-            }
-            if (0 != tpm_to_amcl_format(K, &K_tpm)) {
-                ret = -2;
-                break;
-            }
+        ret = convert_commit_outputs(&outputs, K, L, E);
+    } while(0);
+
+    explicit_bzero(&inputs, sizeof(inputs));
+    explicit_bzero(&outputs, sizeof(outputs));
+
+    return ret;
+}
+
+int tpm_commit_ZZZ_async_start(struct ecdaa_tpm_context *tpm_ctx,
+                               ECP_ZZZ *P1,
+                               const uint8_t *s2,
+                               uint32_t s2_length,
+                               ECP_ZZZ *K,
+                               ECP_ZZZ *L)
+{
+    struct commit_inputs inputs;
+
+    int ret = 0;
+
+    do {
+        ret = prepare_commit_inputs(&inputs, P1, s2, s2_length, K, L);
+        if (0 != ret)
+            break;
+
+        // The inputs are marshalled into the SAPI context's command buffer here,
+        //  so they don't need to outlive this call.
+        tpm_ctx->last_return_code = Tss2_Sys_Commit_Prepare(tpm_ctx->sapi_context,
+                                                            tpm_ctx->key_handle,
+                                                            &inputs.P1_tpm,
+                                                            &inputs.s2_tpm,
+                                                            &inputs.y2_tpm.point.y);
+        if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code) {
+            ret = -1;
+            break;
         }
-        if (L_tpm.size > 4) {
-            if (NULL == L) {
-                ret = -2;
-                break;
-            }
-            if (0 != tpm_to_amcl_format(L, &L_tpm)) {
-                ret = -2;
-                break;
-            }
+
+        tpm_ctx->last_return_code = Tss2_Sys_SetCmdAuths(tpm_ctx->sapi_context,
+                                                         &tpm_ctx->key_authentication_cmd);
+        if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code) {
+            ret = -1;
+            break;
         }
-        if (E_tpm.size > 4) {
-            if (NULL == E) {
-                ret = -2;
-                break;
-            }
-            if (0 != tpm_to_amcl_format(E, &E_tpm)) {
-                ret = -2;
-                break;
-            }
+
+        tpm_ctx->last_return_code = Tss2_Sys_ExecuteAsync(tpm_ctx->sapi_context);
+        if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code) {
+            ret = -1;
+            break;
         }
     } while(0);
 
-    explicit_bzero(&y2, sizeof(y2));
-    explicit_bzero(&P1_tpm, sizeof(P1_tpm));
-    explicit_bzero(&s2_tpm, sizeof(s2_tpm));
-    explicit_bzero(&y2_tpm, sizeof(y2_tpm));
-    explicit_bzero(&K_tpm, sizeof(K_tpm));
-    explicit_bzero(&L_tpm, sizeof(L_tpm));
-    explicit_bzero(&E_tpm, sizeof(E_tpm));
+    explicit_bzero(&inputs, sizeof(inputs));
 
     return ret;
 }
 
+int tpm_commit_ZZZ_async_finish(struct ecdaa_tpm_context *tpm_ctx,
+                                int32_t timeout,
+                                ECP_ZZZ *K,
+                                ECP_ZZZ *L,
+                                ECP_ZZZ *E)
+{
+    struct commit_outputs outputs = {.K_tpm={.size=0}, .L_tpm={.size=0}, .E_tpm={.size=0}};
+
+    int ret = 0;
+
+    do {
+        tpm_ctx->last_return_code = Tss2_Sys_ExecuteFinish(tpm_ctx->sapi_context, timeout);
+        if (TSS2_TCTI_RC_TRY_AGAIN == tpm_ctx->last_return_code) {
+            ret = 1;
+            break;
+        }
+        if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code) {
+            ret = -1;
+            break;
+        }
+
+        tpm_ctx->last_return_code = Tss2_Sys_GetRspAuths(tpm_ctx->sapi_context,
+                                                         &tpm_ctx->last_auth_response_cmd);
+        if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code) {
+            ret = -1;
+            break;
+        }
+
+        tpm_ctx->last_return_code = Tss2_Sys_Commit_Complete(tpm_ctx->sapi_context,
+                                                             &outputs.K_tpm,
+                                                             &outputs.L_tpm,
+                                                             &outputs.E_tpm,
+                                                             &tpm_ctx->commit_counter);
+        if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code) {
+            ret = -1;
+            break;
+        }
+
+        ret = convert_commit_outputs(&outputs, K, L, E);
+    } while(0);
+
+    explicit_bzero(&outputs, sizeof(outputs));
+
+    return ret;
+}
+
+int prepare_commit_inputs(struct commit_inputs *inputs_out,
+                          ECP_ZZZ *P1,
+                          const uint8_t *s2,
+                          uint32_t s2_length,
+                          ECP_ZZZ *K,
+                          ECP_ZZZ *L)
+{
+    inputs_out->P1_tpm.size = 0;
+    inputs_out->s2_tpm.size = 0;
+    inputs_out->y2_tpm.size = 0;
+
+    if (NULL != P1) {
+        ecp_to_tpm_format(&inputs_out->P1_tpm, P1);
+    }
+
+    if (NULL != s2 || 0 != s2_length) {
+        // If any of these is non-zero, ALL must be non-zero.
+        if (NULL == s2 || 0 == s2_length || NULL == K || NULL == L)
+            return -3;
+
+        int32_t hash_ret;
+
+        if (s2_length > (sizeof(inputs_out->s2_tpm.buffer) - sizeof(hash_ret)))
+            return -3;
+
+        ECP_ZZZ y2;
+        hash_ret = ecp_ZZZ_fromhash(&y2, s2, s2_length);
+        if (hash_ret < 0)
+            return -3;
+        ecp_to_tpm_format(&inputs_out->y2_tpm, &y2);
+        explicit_bzero(&y2, sizeof(y2));
+
+        // Concatenate (hash_ret | s2)
+        inputs_out->s2_tpm.size = (uint16_t)s2_length + sizeof(hash_ret);
+        memcpy(inputs_out->s2_tpm.buffer, &hash_ret, sizeof(hash_ret));
+        memcpy(inputs_out->s2_tpm.buffer + sizeof(hash_ret), s2, s2_length);
+    }
+
+    return 0;
+}
+
+int convert_commit_outputs(struct commit_outputs *outputs,
+                           ECP_ZZZ *K,
+                           ECP_ZZZ *L,
+                           ECP_ZZZ *E)
+{
+    if (outputs->K_tpm.size > 4) {
+        if (NULL == K)
+            return -2;
+        if (0 != tpm_to_amcl_format(K, &outputs->K_tpm))
+            return -2;
+    }
+    if (outputs->L_tpm.size > 4) {
+        if (NULL == L)
+            return -2;
+        if (0 != tpm_to_amcl_format(L, &outputs->L_tpm))
+            return -2;
+    }
+    if (outputs->E_tpm.size > 4) {
+        if (NULL == E)
+            return -2;
+        if (0 != tpm_to_amcl_format(E, &outputs->E_tpm))
+            return -2;
+    }
+
+    return 0;
+}
+
 void ecp_to_tpm_format(TPM2B_ECC_POINT *tpm_out, ECP_ZZZ *point_in)
 {
     tpm_out->size = 4 + 2*ECP_ZZZ_LENGTH;  // 4 bytes for 2 UINT16 sizes
@@ -50,6 +50,42 @@ int tpm_commit_ZZZ(struct ecdaa_tpm_context *tpm_ctx,
                    ECP_ZZZ *L,
                    ECP_ZZZ *E);
 
+/*
+ * Send a TPM2_Commit command, without waiting for the response
+ *  (cf. `tpm_commit_ZZZ`, and `tpm_commit_ZZZ_async_finish`).
+ *
+ * `K` and `L` are only checked for NULL here (they're written by `tpm_commit_ZZZ_async_finish`).
+ *
+ * No other command may be sent using tpm_ctx until `tpm_commit_ZZZ_async_finish` returns something other than 1.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the command can't be sent (check tpm-ctx->last_return_code)
+ * -3 in case of an error generating the curve point from s2 (as for `tpm_commit_ZZZ`)
+ */
+int tpm_commit_ZZZ_async_start(struct ecdaa_tpm_context *tpm_ctx,
+                               ECP_ZZZ *P1,
+                               const uint8_t *s2,
+                               uint32_t s2_length,
+                               ECP_ZZZ *K,
+                               ECP_ZZZ *L);
+
+/*
+ * Wait up to `timeout` milliseconds (`TSS2_TCTI_TIMEOUT_BLOCK` to wait indefinitely)
+ *  for the response to a TPM2_Commit sent by `tpm_commit_ZZZ_async_start`.
+ *
+ * Returns:
+ * 0 on success
+ * 1 if the response hasn't arrived yet
+ * -1 if TPM2_Commit fails (check tpm-ctx->last_return_code)
+ * -2 if any of the elliptic curve points returned are mal-formed
+ */
+int tpm_commit_ZZZ_async_finish(struct ecdaa_tpm_context *tpm_ctx,
+                                int32_t timeout,
+                                ECP_ZZZ *K,
+                                ECP_ZZZ *L,
+                                ECP_ZZZ *E);
+
 #ifdef __cplusplus
 }
 #endif
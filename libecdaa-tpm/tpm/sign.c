@@ -18,20 +18,18 @@
 
 #include "sign.h"
 
+static
+void set_sign_parameters(struct ecdaa_tpm_context *tpm_ctx,
+                         TPMT_SIG_SCHEME *inScheme,
+                         TPMT_TK_HASHCHECK *validation);
+
 int tpm_sign(struct ecdaa_tpm_context *tpm_ctx,
              TPM2B_DIGEST *digest,
              TPMT_SIGNATURE *signature)
 {
     TPMT_SIG_SCHEME inScheme;
-    inScheme.scheme = TPM2_ALG_ECDAA;
-	inScheme.details.ecdaa.hashAlg = TPM2_ALG_SHA256;
-	inScheme.details.ecdaa.count = tpm_ctx->commit_counter;
-
-    // Key _shouldn't_ be restricted, so no need for this
     TPMT_TK_HASHCHECK validation;
-	validation.tag = TPM2_ST_HASHCHECK;
-	validation.hierarchy = TPM2_RH_NULL;
-	validation.digest.size = 0;
+    set_sign_parameters(tpm_ctx, &inScheme, &validation);
 
     tpm_ctx->last_return_code = Tss2_Sys_Sign(tpm_ctx->sapi_context,
                                               tpm_ctx->key_handle,
@@ -49,3 +47,65 @@ int tpm_sign(struct ecdaa_tpm_context *tpm_ctx,
     }
 }
 
+int tpm_sign_async_start(struct ecdaa_tpm_context *tpm_ctx,
+                         TPM2B_DIGEST *digest)
+{
+    TPMT_SIG_SCHEME inScheme;
+    TPMT_TK_HASHCHECK validation;
+    set_sign_parameters(tpm_ctx, &inScheme, &validation);
+
+    tpm_ctx->last_return_code = Tss2_Sys_Sign_Prepare(tpm_ctx->sapi_context,
+                                                      tpm_ctx->key_handle,
+                                                      digest,
+                                                      &inScheme,
+                                                      &validation);
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    tpm_ctx->last_return_code = Tss2_Sys_SetCmdAuths(tpm_ctx->sapi_context,
+                                                     &tpm_ctx->key_authentication_cmd);
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    tpm_ctx->last_return_code = Tss2_Sys_ExecuteAsync(tpm_ctx->sapi_context);
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    return 0;
+}
+
+int tpm_sign_async_finish(struct ecdaa_tpm_context *tpm_ctx,
+                          int32_t timeout,
+                          TPMT_SIGNATURE *signature)
+{
+    tpm_ctx->last_return_code = Tss2_Sys_ExecuteFinish(tpm_ctx->sapi_context, timeout);
+    if (TSS2_TCTI_RC_TRY_AGAIN == tpm_ctx->last_return_code)
+        return 1;
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    tpm_ctx->last_return_code = Tss2_Sys_GetRspAuths(tpm_ctx->sapi_context,
+                                                     &tpm_ctx->last_auth_response_cmd);
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    tpm_ctx->last_return_code = Tss2_Sys_Sign_Complete(tpm_ctx->sapi_context, signature);
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    return 0;
+}
+
+void set_sign_parameters(struct ecdaa_tpm_context *tpm_ctx,
+                         TPMT_SIG_SCHEME *inScheme,
+                         TPMT_TK_HASHCHECK *validation)
+{
+    inScheme->scheme = TPM2_ALG_ECDAA;
+    inScheme->details.ecdaa.hashAlg = TPM2_ALG_SHA256;
+    inScheme->details.ecdaa.count = tpm_ctx->commit_counter;
+
+    // Key _shouldn't_ be restricted, so no need for this
+    validation->tag = TPM2_ST_HASHCHECK;
+    validation->hierarchy = TPM2_RH_NULL;
+    validation->digest.size = 0;
+}
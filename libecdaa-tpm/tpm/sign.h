@@ -39,6 +39,32 @@ int tpm_sign(struct ecdaa_tpm_context *tpm_ctx,
              TPM2B_DIGEST *digest,
              TPMT_SIGNATURE *signature);
 
+/*
+ * Send a TPM2_Sign command, without waiting for the response
+ *  (cf. `tpm_sign`, and `tpm_sign_async_finish`).
+ *
+ * No other command may be sent using tpm_ctx until `tpm_sign_async_finish` returns something other than 1.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the command can't be sent (check tpm-ctx->last_return_code)
+ */
+int tpm_sign_async_start(struct ecdaa_tpm_context *tpm_ctx,
+                         TPM2B_DIGEST *digest);
+
+/*
+ * Wait up to `timeout` milliseconds (`TSS2_TCTI_TIMEOUT_BLOCK` to wait indefinitely)
+ *  for the response to a TPM2_Sign sent by `tpm_sign_async_start`.
+ *
+ * Returns:
+ * 0 on success
+ * 1 if the response hasn't arrived yet
+ * -1 if TPM2_Sign fails (check tpm-ctx->last_return_code)
+ */
+int tpm_sign_async_finish(struct ecdaa_tpm_context *tpm_ctx,
+                          int32_t timeout,
+                          TPMT_SIGNATURE *signature);
+
 #ifdef __cplusplus
 }
 #endif
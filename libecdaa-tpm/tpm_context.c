@@ -55,6 +55,22 @@ void ecdaa_tpm_context_free(struct ecdaa_tpm_context *tpm_ctx)
     }
 }
 
+int ecdaa_tpm_context_get_poll_handles(struct ecdaa_tpm_context *tpm_ctx,
+                                       TSS2_TCTI_POLL_HANDLE *handles,
+                                       size_t *num_handles)
+{
+    TSS2_TCTI_CONTEXT *tcti_context = NULL;
+    tpm_ctx->last_return_code = Tss2_Sys_GetTctiContext(tpm_ctx->sapi_context, &tcti_context);
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    tpm_ctx->last_return_code = Tss2_Tcti_GetPollHandles(tcti_context, handles, num_handles);
+    if (TSS2_RC_SUCCESS != tpm_ctx->last_return_code)
+        return -1;
+
+    return 0;
+}
+
 TSS2_SYS_CONTEXT*
 sapi_ctx_init(uint8_t *memory_pool,
              size_t memory_pool_size,
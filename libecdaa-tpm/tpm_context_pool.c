@@ -0,0 +1,111 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa-tpm/tpm_context_pool.h>
+
+#include <ecdaa-tpm/tpm_context.h>
+
+int ecdaa_tpm_context_pool_init(struct ecdaa_tpm_context_pool *pool,
+                                struct ecdaa_tpm_context **contexts,
+                                size_t num_contexts)
+{
+    if (0 == num_contexts || num_contexts > ECDAA_TPM_CONTEXT_POOL_MAX_SIZE)
+        return -1;
+
+    for (size_t i = 0; i < num_contexts; i++) {
+        if (NULL == contexts[i])
+            return -1;
+
+        pool->contexts[i] = contexts[i];
+        pool->in_use[i] = 0;
+    }
+    pool->num_contexts = num_contexts;
+    pool->num_available = num_contexts;
+    pool->next_context = 0;
+
+    pool->next_ticket = 0;
+    pool->now_serving = 0;
+
+    if (0 != pthread_mutex_init(&pool->lock, NULL))
+        return -2;
+
+    if (0 != pthread_cond_init(&pool->available, NULL)) {
+        pthread_mutex_destroy(&pool->lock);
+        return -2;
+    }
+
+    return 0;
+}
+
+void ecdaa_tpm_context_pool_free(struct ecdaa_tpm_context_pool *pool)
+{
+    pthread_cond_destroy(&pool->available);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+struct ecdaa_tpm_context *ecdaa_tpm_context_pool_acquire(struct ecdaa_tpm_context_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+
+    // Ticket lock: waiters are served in arrival order,
+    //  so no thread can be starved by others repeatedly re-acquiring.
+    unsigned long ticket = pool->next_ticket++;
+    while (ticket != pool->now_serving || 0 == pool->num_available)
+        pthread_cond_wait(&pool->available, &pool->lock);
+
+    ++pool->now_serving;
+
+    // Rotate through the contexts, to spread the load across TPMs/connections.
+    size_t i = pool->next_context;
+    while (pool->in_use[i])
+        i = (i + 1) % pool->num_contexts;
+    pool->in_use[i] = 1;
+    --pool->num_available;
+    pool->next_context = (i + 1) % pool->num_contexts;
+
+    struct ecdaa_tpm_context *tpm_ctx = pool->contexts[i];
+
+    // The next ticket-holder may be able to proceed, too.
+    pthread_cond_broadcast(&pool->available);
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return tpm_ctx;
+}
+
+int ecdaa_tpm_context_pool_release(struct ecdaa_tpm_context_pool *pool,
+                                   struct ecdaa_tpm_context *tpm_ctx)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (size_t i = 0; i < pool->num_contexts; i++) {
+        if (pool->contexts[i] == tpm_ctx && pool->in_use[i]) {
+            pool->in_use[i] = 0;
+            ++pool->num_available;
+            pthread_cond_broadcast(&pool->available);
+            ret = 0;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return ret;
+}
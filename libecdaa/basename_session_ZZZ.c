@@ -0,0 +1,55 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa/basename_session_ZZZ.h>
+
+#include <ecdaa/member_keypair_ZZZ.h>
+
+#include "internal-utilities/instrumentation.h"
+#include "amcl-extensions/ecp_ZZZ.h"
+
+#include <assert.h>
+
+int ecdaa_basename_session_ZZZ_init(struct ecdaa_basename_session_ZZZ *session_out,
+                                    const uint8_t *basename,
+                                    uint32_t basename_len,
+                                    struct ecdaa_member_secret_key_ZZZ *sk,
+                                    ecdaa_rand_func get_random)
+{
+    assert(ECDAA_BASENAME_SESSION_ZZZ_TABLE_SIZE == ECP_ZZZ_FIXED_BASE_TABLE_SIZE);
+
+    if (NULL == basename || 0 == basename_len)
+        return -1;
+
+    // 1) P2 = the curve point hashed from basename
+    int32_t hash_ret = ecp_ZZZ_fromhash(&session_out->P2, basename, basename_len);
+    if (hash_ret < 0)
+        return -1;
+
+    // 2) K = [sk]P2
+    ECP_ZZZ_copy(&session_out->K, &session_out->P2);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&session_out->K, sk->sk, get_random));
+
+    // 3) Table for the per-signature [k]P2
+    ecp_ZZZ_fixed_base_table_init(session_out->P2_table, &session_out->P2);
+
+    session_out->basename = basename;
+    session_out->basename_len = basename_len;
+
+    return 0;
+}
@@ -22,6 +22,7 @@
 
 #include "schnorr/schnorr_ZZZ.h"
 #include "internal-utilities/explicit_bzero.h"
+#include "internal-utilities/instrumentation.h"
 #include "amcl-extensions/ecp_ZZZ.h"
 #include "amcl-extensions/ecp2_ZZZ.h"
 #include "amcl-extensions/pairing_ZZZ.h"
@@ -57,11 +58,11 @@ int ecdaa_credential_ZZZ_generate(struct ecdaa_credential_ZZZ *cred,
 
     // 2) Multiply generator by l and save to cred->A (A = l*P)
     ecp_ZZZ_set_to_generator(&cred->A);
-    ECP_ZZZ_mul(&cred->A, l);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&cred->A, l, get_random));
 
     // 3) Multiply A by my secret y and save to cred->B (B = y*A)
     ECP_ZZZ_copy(&cred->B, &cred->A);
-    ECP_ZZZ_mul(&cred->B, isk->y);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&cred->B, isk->y, get_random));
 
     // 4) Mod-multiply l and y
     BIG_XXX ly;
@@ -69,11 +70,11 @@ int ecdaa_credential_ZZZ_generate(struct ecdaa_credential_ZZZ *cred,
 
     // 5) Multiply member's public_key by ly and save to cred->D (D = ly*Q)
     ECP_ZZZ_copy(&cred->D, &member_pk->Q);
-    ECP_ZZZ_mul(&cred->D, ly);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&cred->D, ly, get_random));
 
     // 6) Multiply A by my secret x (store in cred->C temporarily)
     ECP_ZZZ_copy(&cred->C, &cred->A);
-    ECP_ZZZ_mul(&cred->C, isk->x);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&cred->C, isk->x, get_random));
 
     // 7) Mod-multiply ly (see step 4) by my secret x
     BIG_XXX xyl;
@@ -82,7 +83,7 @@ int ecdaa_credential_ZZZ_generate(struct ecdaa_credential_ZZZ *cred,
     // 8) Multiply member's public_key by xyl
     ECP_ZZZ Qxyl;
     ECP_ZZZ_copy(&Qxyl, &member_pk->Q);
-    ECP_ZZZ_mul(&Qxyl, xyl);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&Qxyl, xyl, get_random));
 
     // 9) Add Ax and xyl*Q and save to cred->C (C = x*A + xyl*Q)
     //      Nb. Add doesn't convert to affine, so do that explicitly
@@ -157,9 +158,53 @@ int ecdaa_credential_ZZZ_validate(struct ecdaa_credential_ZZZ *credential,
     return ret;
 }
 
+int ecdaa_credential_ZZZ_validate_with_issuer_key(struct ecdaa_credential_ZZZ *credential,
+                                                  struct ecdaa_credential_ZZZ_signature *credential_signature,
+                                                  struct ecdaa_member_public_key_ZZZ *member_pk,
+                                                  struct ecdaa_issuer_secret_key_ZZZ *isk,
+                                                  ecdaa_rand_func get_random)
+{
+    int ret = 0;
+
+    // 1) Check A,B,C,D for membership in group, and A for !=inf
+    // NOTE: We assume the credential was obtained from a call to `deserialize`,
+    //  which already checked the validity of the points A,B,C,D
+
+    // 2) Verify schnorr-like signature
+    int schnorr_ret = credential_schnorr_verify_ZZZ(credential_signature->c,
+                                                    credential_signature->s,
+                                                    &credential->B,
+                                                    &member_pk->Q,
+                                                    &credential->D);
+    if (0 != schnorr_ret)
+        ret = -1;
+
+    // 3) Check B == y*A (equivalent to e(A, Y) == e(B, P_2))
+    ECP_ZZZ yA;
+    ECP_ZZZ_copy(&yA, &credential->A);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&yA, isk->y, get_random));
+    if (!ECP_ZZZ_equals(&yA, &credential->B))
+        ret = -1;
+
+    // 4) Check C == x*(A+D) (equivalent to e(C, P_2) == e(A+D, X))
+    ECP_ZZZ xAD;
+    ECP_ZZZ_copy(&xAD, &credential->A);
+    ECP_ZZZ_add(&xAD, &credential->D);
+    ECP_ZZZ_affine(&xAD);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&xAD, isk->x, get_random));
+    if (!ECP_ZZZ_equals(&xAD, &credential->C))
+        ret = -1;
+
+    return ret;
+}
+
 void ecdaa_credential_ZZZ_serialize(uint8_t *buffer_out,
                                     struct ecdaa_credential_ZZZ *credential)
 {
+    // Convert all the points to affine (as serializing requires) with one inversion
+    ECP_ZZZ *points[4] = {&credential->A, &credential->B, &credential->C, &credential->D};
+    ecp_ZZZ_batch_affine(points, 4);
+
     ecp_ZZZ_serialize(buffer_out, &credential->A);
     ecp_ZZZ_serialize(buffer_out + ECP_ZZZ_LENGTH, &credential->B);
     ecp_ZZZ_serialize(buffer_out + 2*ECP_ZZZ_LENGTH, &credential->C);
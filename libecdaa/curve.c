@@ -0,0 +1,247 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa/curve.h>
+
+// NOTE: This file is expanded one line per curve (like the tool's main file),
+//  so every line mentioning a curve must stand on its own.
+#include "curve/curve_vtable_ZZZ.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct ecdaa_verifier_context {
+    const struct ecdaa_curve_vtable *vtable;
+    void *state;
+};
+
+struct ecdaa_member_context {
+    const struct ecdaa_curve_vtable *vtable;
+    void *state;
+};
+
+static const struct ecdaa_curve_vtable *const curve_vtables[] = {
+    &ecdaa_curve_vtable_ZZZ,
+};
+
+static
+const struct ecdaa_curve_vtable *lookup_curve(enum ecdaa_curve_id curve)
+{
+    for (size_t i = 0; i < sizeof(curve_vtables) / sizeof(curve_vtables[0]); i++) {
+        if (curve_vtables[i]->id == curve)
+            return curve_vtables[i];
+    }
+
+    return NULL;
+}
+
+int ecdaa_curve_is_supported(enum ecdaa_curve_id curve)
+{
+    return NULL != lookup_curve(curve);
+}
+
+int ecdaa_curve_from_name(enum ecdaa_curve_id *curve_out, const char *name)
+{
+    for (size_t i = 0; i < sizeof(curve_vtables) / sizeof(curve_vtables[0]); i++) {
+        if (0 == strcmp(curve_vtables[i]->name, name)) {
+            *curve_out = curve_vtables[i]->id;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+const char *ecdaa_curve_name(enum ecdaa_curve_id curve)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    if (NULL == vtable)
+        return NULL;
+
+    return vtable->name;
+}
+
+size_t ecdaa_curve_group_public_key_length(enum ecdaa_curve_id curve)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    return NULL != vtable ? vtable->group_public_key_length : 0;
+}
+
+size_t ecdaa_curve_member_secret_key_length(enum ecdaa_curve_id curve)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    return NULL != vtable ? vtable->member_secret_key_length : 0;
+}
+
+size_t ecdaa_curve_credential_length(enum ecdaa_curve_id curve)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    return NULL != vtable ? vtable->credential_length : 0;
+}
+
+size_t ecdaa_curve_signature_length(enum ecdaa_curve_id curve, int has_nym)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    if (NULL == vtable)
+        return 0;
+
+    return has_nym ? vtable->signature_with_nym_length : vtable->signature_length;
+}
+
+size_t ecdaa_curve_pseudonym_length(enum ecdaa_curve_id curve)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    return NULL != vtable ? vtable->pseudonym_length : 0;
+}
+
+int ecdaa_verifier_context_new(struct ecdaa_verifier_context **verifier_out,
+                               enum ecdaa_curve_id curve,
+                               uint8_t *gpk_buffer)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    if (NULL == vtable)
+        return -2;
+
+    struct ecdaa_verifier_context *verifier = malloc(sizeof(struct ecdaa_verifier_context));
+    if (NULL == verifier)
+        return -3;
+
+    verifier->vtable = vtable;
+    verifier->state = malloc(vtable->verifier_state_size);
+    if (NULL == verifier->state) {
+        free(verifier);
+        return -3;
+    }
+
+    if (0 != vtable->verifier_init(verifier->state, gpk_buffer)) {
+        free(verifier->state);
+        free(verifier);
+        return -1;
+    }
+
+    *verifier_out = verifier;
+
+    return 0;
+}
+
+void ecdaa_verifier_context_free(struct ecdaa_verifier_context *verifier)
+{
+    if (NULL == verifier)
+        return;
+
+    verifier->vtable->verifier_clear(verifier->state);
+    free(verifier->state);
+    free(verifier);
+}
+
+enum ecdaa_curve_id ecdaa_verifier_context_curve(struct ecdaa_verifier_context *verifier)
+{
+    return verifier->vtable->id;
+}
+
+int ecdaa_verifier_context_set_revocations(struct ecdaa_verifier_context *verifier,
+                                           uint8_t *sk_list,
+                                           size_t sk_length,
+                                           uint8_t *bsn_list,
+                                           size_t bsn_length)
+{
+    return verifier->vtable->verifier_set_revocations(verifier->state,
+                                                      sk_list,
+                                                      sk_length,
+                                                      bsn_list,
+                                                      bsn_length);
+}
+
+int ecdaa_verifier_context_verify(struct ecdaa_verifier_context *verifier,
+                                  uint8_t *signature_buffer,
+                                  uint8_t *message,
+                                  uint32_t message_len,
+                                  uint8_t *basename,
+                                  uint32_t basename_len)
+{
+    return verifier->vtable->verify(verifier->state,
+                                    signature_buffer,
+                                    message,
+                                    message_len,
+                                    basename,
+                                    basename_len);
+}
+
+int ecdaa_member_context_new(struct ecdaa_member_context **member_out,
+                             enum ecdaa_curve_id curve,
+                             uint8_t *sk_buffer,
+                             uint8_t *credential_buffer)
+{
+    const struct ecdaa_curve_vtable *vtable = lookup_curve(curve);
+    if (NULL == vtable)
+        return -2;
+
+    struct ecdaa_member_context *member = malloc(sizeof(struct ecdaa_member_context));
+    if (NULL == member)
+        return -3;
+
+    member->vtable = vtable;
+    member->state = malloc(vtable->member_state_size);
+    if (NULL == member->state) {
+        free(member);
+        return -3;
+    }
+
+    if (0 != vtable->member_init(member->state, sk_buffer, credential_buffer)) {
+        vtable->member_clear(member->state);
+        free(member->state);
+        free(member);
+        return -1;
+    }
+
+    *member_out = member;
+
+    return 0;
+}
+
+void ecdaa_member_context_free(struct ecdaa_member_context *member)
+{
+    if (NULL == member)
+        return;
+
+    member->vtable->member_clear(member->state);
+    free(member->state);
+    free(member);
+}
+
+enum ecdaa_curve_id ecdaa_member_context_curve(struct ecdaa_member_context *member)
+{
+    return member->vtable->id;
+}
+
+int ecdaa_member_context_sign(struct ecdaa_member_context *member,
+                              uint8_t *signature_out,
+                              uint8_t *message,
+                              uint32_t message_len,
+                              uint8_t *basename,
+                              uint32_t basename_len,
+                              ecdaa_rand_func get_random)
+{
+    return member->vtable->sign(member->state,
+                                signature_out,
+                                message,
+                                message_len,
+                                basename,
+                                basename_len,
+                                get_random);
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_CURVE_VTABLE_H
+#define ECDAA_CURVE_VTABLE_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/curve.h>
+#include <ecdaa/rand.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Per-curve entry points behind the runtime curve API (cf. ecdaa/curve.h).
+ *
+ * Each compiled-in curve provides one `ecdaa_curve_vtable_ZZZ`.
+ * The `state` pointers point to `verifier_state_size` or `member_state_size`
+ * bytes, owned by the caller, whose layout is private to the curve.
+ *
+ * Return codes match the corresponding functions in ecdaa/curve.h.
+ */
+struct ecdaa_curve_vtable {
+    enum ecdaa_curve_id id;
+    const char *name;
+
+    size_t group_public_key_length;
+    size_t member_secret_key_length;
+    size_t credential_length;
+    size_t signature_length;
+    size_t signature_with_nym_length;
+    size_t pseudonym_length;
+
+    size_t verifier_state_size;
+    size_t member_state_size;
+
+    int (*verifier_init)(void *state,
+                         uint8_t *gpk_buffer);
+
+    void (*verifier_clear)(void *state);
+
+    int (*verifier_set_revocations)(void *state,
+                                    uint8_t *sk_list,
+                                    size_t sk_length,
+                                    uint8_t *bsn_list,
+                                    size_t bsn_length);
+
+    int (*verify)(void *state,
+                  uint8_t *signature_buffer,
+                  uint8_t *message,
+                  uint32_t message_len,
+                  uint8_t *basename,
+                  uint32_t basename_len);
+
+    int (*member_init)(void *state,
+                       uint8_t *sk_buffer,
+                       uint8_t *credential_buffer);
+
+    void (*member_clear)(void *state);
+
+    int (*sign)(void *state,
+                uint8_t *signature_out,
+                uint8_t *message,
+                uint32_t message_len,
+                uint8_t *basename,
+                uint32_t basename_len,
+                ecdaa_rand_func get_random);
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,226 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "curve_vtable_ZZZ.h"
+
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "internal-utilities/explicit_bzero.h"
+
+#include <stdlib.h>
+
+struct verifier_state_ZZZ {
+    struct ecdaa_group_public_key_ZZZ gpk;
+    struct ecdaa_revocations_ZZZ revocations;
+};
+
+struct member_state_ZZZ {
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_credential_ZZZ cred;
+};
+
+static
+int verifier_init_ZZZ(void *state, uint8_t *gpk_buffer)
+{
+    struct verifier_state_ZZZ *verifier = state;
+
+    verifier->revocations.sk_length = 0;
+    verifier->revocations.sk_list = NULL;
+    verifier->revocations.bsn_length = 0;
+    verifier->revocations.bsn_list = NULL;
+
+    if (0 != ecdaa_group_public_key_ZZZ_deserialize(&verifier->gpk, gpk_buffer))
+        return -1;
+
+    return 0;
+}
+
+static
+void verifier_clear_ZZZ(void *state)
+{
+    struct verifier_state_ZZZ *verifier = state;
+
+    free(verifier->revocations.sk_list);
+    free(verifier->revocations.bsn_list);
+
+    verifier->revocations.sk_length = 0;
+    verifier->revocations.sk_list = NULL;
+    verifier->revocations.bsn_length = 0;
+    verifier->revocations.bsn_list = NULL;
+}
+
+static
+int verifier_set_revocations_ZZZ(void *state,
+                                 uint8_t *sk_list,
+                                 size_t sk_length,
+                                 uint8_t *bsn_list,
+                                 size_t bsn_length)
+{
+    struct verifier_state_ZZZ *verifier = state;
+
+    int ret = 0;
+
+    struct ecdaa_member_secret_key_ZZZ *new_sk_list = NULL;
+    ECP_ZZZ *new_bsn_list = NULL;
+
+    if (0 != sk_length) {
+        new_sk_list = malloc(sk_length * sizeof(struct ecdaa_member_secret_key_ZZZ));
+        if (NULL == new_sk_list) {
+            ret = -3;
+            goto cleanup;
+        }
+
+        for (size_t i = 0; i < sk_length; i++) {
+            if (0 != ecdaa_member_secret_key_ZZZ_deserialize(&new_sk_list[i],
+                                                               sk_list + i*ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH)) {
+                ret = -1;
+                goto cleanup;
+            }
+        }
+    }
+
+    if (0 != bsn_length) {
+        new_bsn_list = malloc(bsn_length * sizeof(ECP_ZZZ));
+        if (NULL == new_bsn_list) {
+            ret = -3;
+            goto cleanup;
+        }
+
+        for (size_t i = 0; i < bsn_length; i++) {
+            if (0 != ecp_ZZZ_deserialize(&new_bsn_list[i], bsn_list + i*ECP_ZZZ_LENGTH)) {
+                ret = -1;
+                goto cleanup;
+            }
+        }
+    }
+
+    verifier_clear_ZZZ(verifier);
+
+    verifier->revocations.sk_length = sk_length;
+    verifier->revocations.sk_list = new_sk_list;
+    verifier->revocations.bsn_length = bsn_length;
+    verifier->revocations.bsn_list = new_bsn_list;
+
+    return 0;
+
+cleanup:
+    free(new_sk_list);
+    free(new_bsn_list);
+
+    return ret;
+}
+
+static
+int verify_ZZZ(void *state,
+               uint8_t *signature_buffer,
+               uint8_t *message,
+               uint32_t message_len,
+               uint8_t *basename,
+               uint32_t basename_len)
+{
+    struct verifier_state_ZZZ *verifier = state;
+
+    struct ecdaa_signature_ZZZ signature;
+    return ecdaa_signature_ZZZ_deserialize_and_verify(&signature,
+                                                      &verifier->gpk,
+                                                      &verifier->revocations,
+                                                      signature_buffer,
+                                                      message,
+                                                      message_len,
+                                                      basename,
+                                                      basename_len,
+                                                      0 != basename_len);
+}
+
+static
+int member_init_ZZZ(void *state,
+                    uint8_t *sk_buffer,
+                    uint8_t *credential_buffer)
+{
+    struct member_state_ZZZ *member = state;
+
+    if (0 != ecdaa_member_secret_key_ZZZ_deserialize(&member->sk, sk_buffer))
+        return -1;
+
+    if (0 != ecdaa_credential_ZZZ_deserialize(&member->cred, credential_buffer))
+        return -1;
+
+    return 0;
+}
+
+static
+void member_clear_ZZZ(void *state)
+{
+    explicit_bzero(state, sizeof(struct member_state_ZZZ));
+}
+
+static
+int sign_ZZZ(void *state,
+             uint8_t *signature_out,
+             uint8_t *message,
+             uint32_t message_len,
+             uint8_t *basename,
+             uint32_t basename_len,
+             ecdaa_rand_func get_random)
+{
+    struct member_state_ZZZ *member = state;
+
+    struct ecdaa_signature_ZZZ signature;
+    if (0 != ecdaa_signature_ZZZ_sign(&signature,
+                                      message,
+                                      message_len,
+                                      basename,
+                                      basename_len,
+                                      &member->sk,
+                                      &member->cred,
+                                      get_random))
+        return -1;
+
+    ecdaa_signature_ZZZ_serialize(signature_out, &signature, 0 != basename_len);
+
+    return 0;
+}
+
+const struct ecdaa_curve_vtable ecdaa_curve_vtable_ZZZ = {
+    .id = ECDAA_CURVE_ZZZ,
+    .name = "ZZZ",
+
+    .group_public_key_length = ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH,
+    .member_secret_key_length = ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH,
+    .credential_length = ECDAA_CREDENTIAL_ZZZ_LENGTH,
+    .signature_length = ECDAA_SIGNATURE_ZZZ_LENGTH,
+    .signature_with_nym_length = ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH,
+    .pseudonym_length = ECP_ZZZ_LENGTH,
+
+    .verifier_state_size = sizeof(struct verifier_state_ZZZ),
+    .member_state_size = sizeof(struct member_state_ZZZ),
+
+    .verifier_init = verifier_init_ZZZ,
+    .verifier_clear = verifier_clear_ZZZ,
+    .verifier_set_revocations = verifier_set_revocations_ZZZ,
+    .verify = verify_ZZZ,
+
+    .member_init = member_init_ZZZ,
+    .member_clear = member_clear_ZZZ,
+    .sign = sign_ZZZ,
+};
@@ -0,0 +1,35 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_CURVE_VTABLE_ZZZ_H
+#define ECDAA_CURVE_VTABLE_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "curve_vtable.h"
+
+extern const struct ecdaa_curve_vtable ecdaa_curve_vtable_ZZZ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
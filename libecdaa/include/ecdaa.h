@@ -20,13 +20,22 @@
 #define ECDAA_ECDAA_H
 #pragma once
 
+#include <ecdaa/basename_session_ZZZ.h>
 #include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/curve.h>
 #include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/instrumentation.h>
 #include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/member_bundle_ZZZ.h>
 #include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/merkle_batch_ZZZ.h>
+#include <ecdaa/pseudonym_index_ZZZ.h>
 #include <ecdaa/rand.h>
 #include <ecdaa/revocations_ZZZ.h>
 #include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/verifier_kit_ZZZ.h>
+#include <ecdaa/verify_cache_ZZZ.h>
+#include <ecdaa/verify_scheduler_ZZZ.h>
 #include <ecdaa/util/file_io.h>
 #include <ecdaa/util/errors.h>
 
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_BASENAME_SESSION_ZZZ_H
+#define ECDAA_BASENAME_SESSION_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/rand.h>
+
+#include <amcl/ecp_ZZZ.h>
+
+#include <stdint.h>
+
+struct ecdaa_member_secret_key_ZZZ;
+
+#define ECDAA_BASENAME_SESSION_ZZZ_TABLE_SIZE 16
+
+/*
+ * Everything about one basename that stays the same across
+ * a member's basename signatures:
+ * the basename's curve point P2 (cf. `ecp_ZZZ_fromhash`),
+ * the member's pseudonym K = [sk]P2,
+ * and a precomputed table for multiplying P2.
+ *
+ * A member that signs repeatedly under one basename sets up a session once
+ * and signs with `ecdaa_signature_ZZZ_sign_with_session`,
+ * which then skips hashing the basename and computing K,
+ * and multiplies P2 faster.
+ *
+ * A session holds no secrets (K is public in every signature),
+ * but is only valid for the member secret key it was created with.
+ * `basename` is not copied, so it must outlive the session.
+ */
+struct ecdaa_basename_session_ZZZ {
+    const uint8_t *basename;
+    uint32_t basename_len;
+    ECP_ZZZ P2;
+    ECP_ZZZ K;
+    ECP_ZZZ P2_table[ECDAA_BASENAME_SESSION_ZZZ_TABLE_SIZE];
+};
+
+/*
+ * Set up a session for signing under `basename` with `sk`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `basename` is empty or can't be hashed to the curve
+ */
+int ecdaa_basename_session_ZZZ_init(struct ecdaa_basename_session_ZZZ *session_out,
+                                    const uint8_t *basename,
+                                    uint32_t basename_len,
+                                    struct ecdaa_member_secret_key_ZZZ *sk,
+                                    ecdaa_rand_func get_random);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -83,6 +83,23 @@ int ecdaa_credential_ZZZ_validate(struct ecdaa_credential_ZZZ *credential,
                                   struct ecdaa_member_public_key_ZZZ *member_pk,
                                   struct ecdaa_group_public_key_ZZZ *gpk);
 
+/*
+ * Validate a credential and its signature using the issuer's secret key,
+ * instead of the group public key.
+ *
+ * Checks B == y*A and C == x*(A+D) with (constant-time) G1 multiplications,
+ * in place of the four pairings of `ecdaa_credential_ZZZ_validate`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if credential is invalid
+ */
+int ecdaa_credential_ZZZ_validate_with_issuer_key(struct ecdaa_credential_ZZZ *credential,
+                                                  struct ecdaa_credential_ZZZ_signature *credential_signature,
+                                                  struct ecdaa_member_public_key_ZZZ *member_pk,
+                                                  struct ecdaa_issuer_secret_key_ZZZ *isk,
+                                                  ecdaa_rand_func get_random);
+
 /*
  * Serialize an `ecdaa_credential_ZZZ`
  *
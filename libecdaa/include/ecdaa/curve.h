@@ -0,0 +1,195 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_CURVE_H
+#define ECDAA_CURVE_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/rand.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Runtime curve selection.
+ *
+ * The curve-agnostic contexts below dispatch on a curve id at runtime,
+ * so one process can handle groups on several curves.
+ * Only these operations are dispatched:
+ *  - verifying a signature (`ecdaa_verifier_context_verify`),
+ *  - setting a verifier's revocation lists (`ecdaa_verifier_context_set_revocations`),
+ *  - signing a message (`ecdaa_member_context_sign`).
+ * Everything else (issuing, joining, batch verification, ...)
+ * still needs the `_ZZZ` API of a specific curve.
+ *
+ * All keys, credentials, and signatures are passed in their serialized form
+ * (as produced by the corresponding `_ZZZ_serialize` function).
+ *
+ * The numeric ids are stable, whether or not a curve was compiled in.
+ */
+enum ecdaa_curve_id {
+    ECDAA_CURVE_BN254 = 1,
+    ECDAA_CURVE_BN254CX = 2,
+    ECDAA_CURVE_BLS383 = 3,
+    ECDAA_CURVE_FP256BN = 4,
+    ECDAA_CURVE_BLS381 = 5,
+};
+
+/*
+ * Returns 1 if `curve` was compiled into this library (cf. `ECDAA_CURVES`), else 0.
+ */
+int ecdaa_curve_is_supported(enum ecdaa_curve_id curve);
+
+/*
+ * Look up a compiled-in curve by name (e.g. "FP256BN").
+ *
+ * Returns:
+ * 0 on success
+ * -1 if no compiled-in curve has that name
+ */
+int ecdaa_curve_from_name(enum ecdaa_curve_id *curve_out, const char *name);
+
+/*
+ * Name of `curve`, or NULL if it is not compiled in.
+ */
+const char *ecdaa_curve_name(enum ecdaa_curve_id curve);
+
+/*
+ * Serialized lengths on `curve` (0 if it is not compiled in).
+ */
+size_t ecdaa_curve_group_public_key_length(enum ecdaa_curve_id curve);
+size_t ecdaa_curve_member_secret_key_length(enum ecdaa_curve_id curve);
+size_t ecdaa_curve_credential_length(enum ecdaa_curve_id curve);
+size_t ecdaa_curve_signature_length(enum ecdaa_curve_id curve, int has_nym);
+size_t ecdaa_curve_pseudonym_length(enum ecdaa_curve_id curve);
+
+/*
+ * Verifier state for one group: its group public key and revocation lists.
+ */
+struct ecdaa_verifier_context;
+
+/*
+ * Create a verifier for the group whose serialized group public key is `gpk_buffer`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `gpk_buffer` isn't a valid group public key
+ * -2 if `curve` is not compiled in
+ * -3 on allocation failure
+ */
+int ecdaa_verifier_context_new(struct ecdaa_verifier_context **verifier_out,
+                               enum ecdaa_curve_id curve,
+                               uint8_t *gpk_buffer);
+
+/*
+ * Free a verifier (NULL is ignored).
+ */
+void ecdaa_verifier_context_free(struct ecdaa_verifier_context *verifier);
+
+enum ecdaa_curve_id ecdaa_verifier_context_curve(struct ecdaa_verifier_context *verifier);
+
+/*
+ * Replace the verifier's revocation lists.
+ *
+ * `sk_list` holds `sk_length` serialized member secret keys, back-to-back.
+ * `bsn_list` holds `bsn_length` serialized pseudonyms (ie. `K` values), back-to-back.
+ *
+ * On failure, the previous lists are left in place.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if any list entry is malformed
+ * -3 on allocation failure
+ */
+int ecdaa_verifier_context_set_revocations(struct ecdaa_verifier_context *verifier,
+                                           uint8_t *sk_list,
+                                           size_t sk_length,
+                                           uint8_t *bsn_list,
+                                           size_t bsn_length);
+
+/*
+ * Verify a serialized signature.
+ *
+ * If `basename_len` is non-zero, the signature must include a pseudonym.
+ *
+ * Returns:
+ * 0 if the signature is valid
+ * -1 if the signature is malformed
+ * -2 if the signature is invalid
+ */
+int ecdaa_verifier_context_verify(struct ecdaa_verifier_context *verifier,
+                                  uint8_t *signature_buffer,
+                                  uint8_t *message,
+                                  uint32_t message_len,
+                                  uint8_t *basename,
+                                  uint32_t basename_len);
+
+/*
+ * Member state: its secret key and credential.
+ */
+struct ecdaa_member_context;
+
+/*
+ * Create a signer from a serialized member secret key and credential.
+ *
+ * The credential is assumed to have already been validated
+ * (cf. `ecdaa_credential_ZZZ_deserialize_with_signature`).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `sk_buffer` or `credential_buffer` is malformed
+ * -2 if `curve` is not compiled in
+ * -3 on allocation failure
+ */
+int ecdaa_member_context_new(struct ecdaa_member_context **member_out,
+                             enum ecdaa_curve_id curve,
+                             uint8_t *sk_buffer,
+                             uint8_t *credential_buffer);
+
+/*
+ * Clear the secret key and free the signer (NULL is ignored).
+ */
+void ecdaa_member_context_free(struct ecdaa_member_context *member);
+
+enum ecdaa_curve_id ecdaa_member_context_curve(struct ecdaa_member_context *member);
+
+/*
+ * Sign `message`, writing the serialized signature into `signature_out`
+ * (which must hold `ecdaa_curve_signature_length(curve, basename_len != 0)` bytes).
+ *
+ * Returns:
+ * 0 on success
+ * -1 on failure
+ */
+int ecdaa_member_context_sign(struct ecdaa_member_context *member,
+                              uint8_t *signature_out,
+                              uint8_t *message,
+                              uint32_t message_len,
+                              uint8_t *basename,
+                              uint32_t basename_len,
+                              ecdaa_rand_func get_random);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_INSTRUMENTATION_H
+#define ECDAA_INSTRUMENTATION_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Hot-path operations that are counted and timed
+ * when the library is built with `-DECDAA_INSTRUMENTATION=ON`.
+ *
+ * For the revocation scans and hash-to-curve, `items` counts
+ * list entries scanned and points tried, respectively.
+ * For pairings, `items` counts the pairings computed
+ * (a product of pairings sharing one final exponentiation is one call),
+ * and for G1 multiplications, the points multiplied
+ * (several points multiplied by the same scalar together is one call).
+ * For every other event `items` equals `calls`.
+ */
+enum ecdaa_instrumentation_event {
+    ECDAA_INSTRUMENTATION_PAIRING = 0,
+    ECDAA_INSTRUMENTATION_ECP_MUL,
+    ECDAA_INSTRUMENTATION_ECP2_MUL,
+    ECDAA_INSTRUMENTATION_HASH_TO_CURVE,
+    ECDAA_INSTRUMENTATION_ECP_SUBGROUP_CHECK,
+    ECDAA_INSTRUMENTATION_ECP2_SUBGROUP_CHECK,
+    ECDAA_INSTRUMENTATION_SK_REVOCATION_SCAN,
+    ECDAA_INSTRUMENTATION_BSN_REVOCATION_SCAN,
+    ECDAA_INSTRUMENTATION_EVENT_COUNT
+};
+
+struct ecdaa_instrumentation_counter {
+    uint64_t calls;
+    uint64_t items;
+    uint64_t nanoseconds;
+};
+
+/*
+ * Called after every instrumented operation completes.
+ *
+ * Runs on the thread that performed the operation, so it must be thread-safe
+ * if the library is used from multiple threads.
+ */
+typedef void (*ecdaa_instrumentation_callback)(enum ecdaa_instrumentation_event event,
+                                               uint64_t items,
+                                               uint64_t nanoseconds,
+                                               void *user_data);
+
+/*
+ * Returns 1 if the library was built with instrumentation enabled, else 0.
+ */
+int ecdaa_instrumentation_enabled(void);
+
+/*
+ * Copy the cumulative counter for `event` into `counter_out`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if instrumentation is disabled or `event` is unknown
+ */
+int ecdaa_instrumentation_get(struct ecdaa_instrumentation_counter *counter_out,
+                              enum ecdaa_instrumentation_event event);
+
+/*
+ * Zero all counters.
+ */
+void ecdaa_instrumentation_reset(void);
+
+/*
+ * Register a tracing callback (`NULL` unregisters).
+ *
+ * Must not be called concurrently with instrumented operations.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if instrumentation is disabled
+ */
+int ecdaa_instrumentation_set_callback(ecdaa_instrumentation_callback callback,
+                                       void *user_data);
+
+/*
+ * Human-readable name of `event`, or NULL if unknown.
+ */
+const char *ecdaa_instrumentation_event_name(enum ecdaa_instrumentation_event event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
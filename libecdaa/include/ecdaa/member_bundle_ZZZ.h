@@ -0,0 +1,163 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_MEMBER_BUNDLE_ZZZ_H
+#define ECDAA_MEMBER_BUNDLE_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/rand.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ecdaa_member_secret_key_ZZZ;
+struct ecdaa_credential_ZZZ;
+struct ecdaa_group_public_key_ZZZ;
+struct ecdaa_basename_session_ZZZ;
+struct ecdaa_signature_ZZZ;
+
+/*
+ * Everything a member needs to sign, stored together:
+ * its secret key, its credential, the group public key,
+ * and a basename session (cf. `ecdaa_basename_session_ZZZ`) for each basename it signs under.
+ *
+ * A bundle is serialized once (eg. after joining) and stored on the device.
+ * Loading it takes a single read, and recomputes nothing:
+ * the sessions' points and tables are read back as stored,
+ * and the subgroup checks, which the stored values already passed, are skipped.
+ * A trailing SHA-256 checksum guards against corruption of the stored bundle
+ *  (it's not a MAC, so the storage must still be trusted).
+ *
+ * The serialized format is:
+ *  ( "EDMB" | version (1 byte) | num_sessions (4 bytes, big-endian) |
+ *    member secret key | credential | group public key |
+ *    num_sessions * ( basename_len (4 bytes, big-endian) | basename | P2 | K | P2_table ) |
+ *    SHA-256 checksum of all the preceding bytes )
+ *
+ * The serialized bundle holds the member secret key, so it must be stored securely.
+ */
+struct ecdaa_member_bundle_ZZZ;
+
+#define ECDAA_MEMBER_BUNDLE_ZZZ_VERSION 1
+
+/*
+ * Create a bundle (with no basename sessions) from a member's keys and credential.
+ *
+ * The credential is assumed to have already been validated
+ * (cf. `ecdaa_credential_ZZZ_deserialize_with_signature`).
+ *
+ * Returns:
+ * 0 on success
+ * -3 on allocation failure
+ */
+int ecdaa_member_bundle_ZZZ_new(struct ecdaa_member_bundle_ZZZ **bundle_out,
+                                struct ecdaa_member_secret_key_ZZZ *sk,
+                                struct ecdaa_credential_ZZZ *cred,
+                                struct ecdaa_group_public_key_ZZZ *gpk);
+
+/*
+ * Clear the secret key and free the bundle (NULL is ignored).
+ */
+void ecdaa_member_bundle_ZZZ_free(struct ecdaa_member_bundle_ZZZ *bundle);
+
+/*
+ * Set up a basename session for `basename` in the bundle
+ * (the basename is copied).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `basename` is empty, can't be hashed to the curve, or already has a session
+ * -3 on allocation failure
+ */
+int ecdaa_member_bundle_ZZZ_add_basename(struct ecdaa_member_bundle_ZZZ *bundle,
+                                         const uint8_t *basename,
+                                         uint32_t basename_len,
+                                         ecdaa_rand_func get_random);
+
+struct ecdaa_member_secret_key_ZZZ *ecdaa_member_bundle_ZZZ_secret_key(struct ecdaa_member_bundle_ZZZ *bundle);
+struct ecdaa_credential_ZZZ *ecdaa_member_bundle_ZZZ_credential(struct ecdaa_member_bundle_ZZZ *bundle);
+struct ecdaa_group_public_key_ZZZ *ecdaa_member_bundle_ZZZ_group_public_key(struct ecdaa_member_bundle_ZZZ *bundle);
+
+/*
+ * The bundle's session for `basename`, or NULL if it has none.
+ *
+ * The session stays at the same address until the bundle is freed
+ * (adding more basenames doesn't move it).
+ */
+struct ecdaa_basename_session_ZZZ *ecdaa_member_bundle_ZZZ_find_session(struct ecdaa_member_bundle_ZZZ *bundle,
+                                                                        const uint8_t *basename,
+                                                                        uint32_t basename_len);
+
+/*
+ * Sign `message` with the bundle's secret key and credential.
+ *
+ * If `basename_len` is non-zero and the bundle has a session for `basename`,
+ * the session is used (cf. `ecdaa_signature_ZZZ_sign_with_session`),
+ * else this is the same as `ecdaa_signature_ZZZ_sign`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if unable to create signature
+ */
+int ecdaa_member_bundle_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
+                                 const uint8_t *message,
+                                 uint32_t message_len,
+                                 const uint8_t *basename,
+                                 uint32_t basename_len,
+                                 struct ecdaa_member_bundle_ZZZ *bundle,
+                                 ecdaa_rand_func get_random);
+
+/*
+ * Length of the serialized bundle.
+ */
+size_t ecdaa_member_bundle_ZZZ_length(struct ecdaa_member_bundle_ZZZ *bundle);
+
+/*
+ * Serialize the bundle into `buffer_out`, which must hold `ecdaa_member_bundle_ZZZ_length(bundle)` bytes.
+ */
+void ecdaa_member_bundle_ZZZ_serialize(uint8_t *buffer_out,
+                                       struct ecdaa_member_bundle_ZZZ *bundle);
+
+int ecdaa_member_bundle_ZZZ_serialize_file(const char *file,
+                                           struct ecdaa_member_bundle_ZZZ *bundle);
+
+/*
+ * Load a serialized bundle of `buffer_len` bytes
+ *  (eg. a memory-mapped bundle file, which is only read).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the buffer isn't a valid bundle (wrong format or version, bad checksum, or malformed contents)
+ * -3 on allocation failure
+ */
+int ecdaa_member_bundle_ZZZ_deserialize(struct ecdaa_member_bundle_ZZZ **bundle_out,
+                                        const uint8_t *buffer,
+                                        size_t buffer_len);
+
+int ecdaa_member_bundle_ZZZ_deserialize_file(struct ecdaa_member_bundle_ZZZ **bundle_out,
+                                             const char *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
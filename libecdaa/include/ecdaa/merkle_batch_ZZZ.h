@@ -0,0 +1,196 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_MERKLE_BATCH_ZZZ_H
+#define ECDAA_MERKLE_BATCH_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/rand.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ecdaa_credential_ZZZ;
+struct ecdaa_member_secret_key_ZZZ;
+struct ecdaa_revocations_ZZZ;
+struct ecdaa_group_public_key_ZZZ;
+
+#define ECDAA_MERKLE_BATCH_ZZZ_DIGEST_LENGTH 32
+#define ECDAA_MERKLE_BATCH_ZZZ_MAX_DEPTH 32
+
+/*
+ * One ECDAA signature over many messages.
+ *
+ * The messages are the leaves of a SHA-256 Merkle tree,
+ * and `signature` is an ordinary ECDAA signature over the tree's `root` (and `num_messages`).
+ * Each message is then checked against the root using its `ecdaa_merkle_proof_ZZZ`,
+ * which only requires hashing.
+ *
+ * Leaves are hashed as H(0x00 | message) and interior nodes as H(0x01 | left | right).
+ * A node without a sibling (the last node of a level with an odd number of nodes)
+ * moves up to the next level unchanged.
+ */
+struct ecdaa_merkle_batch_ZZZ {
+    uint8_t root[ECDAA_MERKLE_BATCH_ZZZ_DIGEST_LENGTH];
+    uint32_t num_messages;
+    struct ecdaa_signature_ZZZ signature;
+};
+
+/*
+ * Inclusion proof of the message at `message_index` in a batch of `num_messages`:
+ * the sibling of each node on the path from that message's leaf to the root, bottom-up.
+ */
+struct ecdaa_merkle_proof_ZZZ {
+    uint32_t message_index;
+    uint32_t num_messages;
+    uint32_t num_siblings;
+    uint8_t siblings[ECDAA_MERKLE_BATCH_ZZZ_MAX_DEPTH][ECDAA_MERKLE_BATCH_ZZZ_DIGEST_LENGTH];
+};
+
+#define ECDAA_MERKLE_BATCH_ZZZ_LENGTH (ECDAA_MERKLE_BATCH_ZZZ_DIGEST_LENGTH + 4 + ECDAA_SIGNATURE_ZZZ_LENGTH)
+size_t ecdaa_merkle_batch_ZZZ_length(void);
+
+#define ECDAA_MERKLE_BATCH_ZZZ_WITH_NYM_LENGTH (ECDAA_MERKLE_BATCH_ZZZ_DIGEST_LENGTH + 4 + ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH)
+size_t ecdaa_merkle_batch_ZZZ_with_nym_length(void);
+
+#define ECDAA_MERKLE_PROOF_ZZZ_MAX_LENGTH (8 + ECDAA_MERKLE_BATCH_ZZZ_MAX_DEPTH*ECDAA_MERKLE_BATCH_ZZZ_DIGEST_LENGTH)
+
+/*
+ * Serialized length of `proof` (which depends on its message's position in the tree).
+ */
+size_t ecdaa_merkle_proof_ZZZ_length(struct ecdaa_merkle_proof_ZZZ *proof);
+
+/*
+ * Sign `num_messages` messages at once.
+ *
+ * Builds the Merkle tree over `messages` and signs its root,
+ * so the whole batch costs one `ecdaa_signature_ZZZ_sign`, plus about two hashes per message.
+ *
+ * `proofs_out` must hold `num_messages` proofs:
+ * `proofs_out[i]` is set to the inclusion proof for `messages[i]`.
+ *
+ * To create an unlinkable signature,
+ * `basename` must be `NULL` *and* `basename_len` must be `0`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `num_messages` is 0, or unable to create signature
+ * -3 on allocation failure
+ */
+int ecdaa_merkle_batch_ZZZ_sign(struct ecdaa_merkle_batch_ZZZ *batch_out,
+                                struct ecdaa_merkle_proof_ZZZ *proofs_out,
+                                uint8_t* const *messages,
+                                const uint32_t *message_lens,
+                                uint32_t num_messages,
+                                const uint8_t* basename,
+                                uint32_t basename_len,
+                                struct ecdaa_member_secret_key_ZZZ *sk,
+                                struct ecdaa_credential_ZZZ *cred,
+                                ecdaa_rand_func get_random);
+
+/*
+ * Verify the signature over a batch's root.
+ *
+ * This is done once per batch;
+ * afterwards each message is checked with `ecdaa_merkle_batch_ZZZ_verify_message`.
+ *
+ * If verifying an unlinkable signature,
+ * `basename` must be `NULL` *and* `basename_len` must be `0`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if signature is invalid (or revoked)
+ */
+int ecdaa_merkle_batch_ZZZ_verify(struct ecdaa_merkle_batch_ZZZ *batch,
+                                  struct ecdaa_group_public_key_ZZZ *gpk,
+                                  struct ecdaa_revocations_ZZZ *revocations,
+                                  uint8_t *basename,
+                                  uint32_t basename_len);
+
+/*
+ * Check that `message` is in `batch`, using its inclusion proof.
+ *
+ * Only hashes (about log2(num_messages) of them):
+ * `batch` must already have been checked with `ecdaa_merkle_batch_ZZZ_verify`.
+ *
+ * Returns:
+ * 0 if `message` is the message at `proof->message_index` in `batch`
+ * -1 otherwise
+ */
+int ecdaa_merkle_batch_ZZZ_verify_message(struct ecdaa_merkle_batch_ZZZ *batch,
+                                          struct ecdaa_merkle_proof_ZZZ *proof,
+                                          uint8_t *message,
+                                          uint32_t message_len);
+
+/*
+ * Serialize an `ecdaa_merkle_batch_ZZZ`.
+ *
+ * The serialized format is:
+ *  ( root | num_messages (big-endian, 4 bytes) | signature )
+ * where `signature` is as serialized by `ecdaa_signature_ZZZ_serialize`.
+ *
+ * The provided buffer is assumed to be large enough.
+ */
+void ecdaa_merkle_batch_ZZZ_serialize(uint8_t *buffer_out,
+                                      struct ecdaa_merkle_batch_ZZZ *batch,
+                                      int has_nym);
+
+/*
+ * De-serialize an `ecdaa_merkle_batch_ZZZ`, but _don't_ verify it.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if batch is mal-formed
+ */
+int ecdaa_merkle_batch_ZZZ_deserialize(struct ecdaa_merkle_batch_ZZZ *batch_out,
+                                       uint8_t *buffer_in,
+                                       int has_nym);
+
+/*
+ * Serialize an `ecdaa_merkle_proof_ZZZ`, returning its length.
+ *
+ * The serialized format is:
+ *  ( message_index | num_messages | sibling_1 | ... | sibling_k )
+ * (with the integers big-endian, 4 bytes each).
+ *
+ * `buffer_out` must hold `ecdaa_merkle_proof_ZZZ_length(proof)` bytes.
+ */
+size_t ecdaa_merkle_proof_ZZZ_serialize(uint8_t *buffer_out,
+                                        struct ecdaa_merkle_proof_ZZZ *proof);
+
+/*
+ * De-serialize an `ecdaa_merkle_proof_ZZZ` of `buffer_len` bytes.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if proof is mal-formed (including the wrong number of siblings for its position)
+ */
+int ecdaa_merkle_proof_ZZZ_deserialize(struct ecdaa_merkle_proof_ZZZ *proof_out,
+                                       uint8_t *buffer_in,
+                                       size_t buffer_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_PSEUDONYM_INDEX_ZZZ_H
+#define ECDAA_PSEUDONYM_INDEX_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/signature_ZZZ.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Index of the pseudonyms (ie. `K` values) seen in basename signatures.
+ *
+ * A pseudonym links every signature one member makes under one basename,
+ * so an index only makes sense for a single basename:
+ * keep one index per basename the verifier accepts.
+ *
+ * Lookups and additions are O(1) (expected), and may be called concurrently
+ * from multiple threads.
+ *
+ * If the index is backed by a log file, every addition is appended to it,
+ * so the index can be rebuilt after a restart.
+ * Log format: repeated records of ( K | timestamp (8 bytes, big-endian) ).
+ */
+struct ecdaa_pseudonym_index_ZZZ;
+
+struct ecdaa_pseudonym_record_ZZZ {
+    uint64_t count;
+    uint64_t first_seen;
+    uint64_t last_seen;
+};
+
+#define ECDAA_PSEUDONYM_ZZZ_LENGTH (2*MODBYTES_XXX + 1)
+#define ECDAA_PSEUDONYM_INDEX_ZZZ_LOG_RECORD_LENGTH (ECDAA_PSEUDONYM_ZZZ_LENGTH + 8)
+
+/*
+ * Create an empty pseudonym index.
+ *
+ * If `log_file` is non-NULL, the index is first rebuilt from that file (which is created if missing),
+ *  and all later additions are appended to it.
+ * A trailing partial record (eg. from a crash mid-write) is discarded.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the log file can't be read or written, or holds a malformed record
+ * -3 on allocation failure
+ */
+int ecdaa_pseudonym_index_ZZZ_new(struct ecdaa_pseudonym_index_ZZZ **index_out,
+                                  const char *log_file);
+
+/*
+ * Close the log file (if any) and free the index (NULL is ignored).
+ */
+void ecdaa_pseudonym_index_ZZZ_free(struct ecdaa_pseudonym_index_ZZZ *index);
+
+/*
+ * Record the pseudonym of an already-verified basename signature, seen at `timestamp`.
+ *
+ * If `record_out` is non-NULL, the pseudonym's updated record is copied into it
+ *  (so `record_out->count == 1` means this is the first time it was seen).
+ *
+ * If appending to the log file fails, any partly-written record is removed again,
+ *  so the log stays replayable.
+ *  If even that fails, this and every later addition to the index fail.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the log file can't be written (the index is left unchanged)
+ * -3 on allocation failure
+ */
+int ecdaa_pseudonym_index_ZZZ_add(struct ecdaa_pseudonym_index_ZZZ *index,
+                                  struct ecdaa_signature_ZZZ *signature,
+                                  uint64_t timestamp,
+                                  struct ecdaa_pseudonym_record_ZZZ *record_out);
+
+/*
+ * As `ecdaa_pseudonym_index_ZZZ_add`, but for a serialized pseudonym
+ *  (cf. `ecdaa_signature_ZZZ_access_pseudonym_in_serialized`).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the pseudonym is malformed, or the log file can't be written
+ * -3 on allocation failure
+ */
+int ecdaa_pseudonym_index_ZZZ_add_serialized(struct ecdaa_pseudonym_index_ZZZ *index,
+                                             const uint8_t *pseudonym,
+                                             uint64_t timestamp,
+                                             struct ecdaa_pseudonym_record_ZZZ *record_out);
+
+/*
+ * Has this serialized pseudonym been seen before?
+ *
+ * Returns:
+ * 0 if it has (and its record is copied into `record_out`, if non-NULL)
+ * -1 if it has not
+ */
+int ecdaa_pseudonym_index_ZZZ_lookup(struct ecdaa_pseudonym_index_ZZZ *index,
+                                     const uint8_t *pseudonym,
+                                     struct ecdaa_pseudonym_record_ZZZ *record_out);
+
+/*
+ * Number of distinct pseudonyms in the index.
+ */
+size_t ecdaa_pseudonym_index_ZZZ_size(struct ecdaa_pseudonym_index_ZZZ *index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,10 +29,12 @@ extern "C" {
 #include <amcl/big_XXX.h>
 #include <amcl/ecp_ZZZ.h>
 
+struct ecdaa_basename_session_ZZZ;
 struct ecdaa_credential_ZZZ;
 struct ecdaa_member_secret_key_ZZZ;
 struct ecdaa_revocations_ZZZ;
 struct ecdaa_group_public_key_ZZZ;
+struct ecdaa_issuer_secret_key_ZZZ;
 
 /*
  * ECDAA signature.
@@ -75,6 +77,25 @@ int ecdaa_signature_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
                              struct ecdaa_credential_ZZZ *cred,
                              ecdaa_rand_func get_random);
 
+/*
+ * Create a basename signature, using a basename session
+ * (cf. `ecdaa_basename_session_ZZZ_init`) set up for `sk`.
+ *
+ * Produces the same kind of signature as `ecdaa_signature_ZZZ_sign`
+ * with the session's basename, but faster.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if unable to create signature
+ */
+int ecdaa_signature_ZZZ_sign_with_session(struct ecdaa_signature_ZZZ *signature_out,
+                                          const uint8_t* message,
+                                          uint32_t message_len,
+                                          struct ecdaa_basename_session_ZZZ *session,
+                                          struct ecdaa_member_secret_key_ZZZ *sk,
+                                          struct ecdaa_credential_ZZZ *cred,
+                                          ecdaa_rand_func get_random);
+
 /*
  * Verify an ECDAA signature.
  *
@@ -93,6 +114,111 @@ int ecdaa_signature_ZZZ_verify(struct ecdaa_signature_ZZZ *signature,
                                uint8_t *basename,
                                uint32_t basename_len);
 
+/*
+ * Verify an ECDAA signature made in one of `num_groups` candidate groups,
+ * and find out which.
+ *
+ * `gpks[i]` and `revocations[i]` are the group public key and revocation lists of candidate `i`.
+ *
+ * Accepts the same signatures as calling `ecdaa_signature_ZZZ_verify` with each candidate in turn,
+ * but the work that doesn't depend on the group
+ * (the Schnorr-type signature, and half of the pairings) is only done once.
+ * So each candidate costs at most two pairings, instead of four
+ *  (and usually just one, if the signature wasn't made in it).
+ * Only the matching group's revocation lists are checked.
+ *
+ * If verifying an unlinkable signature,
+ * `basename` must be `NULL` *and* `basename_len` must be `0`.
+ *
+ * Returns:
+ * 0 on success (and `group_index_out` is set to the index of the signature's group)
+ * -1 if signature isn't valid in any of the groups (or is revoked in its group)
+ */
+int ecdaa_signature_ZZZ_verify_multi_group(size_t *group_index_out,
+                                           struct ecdaa_signature_ZZZ *signature,
+                                           struct ecdaa_group_public_key_ZZZ **gpks,
+                                           struct ecdaa_revocations_ZZZ **revocations,
+                                           size_t num_groups,
+                                           uint8_t* message,
+                                           uint32_t message_len,
+                                           uint8_t *basename,
+                                           uint32_t basename_len);
+
+/*
+ * Verify an ECDAA signature, returning as soon as any check fails.
+ *
+ * Accepts exactly the same signatures as `ecdaa_signature_ZZZ_verify`,
+ * but runs the checks cheapest-first
+ * (pseudonym revocation list, Schnorr-type signature, pairings, secret key revocation list),
+ * so invalid signatures are usually rejected before any pairing is computed.
+ * Meant for verifiers exposed to floods of bogus signatures.
+ *
+ * If verifying an unlinkable signature,
+ * `basename` must be `NULL` *and* `basename_len` must be `0`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if signature is invalid
+ */
+int ecdaa_signature_ZZZ_verify_fail_fast(struct ecdaa_signature_ZZZ *signature,
+                                         struct ecdaa_group_public_key_ZZZ *gpk,
+                                         struct ecdaa_revocations_ZZZ *revocations,
+                                         uint8_t* message,
+                                         uint32_t message_len,
+                                         uint8_t *basename,
+                                         uint32_t basename_len);
+
+/*
+ * Verify an ECDAA signature using the issuer's secret key, instead of the group public key.
+ *
+ * Only usable by the issuer itself (or a verifier it trusts with its secret key).
+ * Replaces the four pairings of `ecdaa_signature_ZZZ_verify`
+ * with two (constant-time) G1 multiplications by the issuer's secret key;
+ * the Schnorr-type signature and revocation lists are checked as usual.
+ *
+ * If verifying an unlinkable signature,
+ * `basename` must be `NULL` *and* `basename_len` must be `0`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if signature is invalid
+ */
+int ecdaa_signature_ZZZ_verify_with_issuer_key(struct ecdaa_signature_ZZZ *signature,
+                                               struct ecdaa_issuer_secret_key_ZZZ *isk,
+                                               struct ecdaa_revocations_ZZZ *revocations,
+                                               uint8_t* message,
+                                               uint32_t message_len,
+                                               uint8_t *basename,
+                                               uint32_t basename_len,
+                                               ecdaa_rand_func get_random);
+
+/*
+ * Verify a batch of ECDAA signatures from the same group, made with the same basename.
+ *
+ * Rather than checking two pairing equations per signature,
+ * the equations of all signatures are combined (each weighted by a random 64-bit exponent)
+ * into one product of three pairings, so the per-signature cost is mostly the Schnorr check.
+ * If the combined check fails, the signatures are re-checked one at a time
+ * (with `ecdaa_signature_ZZZ_verify`) to find the invalid ones.
+ *
+ * `results_out[i]` is set to the result of verifying `signatures[i]`
+ * (0 if valid, -1 if invalid).
+ *
+ * Returns:
+ * 0 if every signature is valid
+ * -1 if any signature is invalid
+ */
+int ecdaa_signature_ZZZ_batch_verify(int *results_out,
+                                     struct ecdaa_signature_ZZZ *signatures,
+                                     uint8_t* const *messages,
+                                     const uint32_t *message_lens,
+                                     size_t num_signatures,
+                                     struct ecdaa_group_public_key_ZZZ *gpk,
+                                     struct ecdaa_revocations_ZZZ *revocations,
+                                     uint8_t *basename,
+                                     uint32_t basename_len,
+                                     ecdaa_rand_func get_random);
+
 
 /*
  * Serialize an `ecdaa_signature_ZZZ`
@@ -112,6 +238,21 @@ void ecdaa_signature_ZZZ_serialize(uint8_t *buffer_out,
                                    struct ecdaa_signature_ZZZ *signature,
                                    int has_nym);
 
+/*
+ * Serialize `num_signatures` signatures back-to-back into `buffer_out`
+ * (each as by `ecdaa_signature_ZZZ_serialize`).
+ *
+ * Faster than serializing them one at a time,
+ * as the points of many signatures are converted to affine coordinates together.
+ *
+ * `buffer_out` must hold `num_signatures` times
+ * `ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH` (if `has_nym`) or `ECDAA_SIGNATURE_ZZZ_LENGTH` bytes.
+ */
+void ecdaa_signature_ZZZ_serialize_batch(uint8_t *buffer_out,
+                                         struct ecdaa_signature_ZZZ *signatures,
+                                         size_t num_signatures,
+                                         int has_nym);
+
 int ecdaa_signature_ZZZ_serialize_file(const char* file,
                                    struct ecdaa_signature_ZZZ *signature,
                                    int has_nym);
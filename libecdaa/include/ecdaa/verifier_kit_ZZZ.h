@@ -0,0 +1,144 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_VERIFIER_KIT_ZZZ_H
+#define ECDAA_VERIFIER_KIT_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ecdaa_group_public_key_ZZZ;
+struct ecdaa_revocations_ZZZ;
+struct ecdaa_signature_ZZZ;
+
+/*
+ * A verifier kit: everything a verifier needs for one group
+ * (its group public key and revocation lists),
+ * written once to a file that any number of verifier processes can map.
+ *
+ * Revoked pseudonyms are also stored as a sorted index,
+ * so `ecdaa_verifier_kit_ZZZ_verify` checks them with a binary search instead of a scan.
+ *
+ * The kit holds these in the library's in-memory representation,
+ * so opening it deserializes and re-checks no points:
+ * it maps the file, checks the header and a SHA-256 checksum of the whole file,
+ * and points into the mapping.
+ * Every process that maps the same file shares its pages (through the page cache),
+ * so neither memory use nor start-up time grows with the number of processes.
+ *
+ * Since it holds raw in-memory structures,
+ * a kit can only be opened by builds of the library with the same curve, byte order,
+ * and AMCL representation (word size, bits per word, and modulus type),
+ * which is checked when it's opened.
+ * Its contents are trusted: it must be written only from validated inputs,
+ * and protected like the rest of the verifier's configuration.
+ *
+ * The file is mapped read-only.
+ * The revocation lists point into the mapping, so they must not be modified
+ * (the verify functions only read them).
+ */
+struct ecdaa_verifier_kit_ZZZ;
+
+#define ECDAA_VERIFIER_KIT_ZZZ_VERSION 2
+
+/*
+ * Write a kit holding `gpk` and `revocations` to `file`.
+ *
+ * `gpk` must already be validated (eg. by `ecdaa_group_public_key_ZZZ_deserialize`
+ *  or `ecdaa_issuer_public_key_ZZZ_deserialize`),
+ * as must every entry of `revocations`.
+ *
+ * The kit is written to a temporary file, then renamed to `file`,
+ * so processes that have the old kit open keep using it unchanged,
+ * and newly-opened kits are never partially written.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the file can't be written
+ * -3 on allocation failure
+ */
+int ecdaa_verifier_kit_ZZZ_write_file(const char *file,
+                                      struct ecdaa_group_public_key_ZZZ *gpk,
+                                      struct ecdaa_revocations_ZZZ *revocations);
+
+/*
+ * Map the kit in `file`.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the file can't be mapped, isn't a kit for this curve and build, or is corrupted
+ * -3 on allocation failure
+ */
+int ecdaa_verifier_kit_ZZZ_open(struct ecdaa_verifier_kit_ZZZ **kit_out,
+                                const char *file);
+
+/*
+ * Unmap and free the kit (NULL is ignored).
+ *
+ * Pointers obtained from the kit are invalid afterwards.
+ */
+void ecdaa_verifier_kit_ZZZ_close(struct ecdaa_verifier_kit_ZZZ *kit);
+
+/*
+ * The kit's group public key and revocation lists, ready to pass to
+ * `ecdaa_signature_ZZZ_verify` (or any other verify function).
+ */
+struct ecdaa_group_public_key_ZZZ *ecdaa_verifier_kit_ZZZ_group_public_key(struct ecdaa_verifier_kit_ZZZ *kit);
+struct ecdaa_revocations_ZZZ *ecdaa_verifier_kit_ZZZ_revocations(struct ecdaa_verifier_kit_ZZZ *kit);
+
+/*
+ * Verify an ECDAA signature against the kit's group public key and revocation lists.
+ *
+ * Same as `ecdaa_signature_ZZZ_verify` with the kit's group public key and revocation lists,
+ * but the pseudonym is looked up in the kit's sorted index (O(log n)),
+ * rather than compared against every revoked pseudonym.
+ * The secret-key revocation list is still scanned:
+ * each entry must be multiplied into the signature, so it can't be indexed.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if signature is invalid
+ */
+int ecdaa_verifier_kit_ZZZ_verify(struct ecdaa_verifier_kit_ZZZ *kit,
+                                  struct ecdaa_signature_ZZZ *signature,
+                                  uint8_t *message,
+                                  uint32_t message_len,
+                                  uint8_t *basename,
+                                  uint32_t basename_len);
+
+/*
+ * Is this serialized pseudonym
+ * (cf. `ecdaa_signature_ZZZ_access_pseudonym_in_serialized`) on the kit's revocation list?
+ *
+ * Returns:
+ * 0 if it isn't
+ * -1 if it is (ie. it's revoked)
+ */
+int ecdaa_verifier_kit_ZZZ_check_pseudonym(struct ecdaa_verifier_kit_ZZZ *kit,
+                                           const uint8_t *pseudonym);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_VERIFY_CACHE_ZZZ_H
+#define ECDAA_VERIFY_CACHE_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ecdaa_group_public_key_ZZZ;
+struct ecdaa_revocations_ZZZ;
+
+/*
+ * Cache of signature verification results.
+ *
+ * Each result is keyed by a SHA-256 digest of the group public key,
+ * the serialized signature, the message, the basename,
+ * and a digest of the contents of the cache's revocation lists.
+ * So re-verifying a signature that was already seen costs a hash and a lookup,
+ * instead of a deserialization and several pairings.
+ *
+ * The cache holds at most `capacity` results (rounded up),
+ * evicting the least-recently-used result of a set when it's full.
+ * It's split into independently-locked shards,
+ * so it may be used concurrently from multiple threads.
+ *
+ * The revocation lists are installed with `ecdaa_verify_cache_ZZZ_set_revocations`
+ * (a new cache starts with empty lists). Their contents are hashed only then,
+ * and when `ecdaa_verify_cache_ZZZ_revocations_changed` is called, not on every lookup.
+ * So a result is only returned for lists with the contents it was verified against,
+ * as long as `ecdaa_verify_cache_ZZZ_revocations_changed` is called
+ * whenever an installed list is modified in place.
+ */
+struct ecdaa_verify_cache_ZZZ;
+
+struct ecdaa_verify_cache_stats_ZZZ {
+    uint64_t hits;
+    uint64_t misses;
+};
+
+/*
+ * Create an empty cache, holding up to `capacity` results.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `capacity` is 0
+ * -3 on allocation failure
+ */
+int ecdaa_verify_cache_ZZZ_new(struct ecdaa_verify_cache_ZZZ **cache_out,
+                               size_t capacity);
+
+/*
+ * Free the cache (NULL is ignored).
+ */
+void ecdaa_verify_cache_ZZZ_free(struct ecdaa_verify_cache_ZZZ *cache);
+
+/*
+ * Install the revocation lists that `ecdaa_verify_cache_ZZZ_deserialize_and_verify` checks,
+ * and hash their contents.
+ *
+ * `revocations` itself is copied, but the lists it points to aren't:
+ * they must stay valid until other lists are installed, or the cache is freed.
+ * Results cached for earlier lists are returned again if lists with the same contents are installed.
+ */
+void ecdaa_verify_cache_ZZZ_set_revocations(struct ecdaa_verify_cache_ZZZ *cache,
+                                             struct ecdaa_revocations_ZZZ *revocations);
+
+/*
+ * Same as `ecdaa_signature_ZZZ_deserialize_and_verify`, using the cache's revocation lists,
+ * but returns the cached result if this signature was already verified
+ * (with the same group public key, message, basename, and revocation list contents).
+ *
+ * On a miss, the signature is verified and its result (valid or not) is cached.
+ *
+ * The de-serialized signature isn't output
+ *  (cf. `ecdaa_signature_ZZZ_access_pseudonym_in_serialized` for the pseudonym).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if signature is mal-formed
+ * -2 if signature is not valid
+ */
+int ecdaa_verify_cache_ZZZ_deserialize_and_verify(struct ecdaa_verify_cache_ZZZ *cache,
+                                                  struct ecdaa_group_public_key_ZZZ *gpk,
+                                                  uint8_t *signature_buffer,
+                                                  uint8_t *message_buffer,
+                                                  uint32_t message_len,
+                                                  uint8_t *basename,
+                                                  uint32_t basename_len,
+                                                  int has_nym);
+
+/*
+ * Re-hash the installed revocation lists.
+ *
+ * Call this after modifying the installed lists in place.
+ * Lists must not be modified while verifications are in progress,
+ * since those cache their results under the digest taken when they started.
+ */
+void ecdaa_verify_cache_ZZZ_revocations_changed(struct ecdaa_verify_cache_ZZZ *cache);
+
+/*
+ * Copy the cache's cumulative hit and miss counts into `stats_out`.
+ */
+void ecdaa_verify_cache_ZZZ_stats(struct ecdaa_verify_cache_stats_ZZZ *stats_out,
+                                  struct ecdaa_verify_cache_ZZZ *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
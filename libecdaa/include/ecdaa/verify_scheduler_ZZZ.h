@@ -0,0 +1,127 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_VERIFY_SCHEDULER_ZZZ_H
+#define ECDAA_VERIFY_SCHEDULER_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ecdaa_signature_ZZZ;
+struct ecdaa_group_public_key_ZZZ;
+struct ecdaa_revocations_ZZZ;
+
+/*
+ * Called when a verify job completes, with its result
+ *  (as returned by `ecdaa_signature_ZZZ_verify`).
+ *
+ * Runs on a worker thread.
+ */
+typedef void (*ecdaa_verify_callback_ZZZ)(int result, void *user_data);
+
+/*
+ * A signature to verify, with the same inputs as `ecdaa_signature_ZZZ_verify`.
+ *
+ * The job, and everything it points to, must stay valid until the job completes.
+ */
+struct ecdaa_verify_job_ZZZ {
+    struct ecdaa_signature_ZZZ *signature;
+    struct ecdaa_group_public_key_ZZZ *gpk;
+    struct ecdaa_revocations_ZZZ *revocations;
+    uint8_t *message;
+    uint32_t message_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+
+    // Optional (may be NULL)
+    ecdaa_verify_callback_ZZZ callback;
+    void *user_data;
+
+    // Set by the scheduler
+    int result;
+    int done;
+};
+
+/*
+ * Secret key revocation lists longer than this are split into chunks of this many entries,
+ * which are checked in parallel with each other and with the signature's pairings.
+ */
+#define ECDAA_VERIFY_SCHEDULER_SK_CHUNK_LENGTH 32
+
+/*
+ * Pool of worker threads verifying signatures.
+ *
+ * Each job is split into independent tasks (the Schnorr and pairing checks,
+ * and one per chunk of the secret key revocation list),
+ * which idle workers steal from busy ones.
+ * So many small jobs keep every worker busy,
+ * and one job with a long revocation list is spread across all of them.
+ */
+struct ecdaa_verify_scheduler_ZZZ;
+
+/*
+ * Start a scheduler with `num_threads` workers (or one per online CPU, if 0).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the worker threads can't be started
+ * -3 on allocation failure
+ */
+int ecdaa_verify_scheduler_ZZZ_new(struct ecdaa_verify_scheduler_ZZZ **scheduler_out,
+                                   size_t num_threads);
+
+/*
+ * Wait for every submitted job to complete, then stop the workers and free the scheduler
+ *  (NULL is ignored).
+ */
+void ecdaa_verify_scheduler_ZZZ_free(struct ecdaa_verify_scheduler_ZZZ *scheduler);
+
+/*
+ * Queue `job` for verification, and return immediately.
+ *
+ * On completion, `job->result` and `job->done` are set, and then `job->callback` (if any) is called.
+ *
+ * Returns:
+ * 0 on success
+ * -3 on allocation failure (the job is not queued)
+ */
+int ecdaa_verify_scheduler_ZZZ_submit(struct ecdaa_verify_scheduler_ZZZ *scheduler,
+                                      struct ecdaa_verify_job_ZZZ *job);
+
+/*
+ * Block until `job` (which must have been submitted to `scheduler`) completes.
+ *
+ * Once this returns, the job may be freed or re-submitted
+ *  (though its callback may still be running).
+ *
+ * Returns:
+ * the job's result (0 if the signature is valid, -1 if not)
+ */
+int ecdaa_verify_scheduler_ZZZ_wait(struct ecdaa_verify_scheduler_ZZZ *scheduler,
+                                    struct ecdaa_verify_job_ZZZ *job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
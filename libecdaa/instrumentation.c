@@ -0,0 +1,106 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa/instrumentation.h>
+
+#include "internal-utilities/instrumentation.h"
+
+#include <stddef.h>
+
+static const char *event_names[ECDAA_INSTRUMENTATION_EVENT_COUNT] = {
+    "pairing",
+    "ecp_mul",
+    "ecp2_mul",
+    "hash_to_curve",
+    "ecp_subgroup_check",
+    "ecp2_subgroup_check",
+    "sk_revocation_scan",
+    "bsn_revocation_scan",
+};
+
+const char *ecdaa_instrumentation_event_name(enum ecdaa_instrumentation_event event)
+{
+    if ((unsigned)event >= ECDAA_INSTRUMENTATION_EVENT_COUNT)
+        return NULL;
+
+    return event_names[event];
+}
+
+#ifdef ECDAA_INSTRUMENTATION
+
+// The counters and callback live with the instrumented code in common/internal-utilities
+
+int ecdaa_instrumentation_enabled(void)
+{
+    return 1;
+}
+
+int ecdaa_instrumentation_get(struct ecdaa_instrumentation_counter *counter_out,
+                              enum ecdaa_instrumentation_event event)
+{
+    if ((unsigned)event >= ECDAA_INSTRUMENTATION_EVENT_COUNT)
+        return -1;
+
+    ecdaa_instrumentation_load(counter_out, event);
+
+    return 0;
+}
+
+void ecdaa_instrumentation_reset(void)
+{
+    ecdaa_instrumentation_clear();
+}
+
+int ecdaa_instrumentation_set_callback(ecdaa_instrumentation_callback callback,
+                                       void *user_data)
+{
+    ecdaa_instrumentation_register(callback, user_data);
+
+    return 0;
+}
+
+#else
+
+int ecdaa_instrumentation_enabled(void)
+{
+    return 0;
+}
+
+int ecdaa_instrumentation_get(struct ecdaa_instrumentation_counter *counter_out,
+                              enum ecdaa_instrumentation_event event)
+{
+    (void)counter_out;
+    (void)event;
+
+    return -1;
+}
+
+void ecdaa_instrumentation_reset(void)
+{
+}
+
+int ecdaa_instrumentation_set_callback(ecdaa_instrumentation_callback callback,
+                                       void *user_data)
+{
+    (void)callback;
+    (void)user_data;
+
+    return -1;
+}
+
+#endif
@@ -47,8 +47,8 @@ int ecdaa_issuer_key_pair_ZZZ_generate(struct ecdaa_issuer_public_key_ZZZ *pk,
     // 1) G2 generator raised to the two private key random Bignums...
     ecp2_ZZZ_set_to_generator(&pk->gpk.X);
     ecp2_ZZZ_set_to_generator(&pk->gpk.Y);
-    ECP2_ZZZ_mul(&pk->gpk.X, sk->x);
-    ECP2_ZZZ_mul(&pk->gpk.Y, sk->y);
+    ecp2_ZZZ_mul_gls(&pk->gpk.X, sk->x);
+    ecp2_ZZZ_mul_gls(&pk->gpk.Y, sk->y);
 
     // 2) and a Schnorr-type signature to prove our knowledge of those two random Bignums.
     int sign_ret = issuer_schnorr_sign_ZZZ(&pk->c, &pk->sx, &pk->sy, &pk->gpk.X, &pk->gpk.Y, sk->x, sk->y, get_random);
@@ -0,0 +1,453 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa/member_bundle_ZZZ.h>
+
+#include <ecdaa/basename_session_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/util/errors.h>
+#include <ecdaa/util/file_io.h>
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+#include "internal-utilities/explicit_bzero.h"
+
+#include <amcl/amcl.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAGIC "EDMB"
+#define MAGIC_LENGTH 4
+#define HEADER_LENGTH (MAGIC_LENGTH + 1 + 4)
+#define CHECKSUM_LENGTH 32
+// Entry 0 of a session's table is the point at infinity, so it isn't stored
+#define SESSION_POINTS (2 + ECDAA_BASENAME_SESSION_ZZZ_TABLE_SIZE - 1)
+#define SESSION_LENGTH(basename_len) (4 + (size_t)(basename_len) + SESSION_POINTS*ECP_ZZZ_LENGTH)
+
+struct ecdaa_member_bundle_ZZZ {
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_group_public_key_ZZZ gpk;
+    size_t num_sessions;
+    // Each session is allocated separately, so pointers to it stay valid as sessions are added.
+    // Each session's basename is owned by the bundle.
+    struct ecdaa_basename_session_ZZZ **sessions;
+};
+
+static int append_session(struct ecdaa_member_bundle_ZZZ *bundle,
+                          const uint8_t *basename,
+                          uint32_t basename_len,
+                          struct ecdaa_basename_session_ZZZ **session_out);
+
+static void compute_checksum(uint8_t *checksum_out,
+                             const uint8_t *buffer,
+                             size_t buffer_len);
+
+static void write_uint32(uint8_t *buffer_out, uint32_t value);
+
+static uint32_t read_uint32(const uint8_t *buffer);
+
+int ecdaa_member_bundle_ZZZ_new(struct ecdaa_member_bundle_ZZZ **bundle_out,
+                                struct ecdaa_member_secret_key_ZZZ *sk,
+                                struct ecdaa_credential_ZZZ *cred,
+                                struct ecdaa_group_public_key_ZZZ *gpk)
+{
+    struct ecdaa_member_bundle_ZZZ *bundle = malloc(sizeof(struct ecdaa_member_bundle_ZZZ));
+    if (NULL == bundle)
+        return -3;
+
+    bundle->sk = *sk;
+    bundle->cred = *cred;
+    bundle->gpk = *gpk;
+    bundle->num_sessions = 0;
+    bundle->sessions = NULL;
+
+    *bundle_out = bundle;
+
+    return 0;
+}
+
+void ecdaa_member_bundle_ZZZ_free(struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    if (NULL == bundle)
+        return;
+
+    for (size_t i = 0; i < bundle->num_sessions; i++) {
+        free((uint8_t*)bundle->sessions[i]->basename);
+        free(bundle->sessions[i]);
+    }
+    free(bundle->sessions);
+
+    explicit_bzero(&bundle->sk, sizeof(bundle->sk));
+    free(bundle);
+}
+
+int ecdaa_member_bundle_ZZZ_add_basename(struct ecdaa_member_bundle_ZZZ *bundle,
+                                         const uint8_t *basename,
+                                         uint32_t basename_len,
+                                         ecdaa_rand_func get_random)
+{
+    if (0 == basename_len || NULL != ecdaa_member_bundle_ZZZ_find_session(bundle, basename, basename_len))
+        return -1;
+
+    struct ecdaa_basename_session_ZZZ *session;
+    int ret = append_session(bundle, basename, basename_len, &session);
+    if (0 != ret)
+        return ret;
+
+    // The session points at the bundle's copy of the basename
+    if (0 != ecdaa_basename_session_ZZZ_init(session, session->basename, basename_len, &bundle->sk, get_random)) {
+        free((uint8_t*)session->basename);
+        free(session);
+        bundle->num_sessions--;
+        return -1;
+    }
+
+    return 0;
+}
+
+struct ecdaa_member_secret_key_ZZZ *ecdaa_member_bundle_ZZZ_secret_key(struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    return &bundle->sk;
+}
+
+struct ecdaa_credential_ZZZ *ecdaa_member_bundle_ZZZ_credential(struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    return &bundle->cred;
+}
+
+struct ecdaa_group_public_key_ZZZ *ecdaa_member_bundle_ZZZ_group_public_key(struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    return &bundle->gpk;
+}
+
+struct ecdaa_basename_session_ZZZ *ecdaa_member_bundle_ZZZ_find_session(struct ecdaa_member_bundle_ZZZ *bundle,
+                                                                        const uint8_t *basename,
+                                                                        uint32_t basename_len)
+{
+    for (size_t i = 0; i < bundle->num_sessions; i++) {
+        struct ecdaa_basename_session_ZZZ *session = bundle->sessions[i];
+        if (basename_len == session->basename_len && 0 == memcmp(basename, session->basename, basename_len))
+            return session;
+    }
+
+    return NULL;
+}
+
+int ecdaa_member_bundle_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
+                                 const uint8_t *message,
+                                 uint32_t message_len,
+                                 const uint8_t *basename,
+                                 uint32_t basename_len,
+                                 struct ecdaa_member_bundle_ZZZ *bundle,
+                                 ecdaa_rand_func get_random)
+{
+    if (0 != basename_len) {
+        struct ecdaa_basename_session_ZZZ *session = ecdaa_member_bundle_ZZZ_find_session(bundle, basename, basename_len);
+        if (NULL != session)
+            return ecdaa_signature_ZZZ_sign_with_session(signature_out, message, message_len, session, &bundle->sk, &bundle->cred, get_random);
+    }
+
+    return ecdaa_signature_ZZZ_sign(signature_out, message, message_len, basename, basename_len, &bundle->sk, &bundle->cred, get_random);
+}
+
+size_t ecdaa_member_bundle_ZZZ_length(struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    size_t length = HEADER_LENGTH
+        + ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH
+        + ECDAA_CREDENTIAL_ZZZ_LENGTH
+        + ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH
+        + CHECKSUM_LENGTH;
+
+    for (size_t i = 0; i < bundle->num_sessions; i++)
+        length += SESSION_LENGTH(bundle->sessions[i]->basename_len);
+
+    return length;
+}
+
+void ecdaa_member_bundle_ZZZ_serialize(uint8_t *buffer_out,
+                                       struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    uint8_t *current = buffer_out;
+
+    memcpy(current, MAGIC, MAGIC_LENGTH);
+    current[MAGIC_LENGTH] = ECDAA_MEMBER_BUNDLE_ZZZ_VERSION;
+    write_uint32(current + MAGIC_LENGTH + 1, (uint32_t)bundle->num_sessions);
+    current += HEADER_LENGTH;
+
+    ecdaa_member_secret_key_ZZZ_serialize(current, &bundle->sk);
+    current += ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH;
+
+    ecdaa_credential_ZZZ_serialize(current, &bundle->cred);
+    current += ECDAA_CREDENTIAL_ZZZ_LENGTH;
+
+    ecdaa_group_public_key_ZZZ_serialize(current, &bundle->gpk);
+    current += ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH;
+
+    for (size_t i = 0; i < bundle->num_sessions; i++) {
+        struct ecdaa_basename_session_ZZZ *session = bundle->sessions[i];
+
+        write_uint32(current, session->basename_len);
+        current += 4;
+        memcpy(current, session->basename, session->basename_len);
+        current += session->basename_len;
+
+        ecp_ZZZ_serialize(current, &session->P2);
+        current += ECP_ZZZ_LENGTH;
+        ecp_ZZZ_serialize(current, &session->K);
+        current += ECP_ZZZ_LENGTH;
+        for (size_t j = 1; j < ECDAA_BASENAME_SESSION_ZZZ_TABLE_SIZE; j++) {
+            ecp_ZZZ_serialize(current, &session->P2_table[j]);
+            current += ECP_ZZZ_LENGTH;
+        }
+    }
+
+    compute_checksum(current, buffer_out, (size_t)(current - buffer_out));
+}
+
+int ecdaa_member_bundle_ZZZ_serialize_file(const char *file,
+                                           struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    size_t length = ecdaa_member_bundle_ZZZ_length(bundle);
+    uint8_t *buffer = malloc(length);
+    if (NULL == buffer)
+        return WRITE_TO_FILE_ERROR;
+
+    ecdaa_member_bundle_ZZZ_serialize(buffer, bundle);
+    int write_ret = ecdaa_write_buffer_to_file(file, buffer, length);
+
+    explicit_bzero(buffer, length);
+    free(buffer);
+
+    if ((int)length != write_ret)
+        return WRITE_TO_FILE_ERROR;
+
+    return SUCCESS;
+}
+
+int ecdaa_member_bundle_ZZZ_deserialize(struct ecdaa_member_bundle_ZZZ **bundle_out,
+                                        const uint8_t *buffer,
+                                        size_t buffer_len)
+{
+    size_t fixed_length = HEADER_LENGTH
+        + ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH
+        + ECDAA_CREDENTIAL_ZZZ_LENGTH
+        + ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH
+        + CHECKSUM_LENGTH;
+
+    // 1) Check the header and checksum, before parsing anything
+    if (buffer_len < fixed_length)
+        return -1;
+
+    if (0 != memcmp(buffer, MAGIC, MAGIC_LENGTH) || ECDAA_MEMBER_BUNDLE_ZZZ_VERSION != buffer[MAGIC_LENGTH])
+        return -1;
+
+    uint8_t checksum[CHECKSUM_LENGTH];
+    compute_checksum(checksum, buffer, buffer_len - CHECKSUM_LENGTH);
+    if (0 != memcmp(checksum, buffer + buffer_len - CHECKSUM_LENGTH, CHECKSUM_LENGTH))
+        return -1;
+
+    uint32_t num_sessions = read_uint32(buffer + MAGIC_LENGTH + 1);
+    const uint8_t *current = buffer + HEADER_LENGTH;
+    const uint8_t *end = buffer + buffer_len - CHECKSUM_LENGTH;
+
+    // 2) Keys and credential (their subgroup checks were done before they were bundled)
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_group_public_key_ZZZ gpk;
+    int ret = 0;
+
+    ecdaa_member_secret_key_ZZZ_deserialize(&sk, (uint8_t*)current);
+    current += ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH;
+
+    ECP_ZZZ *cred_points[] = {&cred.A, &cred.B, &cred.C, &cred.D};
+    for (size_t i = 0; i < 4; i++) {
+        if (0 != ecp_ZZZ_deserialize_trusted(cred_points[i], (uint8_t*)current))
+            ret = -1;
+        current += ECP_ZZZ_LENGTH;
+    }
+
+    if (0 != ecp2_ZZZ_deserialize_trusted(&gpk.X, (uint8_t*)current))
+        ret = -1;
+    current += ECP2_ZZZ_LENGTH;
+    if (0 != ecp2_ZZZ_deserialize_trusted(&gpk.Y, (uint8_t*)current))
+        ret = -1;
+    current += ECP2_ZZZ_LENGTH;
+
+    struct ecdaa_member_bundle_ZZZ *bundle = NULL;
+    if (0 == ret)
+        ret = ecdaa_member_bundle_ZZZ_new(&bundle, &sk, &cred, &gpk);
+    explicit_bzero(&sk, sizeof(sk));
+    if (0 != ret)
+        return ret;
+
+    // 3) Basename sessions, read back as stored
+    for (uint32_t i = 0; i < num_sessions && 0 == ret; i++) {
+        if ((size_t)(end - current) < 4) {
+            ret = -1;
+            break;
+        }
+        uint32_t basename_len = read_uint32(current);
+        current += 4;
+
+        // Checked in two steps, so a huge basename_len can't wrap the sum on 32-bit
+        if (0 == basename_len || basename_len > (size_t)(end - current)) {
+            ret = -1;
+            break;
+        }
+        if ((size_t)(end - current) - basename_len < SESSION_POINTS*ECP_ZZZ_LENGTH) {
+            ret = -1;
+            break;
+        }
+
+        struct ecdaa_basename_session_ZZZ *session;
+        ret = append_session(bundle, current, basename_len, &session);
+        if (0 != ret)
+            break;
+        current += basename_len;
+
+        if (0 != ecp_ZZZ_deserialize_trusted(&session->P2, (uint8_t*)current))
+            ret = -1;
+        current += ECP_ZZZ_LENGTH;
+        if (0 != ecp_ZZZ_deserialize_trusted(&session->K, (uint8_t*)current))
+            ret = -1;
+        current += ECP_ZZZ_LENGTH;
+        ECP_ZZZ_inf(&session->P2_table[0]);
+        for (size_t j = 1; j < ECDAA_BASENAME_SESSION_ZZZ_TABLE_SIZE; j++) {
+            if (0 != ecp_ZZZ_deserialize_trusted(&session->P2_table[j], (uint8_t*)current))
+                ret = -1;
+            current += ECP_ZZZ_LENGTH;
+        }
+    }
+
+    if (0 == ret && current != end)
+        ret = -1;
+
+    if (0 != ret) {
+        ecdaa_member_bundle_ZZZ_free(bundle);
+        return ret;
+    }
+
+    *bundle_out = bundle;
+
+    return 0;
+}
+
+int ecdaa_member_bundle_ZZZ_deserialize_file(struct ecdaa_member_bundle_ZZZ **bundle_out,
+                                             const char *file)
+{
+    FILE *fp = fopen(file, "rb");
+    if (NULL == fp)
+        return READ_FROM_FILE_ERROR;
+
+    long length = -1;
+    if (0 == fseek(fp, 0, SEEK_END))
+        length = ftell(fp);
+    if (length <= 0 || 0 != fseek(fp, 0, SEEK_SET)) {
+        fclose(fp);
+        return READ_FROM_FILE_ERROR;
+    }
+
+    uint8_t *buffer = malloc((size_t)length);
+    if (NULL == buffer) {
+        fclose(fp);
+        return READ_FROM_FILE_ERROR;
+    }
+
+    // The whole bundle in one read
+    int read_ret = ecdaa_read_from_fp(buffer, (size_t)length, fp);
+    if (0 != fclose(fp))
+        read_ret = READ_FROM_FILE_ERROR;
+
+    int ret = SUCCESS;
+    if (length != read_ret)
+        ret = READ_FROM_FILE_ERROR;
+    else if (0 != ecdaa_member_bundle_ZZZ_deserialize(bundle_out, buffer, (size_t)length))
+        ret = DESERIALIZE_KEY_ERROR;
+
+    explicit_bzero(buffer, (size_t)length);
+    free(buffer);
+
+    return ret;
+}
+
+static int append_session(struct ecdaa_member_bundle_ZZZ *bundle,
+                          const uint8_t *basename,
+                          uint32_t basename_len,
+                          struct ecdaa_basename_session_ZZZ **session_out)
+{
+    uint8_t *basename_copy = malloc(basename_len);
+    if (NULL == basename_copy)
+        return -3;
+    memcpy(basename_copy, basename, basename_len);
+
+    struct ecdaa_basename_session_ZZZ *session = malloc(sizeof(struct ecdaa_basename_session_ZZZ));
+    if (NULL == session) {
+        free(basename_copy);
+        return -3;
+    }
+
+    // Only the array of pointers moves, never the sessions themselves
+    struct ecdaa_basename_session_ZZZ **sessions = realloc(bundle->sessions,
+                                                           (bundle->num_sessions + 1) * sizeof(struct ecdaa_basename_session_ZZZ*));
+    if (NULL == sessions) {
+        free(session);
+        free(basename_copy);
+        return -3;
+    }
+    bundle->sessions = sessions;
+
+    bundle->sessions[bundle->num_sessions++] = session;
+    session->basename = basename_copy;
+    session->basename_len = basename_len;
+
+    *session_out = session;
+
+    return 0;
+}
+
+static void compute_checksum(uint8_t *checksum_out,
+                             const uint8_t *buffer,
+                             size_t buffer_len)
+{
+    hash256 hash;
+    HASH256_init(&hash);
+    for (size_t i = 0; i < buffer_len; i++)
+        HASH256_process(&hash, buffer[i]);
+    HASH256_hash(&hash, (char*)checksum_out);
+}
+
+static void write_uint32(uint8_t *buffer_out, uint32_t value)
+{
+    for (size_t i = 0; i < 4; i++)
+        buffer_out[i] = (uint8_t)(value >> (24 - 8*i));
+}
+
+static uint32_t read_uint32(const uint8_t *buffer)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++)
+        value = (value << 8) | buffer[i];
+
+    return value;
+}
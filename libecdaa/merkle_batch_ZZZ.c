@@ -0,0 +1,349 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa/merkle_batch_ZZZ.h>
+
+#include <ecdaa/signature_ZZZ.h>
+
+#include <amcl/amcl.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIGEST_LENGTH ECDAA_MERKLE_BATCH_ZZZ_DIGEST_LENGTH
+#define MAX_LEVELS (ECDAA_MERKLE_BATCH_ZZZ_MAX_DEPTH + 1)
+
+// Prefixed to the root before signing,
+// so a batch signature can't pass as a signature over an ordinary message
+#define DOMAIN_TAG "ECDAA-MERKLE-BATCH"
+#define DOMAIN_TAG_LENGTH (sizeof(DOMAIN_TAG) - 1)
+#define SIGNED_MESSAGE_LENGTH (DOMAIN_TAG_LENGTH + DIGEST_LENGTH + 4)
+
+#define LEAF_PREFIX 0x00
+#define NODE_PREFIX 0x01
+
+static void hash_leaf(uint8_t *digest_out,
+                      const uint8_t *message,
+                      uint32_t message_len);
+
+static void hash_node(uint8_t *digest_out,
+                      const uint8_t *left,
+                      const uint8_t *right);
+
+static uint32_t next_width(uint32_t width);
+
+static uint32_t count_siblings(uint32_t message_index, uint32_t num_messages);
+
+static void encode_signed_message(uint8_t *message_out,
+                                  struct ecdaa_merkle_batch_ZZZ *batch);
+
+static void write_uint32(uint8_t *buffer_out, uint32_t value);
+
+static uint32_t read_uint32(const uint8_t *buffer);
+
+size_t ecdaa_merkle_batch_ZZZ_length(void)
+{
+    return ECDAA_MERKLE_BATCH_ZZZ_LENGTH;
+}
+
+size_t ecdaa_merkle_batch_ZZZ_with_nym_length(void)
+{
+    return ECDAA_MERKLE_BATCH_ZZZ_WITH_NYM_LENGTH;
+}
+
+size_t ecdaa_merkle_proof_ZZZ_length(struct ecdaa_merkle_proof_ZZZ *proof)
+{
+    return 8 + (size_t)proof->num_siblings * DIGEST_LENGTH;
+}
+
+int ecdaa_merkle_batch_ZZZ_sign(struct ecdaa_merkle_batch_ZZZ *batch_out,
+                                struct ecdaa_merkle_proof_ZZZ *proofs_out,
+                                uint8_t* const *messages,
+                                const uint32_t *message_lens,
+                                uint32_t num_messages,
+                                const uint8_t* basename,
+                                uint32_t basename_len,
+                                struct ecdaa_member_secret_key_ZZZ *sk,
+                                struct ecdaa_credential_ZZZ *cred,
+                                ecdaa_rand_func get_random)
+{
+    if (0 == num_messages)
+        return -1;
+
+    // The levels are stored back-to-back, from the leaves up to the root
+    size_t level_offsets[MAX_LEVELS];
+    uint32_t level_widths[MAX_LEVELS];
+    size_t num_levels = 0;
+    size_t num_nodes = 0;
+    uint32_t width = num_messages;
+    while (1) {
+        level_offsets[num_levels] = num_nodes;
+        level_widths[num_levels] = width;
+        num_levels++;
+        num_nodes += width;
+
+        if (1 == width)
+            break;
+        width = next_width(width);
+    }
+
+    if (num_nodes > SIZE_MAX / DIGEST_LENGTH)
+        return -3;
+    uint8_t (*nodes)[DIGEST_LENGTH] = malloc(num_nodes * DIGEST_LENGTH);
+    if (NULL == nodes)
+        return -3;
+
+    // 1) Build the tree
+    for (uint32_t i = 0; i < num_messages; i++)
+        hash_leaf(nodes[i], messages[i], message_lens[i]);
+
+    for (size_t level = 1; level < num_levels; level++) {
+        uint8_t (*children)[DIGEST_LENGTH] = nodes + level_offsets[level - 1];
+        uint8_t (*parents)[DIGEST_LENGTH] = nodes + level_offsets[level];
+        uint64_t num_children = level_widths[level - 1];
+
+        for (uint64_t i = 0; i < level_widths[level]; i++) {
+            if (2*i + 1 < num_children)
+                hash_node(parents[i], children[2*i], children[2*i + 1]);
+            else
+                memcpy(parents[i], children[2*i], DIGEST_LENGTH);
+        }
+    }
+
+    // 2) Collect each message's path
+    for (uint32_t i = 0; i < num_messages; i++) {
+        struct ecdaa_merkle_proof_ZZZ *proof = &proofs_out[i];
+        proof->message_index = i;
+        proof->num_messages = num_messages;
+        proof->num_siblings = 0;
+
+        uint32_t index = i;
+        for (size_t level = 0; level + 1 < num_levels; level++) {
+            uint32_t sibling = index ^ 1;
+            if (sibling < level_widths[level]) {
+                memcpy(proof->siblings[proof->num_siblings], nodes[level_offsets[level] + sibling], DIGEST_LENGTH);
+                proof->num_siblings++;
+            }
+            index >>= 1;
+        }
+    }
+
+    memcpy(batch_out->root, nodes[num_nodes - 1], DIGEST_LENGTH);
+    batch_out->num_messages = num_messages;
+
+    free(nodes);
+
+    // 3) Sign the root
+    uint8_t signed_message[SIGNED_MESSAGE_LENGTH];
+    encode_signed_message(signed_message, batch_out);
+
+    if (0 != ecdaa_signature_ZZZ_sign(&batch_out->signature, signed_message, sizeof(signed_message), basename, basename_len, sk, cred, get_random))
+        return -1;
+
+    return 0;
+}
+
+int ecdaa_merkle_batch_ZZZ_verify(struct ecdaa_merkle_batch_ZZZ *batch,
+                                  struct ecdaa_group_public_key_ZZZ *gpk,
+                                  struct ecdaa_revocations_ZZZ *revocations,
+                                  uint8_t *basename,
+                                  uint32_t basename_len)
+{
+    if (0 == batch->num_messages)
+        return -1;
+
+    uint8_t signed_message[SIGNED_MESSAGE_LENGTH];
+    encode_signed_message(signed_message, batch);
+
+    return ecdaa_signature_ZZZ_verify(&batch->signature, gpk, revocations, signed_message, sizeof(signed_message), basename, basename_len);
+}
+
+int ecdaa_merkle_batch_ZZZ_verify_message(struct ecdaa_merkle_batch_ZZZ *batch,
+                                          struct ecdaa_merkle_proof_ZZZ *proof,
+                                          uint8_t *message,
+                                          uint32_t message_len)
+{
+    if (proof->num_messages != batch->num_messages || proof->message_index >= proof->num_messages)
+        return -1;
+
+    if (proof->num_siblings > ECDAA_MERKLE_BATCH_ZZZ_MAX_DEPTH)
+        return -1;
+
+    uint8_t digest[DIGEST_LENGTH];
+    hash_leaf(digest, message, message_len);
+
+    uint32_t index = proof->message_index;
+    uint32_t width = proof->num_messages;
+    uint32_t siblings_used = 0;
+    while (width > 1) {
+        if ((index ^ 1) < width) {
+            if (siblings_used == proof->num_siblings)
+                return -1;
+
+            if (index & 1)
+                hash_node(digest, proof->siblings[siblings_used], digest);
+            else
+                hash_node(digest, digest, proof->siblings[siblings_used]);
+            siblings_used++;
+        }
+
+        index >>= 1;
+        width = next_width(width);
+    }
+
+    if (siblings_used != proof->num_siblings)
+        return -1;
+
+    if (0 != memcmp(digest, batch->root, DIGEST_LENGTH))
+        return -1;
+
+    return 0;
+}
+
+void ecdaa_merkle_batch_ZZZ_serialize(uint8_t *buffer_out,
+                                      struct ecdaa_merkle_batch_ZZZ *batch,
+                                      int has_nym)
+{
+    memcpy(buffer_out, batch->root, DIGEST_LENGTH);
+    write_uint32(buffer_out + DIGEST_LENGTH, batch->num_messages);
+    ecdaa_signature_ZZZ_serialize(buffer_out + DIGEST_LENGTH + 4, &batch->signature, has_nym);
+}
+
+int ecdaa_merkle_batch_ZZZ_deserialize(struct ecdaa_merkle_batch_ZZZ *batch_out,
+                                       uint8_t *buffer_in,
+                                       int has_nym)
+{
+    int ret = 0;
+
+    memcpy(batch_out->root, buffer_in, DIGEST_LENGTH);
+
+    batch_out->num_messages = read_uint32(buffer_in + DIGEST_LENGTH);
+    if (0 == batch_out->num_messages)
+        ret = -1;
+
+    if (0 != ecdaa_signature_ZZZ_deserialize(&batch_out->signature, buffer_in + DIGEST_LENGTH + 4, has_nym))
+        ret = -1;
+
+    return ret;
+}
+
+size_t ecdaa_merkle_proof_ZZZ_serialize(uint8_t *buffer_out,
+                                        struct ecdaa_merkle_proof_ZZZ *proof)
+{
+    write_uint32(buffer_out, proof->message_index);
+    write_uint32(buffer_out + 4, proof->num_messages);
+    memcpy(buffer_out + 8, proof->siblings, (size_t)proof->num_siblings * DIGEST_LENGTH);
+
+    return ecdaa_merkle_proof_ZZZ_length(proof);
+}
+
+int ecdaa_merkle_proof_ZZZ_deserialize(struct ecdaa_merkle_proof_ZZZ *proof_out,
+                                       uint8_t *buffer_in,
+                                       size_t buffer_len)
+{
+    if (buffer_len < 8)
+        return -1;
+
+    proof_out->message_index = read_uint32(buffer_in);
+    proof_out->num_messages = read_uint32(buffer_in + 4);
+    if (0 == proof_out->num_messages || proof_out->message_index >= proof_out->num_messages)
+        return -1;
+
+    // The number of siblings is fixed by the message's position, so the length must match exactly
+    proof_out->num_siblings = count_siblings(proof_out->message_index, proof_out->num_messages);
+    if (buffer_len != ecdaa_merkle_proof_ZZZ_length(proof_out))
+        return -1;
+
+    memcpy(proof_out->siblings, buffer_in + 8, (size_t)proof_out->num_siblings * DIGEST_LENGTH);
+
+    return 0;
+}
+
+static void hash_leaf(uint8_t *digest_out,
+                      const uint8_t *message,
+                      uint32_t message_len)
+{
+    hash256 hash;
+    HASH256_init(&hash);
+    HASH256_process(&hash, LEAF_PREFIX);
+    for (uint32_t i = 0; i < message_len; i++)
+        HASH256_process(&hash, message[i]);
+    HASH256_hash(&hash, (char*)digest_out);
+}
+
+static void hash_node(uint8_t *digest_out,
+                      const uint8_t *left,
+                      const uint8_t *right)
+{
+    // `digest_out` may alias `left` or `right`: both are consumed before it's written
+    hash256 hash;
+    HASH256_init(&hash);
+    HASH256_process(&hash, NODE_PREFIX);
+    for (size_t i = 0; i < DIGEST_LENGTH; i++)
+        HASH256_process(&hash, left[i]);
+    for (size_t i = 0; i < DIGEST_LENGTH; i++)
+        HASH256_process(&hash, right[i]);
+    HASH256_hash(&hash, (char*)digest_out);
+}
+
+static uint32_t next_width(uint32_t width)
+{
+    // Written this way so it can't overflow
+    return width / 2 + (width & 1);
+}
+
+static uint32_t count_siblings(uint32_t message_index, uint32_t num_messages)
+{
+    uint32_t num_siblings = 0;
+
+    uint32_t index = message_index;
+    uint32_t width = num_messages;
+    while (width > 1) {
+        if ((index ^ 1) < width)
+            num_siblings++;
+
+        index >>= 1;
+        width = next_width(width);
+    }
+
+    return num_siblings;
+}
+
+static void encode_signed_message(uint8_t *message_out,
+                                  struct ecdaa_merkle_batch_ZZZ *batch)
+{
+    memcpy(message_out, DOMAIN_TAG, DOMAIN_TAG_LENGTH);
+    memcpy(message_out + DOMAIN_TAG_LENGTH, batch->root, DIGEST_LENGTH);
+    write_uint32(message_out + DOMAIN_TAG_LENGTH + DIGEST_LENGTH, batch->num_messages);
+}
+
+static void write_uint32(uint8_t *buffer_out, uint32_t value)
+{
+    for (size_t i = 0; i < 4; i++)
+        buffer_out[i] = (uint8_t)(value >> (24 - 8*i));
+}
+
+static uint32_t read_uint32(const uint8_t *buffer)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++)
+        value = (value << 8) | buffer[i];
+
+    return value;
+}
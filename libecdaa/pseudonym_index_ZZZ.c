@@ -0,0 +1,352 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ecdaa/pseudonym_index_ZZZ.h>
+
+#include "amcl-extensions/ecp_ZZZ.h"
+
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define INITIAL_CAPACITY 64
+
+struct pseudonym_entry {
+    int used;
+    uint8_t pseudonym[ECP_ZZZ_LENGTH];
+    struct ecdaa_pseudonym_record_ZZZ record;
+};
+
+// Open-addressing hash table (linear probing), with a power-of-two capacity
+// that's doubled before the load factor exceeds 0.7.
+struct ecdaa_pseudonym_index_ZZZ {
+    pthread_rwlock_t lock;
+    struct pseudonym_entry *entries;
+    size_t capacity;
+    size_t size;
+    int log_fd;         // -1 if not logging
+    int log_failed;     // Set if a partly-written record couldn't be removed
+};
+
+static uint64_t hash_pseudonym(const uint8_t *pseudonym);
+
+static struct pseudonym_entry *find_slot(struct pseudonym_entry *entries,
+                                         size_t capacity,
+                                         const uint8_t *pseudonym);
+
+static int grow(struct ecdaa_pseudonym_index_ZZZ *index);
+
+static int insert(struct ecdaa_pseudonym_index_ZZZ *index,
+                  const uint8_t *pseudonym,
+                  uint64_t timestamp,
+                  int write_log,
+                  struct ecdaa_pseudonym_record_ZZZ *record_out);
+
+static int replay_log(struct ecdaa_pseudonym_index_ZZZ *index,
+                      const char *log_file);
+
+static int append_to_log(struct ecdaa_pseudonym_index_ZZZ *index,
+                         const uint8_t *pseudonym,
+                         uint64_t timestamp);
+
+int ecdaa_pseudonym_index_ZZZ_new(struct ecdaa_pseudonym_index_ZZZ **index_out,
+                                  const char *log_file)
+{
+    struct ecdaa_pseudonym_index_ZZZ *index = malloc(sizeof(struct ecdaa_pseudonym_index_ZZZ));
+    if (NULL == index)
+        return -3;
+
+    index->entries = calloc(INITIAL_CAPACITY, sizeof(struct pseudonym_entry));
+    if (NULL == index->entries) {
+        free(index);
+        return -3;
+    }
+    index->capacity = INITIAL_CAPACITY;
+    index->size = 0;
+    index->log_fd = -1;
+    index->log_failed = 0;
+
+    if (0 != pthread_rwlock_init(&index->lock, NULL)) {
+        free(index->entries);
+        free(index);
+        return -3;
+    }
+
+    if (NULL != log_file) {
+        int ret = replay_log(index, log_file);
+        if (0 == ret) {
+            index->log_fd = open(log_file, O_WRONLY | O_APPEND | O_CREAT, 0666);
+            if (-1 == index->log_fd)
+                ret = -1;
+        }
+
+        if (0 != ret) {
+            ecdaa_pseudonym_index_ZZZ_free(index);
+            return ret;
+        }
+    }
+
+    *index_out = index;
+
+    return 0;
+}
+
+void ecdaa_pseudonym_index_ZZZ_free(struct ecdaa_pseudonym_index_ZZZ *index)
+{
+    if (NULL == index)
+        return;
+
+    if (-1 != index->log_fd)
+        close(index->log_fd);
+
+    pthread_rwlock_destroy(&index->lock);
+    free(index->entries);
+    free(index);
+}
+
+int ecdaa_pseudonym_index_ZZZ_add(struct ecdaa_pseudonym_index_ZZZ *index,
+                                  struct ecdaa_signature_ZZZ *signature,
+                                  uint64_t timestamp,
+                                  struct ecdaa_pseudonym_record_ZZZ *record_out)
+{
+    uint8_t pseudonym[ECP_ZZZ_LENGTH];
+    ecp_ZZZ_serialize(pseudonym, &signature->K);
+
+    pthread_rwlock_wrlock(&index->lock);
+    int ret = insert(index, pseudonym, timestamp, 1, record_out);
+    pthread_rwlock_unlock(&index->lock);
+
+    return ret;
+}
+
+int ecdaa_pseudonym_index_ZZZ_add_serialized(struct ecdaa_pseudonym_index_ZZZ *index,
+                                             const uint8_t *pseudonym,
+                                             uint64_t timestamp,
+                                             struct ecdaa_pseudonym_record_ZZZ *record_out)
+{
+    ECP_ZZZ point;
+    if (0 != ecp_ZZZ_deserialize(&point, (uint8_t*)pseudonym))
+        return -1;
+
+    pthread_rwlock_wrlock(&index->lock);
+    int ret = insert(index, pseudonym, timestamp, 1, record_out);
+    pthread_rwlock_unlock(&index->lock);
+
+    return ret;
+}
+
+int ecdaa_pseudonym_index_ZZZ_lookup(struct ecdaa_pseudonym_index_ZZZ *index,
+                                     const uint8_t *pseudonym,
+                                     struct ecdaa_pseudonym_record_ZZZ *record_out)
+{
+    int ret = -1;
+
+    pthread_rwlock_rdlock(&index->lock);
+
+    struct pseudonym_entry *entry = find_slot(index->entries, index->capacity, pseudonym);
+    if (entry->used) {
+        if (NULL != record_out)
+            *record_out = entry->record;
+        ret = 0;
+    }
+
+    pthread_rwlock_unlock(&index->lock);
+
+    return ret;
+}
+
+size_t ecdaa_pseudonym_index_ZZZ_size(struct ecdaa_pseudonym_index_ZZZ *index)
+{
+    pthread_rwlock_rdlock(&index->lock);
+    size_t size = index->size;
+    pthread_rwlock_unlock(&index->lock);
+
+    return size;
+}
+
+static uint64_t hash_pseudonym(const uint8_t *pseudonym)
+{
+    // FNV-1a over the x-coordinate (y is determined by x, up to sign)
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 1; i < 1 + MODBYTES_XXX; i++) {
+        hash ^= pseudonym[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static struct pseudonym_entry *find_slot(struct pseudonym_entry *entries,
+                                         size_t capacity,
+                                         const uint8_t *pseudonym)
+{
+    size_t mask = capacity - 1;
+    size_t i = (size_t)hash_pseudonym(pseudonym) & mask;
+
+    // The table is never full, so this terminates on a match or an empty slot
+    while (entries[i].used && 0 != memcmp(entries[i].pseudonym, pseudonym, ECP_ZZZ_LENGTH))
+        i = (i + 1) & mask;
+
+    return &entries[i];
+}
+
+static int grow(struct ecdaa_pseudonym_index_ZZZ *index)
+{
+    size_t new_capacity = 2 * index->capacity;
+    struct pseudonym_entry *new_entries = calloc(new_capacity, sizeof(struct pseudonym_entry));
+    if (NULL == new_entries)
+        return -3;
+
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (!index->entries[i].used)
+            continue;
+
+        *find_slot(new_entries, new_capacity, index->entries[i].pseudonym) = index->entries[i];
+    }
+
+    free(index->entries);
+    index->entries = new_entries;
+    index->capacity = new_capacity;
+
+    return 0;
+}
+
+static int insert(struct ecdaa_pseudonym_index_ZZZ *index,
+                  const uint8_t *pseudonym,
+                  uint64_t timestamp,
+                  int write_log,
+                  struct ecdaa_pseudonym_record_ZZZ *record_out)
+{
+    struct pseudonym_entry *entry = find_slot(index->entries, index->capacity, pseudonym);
+
+    if (!entry->used && 10 * (index->size + 1) > 7 * index->capacity) {
+        if (0 != grow(index))
+            return -3;
+        entry = find_slot(index->entries, index->capacity, pseudonym);
+    }
+
+    // Log first, so the in-memory index never holds anything the log doesn't
+    if (write_log && 0 != append_to_log(index, pseudonym, timestamp))
+        return -1;
+
+    if (!entry->used) {
+        entry->used = 1;
+        memcpy(entry->pseudonym, pseudonym, ECP_ZZZ_LENGTH);
+        entry->record.count = 0;
+        entry->record.first_seen = timestamp;
+        index->size++;
+    }
+    entry->record.count++;
+    entry->record.last_seen = timestamp;
+
+    if (NULL != record_out)
+        *record_out = entry->record;
+
+    return 0;
+}
+
+static int replay_log(struct ecdaa_pseudonym_index_ZZZ *index,
+                      const char *log_file)
+{
+    FILE *log = fopen(log_file, "rb");
+    if (NULL == log)
+        return 0;   // Nothing logged yet (the file is created on first open for appending)
+
+    int ret = 0;
+    long valid_length = 0;
+    uint8_t record[ECDAA_PSEUDONYM_INDEX_ZZZ_LOG_RECORD_LENGTH];
+    size_t bytes_read;
+    while (sizeof(record) == (bytes_read = fread(record, 1, sizeof(record), log))) {
+        // The log is trusted (it only holds what we wrote), so the on-curve check is skipped here
+        if (0x04 != record[0]) {
+            ret = -1;
+            break;
+        }
+
+        uint64_t timestamp = 0;
+        for (size_t i = 0; i < 8; i++)
+            timestamp = (timestamp << 8) | record[ECP_ZZZ_LENGTH + i];
+
+        ret = insert(index, record, timestamp, 0, NULL);
+        if (0 != ret)
+            break;
+
+        valid_length += (long)sizeof(record);
+    }
+
+    if (0 == ret && ferror(log))
+        ret = -1;
+
+    if (0 != fclose(log) && 0 == ret)
+        ret = -1;
+
+    // Drop a partial trailing record, so new records stay aligned
+    if (0 == ret && 0 != bytes_read && 0 != truncate(log_file, (off_t)valid_length))
+        ret = -1;
+
+    return ret;
+}
+
+static int append_to_log(struct ecdaa_pseudonym_index_ZZZ *index,
+                         const uint8_t *pseudonym,
+                         uint64_t timestamp)
+{
+    if (-1 == index->log_fd)
+        return 0;
+
+    // A torn record is still in the log, so anything appended now would be misaligned
+    if (index->log_failed)
+        return -1;
+
+    uint8_t record[ECDAA_PSEUDONYM_INDEX_ZZZ_LOG_RECORD_LENGTH];
+    memcpy(record, pseudonym, ECP_ZZZ_LENGTH);
+    for (size_t i = 0; i < 8; i++)
+        record[ECP_ZZZ_LENGTH + i] = (uint8_t)(timestamp >> (56 - 8*i));
+
+    // Note where this record starts (appends only happen under the write lock),
+    // so a partial write can be rolled back
+    struct stat log_stat;
+    if (0 != fstat(index->log_fd, &log_stat))
+        return -1;
+
+    size_t written = 0;
+    while (written < sizeof(record)) {
+        ssize_t write_ret = write(index->log_fd, record + written, sizeof(record) - written);
+        if (write_ret < 0 && EINTR == errno)
+            continue;
+        if (write_ret <= 0)
+            break;
+        written += (size_t)write_ret;
+    }
+
+    if (sizeof(record) == written)
+        return 0;
+
+    if (0 != written && 0 != ftruncate(index->log_fd, log_stat.st_size))
+        index->log_failed = 1;
+
+    return -1;
+}
@@ -0,0 +1,253 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "work_stealing_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct task_deque {
+    pthread_mutex_t lock;
+    struct ecdaa_task *top;
+    struct ecdaa_task *bottom;
+};
+
+struct worker {
+    struct ecdaa_work_stealing_pool *pool;
+    size_t index;
+    pthread_t thread;
+};
+
+struct ecdaa_work_stealing_pool {
+    size_t num_threads;
+    struct task_deque *deques;
+    struct worker *workers;
+
+    // Accessed atomically
+    long queued;
+    size_t next_deque;
+
+    // Idle workers sleep here until a task is queued, or the pool is stopping
+    pthread_mutex_t idle_lock;
+    pthread_cond_t work_available;
+    int stopping;
+};
+
+static void *worker_main(void *arg);
+
+static struct ecdaa_task *take_task(struct ecdaa_work_stealing_pool *pool, size_t worker);
+
+static void push_bottom(struct task_deque *deque, struct ecdaa_task *task);
+
+static struct ecdaa_task *pop_bottom(struct task_deque *deque);
+
+static struct ecdaa_task *steal_top(struct task_deque *deque);
+
+static void stop_workers(struct ecdaa_work_stealing_pool *pool, size_t num_started);
+
+int ecdaa_work_stealing_pool_new(struct ecdaa_work_stealing_pool **pool_out,
+                                 size_t num_threads)
+{
+    if (0 == num_threads) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (online > 0) ? (size_t)online : 1;
+    }
+
+    struct ecdaa_work_stealing_pool *pool = malloc(sizeof(struct ecdaa_work_stealing_pool));
+    if (NULL == pool)
+        return -3;
+
+    pool->deques = calloc(num_threads, sizeof(struct task_deque));
+    pool->workers = calloc(num_threads, sizeof(struct worker));
+    if (NULL == pool->deques || NULL == pool->workers) {
+        free(pool->deques);
+        free(pool->workers);
+        free(pool);
+        return -3;
+    }
+
+    pool->num_threads = num_threads;
+    pool->queued = 0;
+    pool->next_deque = 0;
+    pool->stopping = 0;
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+
+    for (size_t i = 0; i < num_threads; i++) {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+        pool->deques[i].top = NULL;
+        pool->deques[i].bottom = NULL;
+    }
+
+    for (size_t i = 0; i < num_threads; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (0 != pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i])) {
+            stop_workers(pool, i);
+            return -1;
+        }
+    }
+
+    *pool_out = pool;
+
+    return 0;
+}
+
+void ecdaa_work_stealing_pool_free(struct ecdaa_work_stealing_pool *pool)
+{
+    if (NULL == pool)
+        return;
+
+    stop_workers(pool, pool->num_threads);
+}
+
+size_t ecdaa_work_stealing_pool_size(struct ecdaa_work_stealing_pool *pool)
+{
+    return pool->num_threads;
+}
+
+void ecdaa_work_stealing_pool_push(struct ecdaa_work_stealing_pool *pool,
+                                   struct ecdaa_task *task,
+                                   size_t worker)
+{
+    if (ECDAA_NOT_A_WORKER == worker)
+        worker = __atomic_fetch_add(&pool->next_deque, 1, __ATOMIC_RELAXED) % pool->num_threads;
+
+    // Count the task before it's visible, so `queued` never goes negative
+    __atomic_fetch_add(&pool->queued, 1, __ATOMIC_SEQ_CST);
+
+    struct task_deque *deque = &pool->deques[worker];
+    pthread_mutex_lock(&deque->lock);
+    push_bottom(deque, task);
+    pthread_mutex_unlock(&deque->lock);
+
+    pthread_mutex_lock(&pool->idle_lock);
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+void *worker_main(void *arg)
+{
+    struct worker *self = arg;
+    struct ecdaa_work_stealing_pool *pool = self->pool;
+
+    for (;;) {
+        struct ecdaa_task *task = take_task(pool, self->index);
+        if (NULL != task) {
+            task->run(task, self->index);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->idle_lock);
+        while (0 == __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) && !pool->stopping)
+            pthread_cond_wait(&pool->work_available, &pool->idle_lock);
+        int done = pool->stopping && 0 == __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&pool->idle_lock);
+
+        if (done)
+            break;
+    }
+
+    return NULL;
+}
+
+struct ecdaa_task *take_task(struct ecdaa_work_stealing_pool *pool, size_t worker)
+{
+    struct ecdaa_task *task = NULL;
+
+    // 1) Newest task from our own deque
+    struct task_deque *own = &pool->deques[worker];
+    pthread_mutex_lock(&own->lock);
+    task = pop_bottom(own);
+    pthread_mutex_unlock(&own->lock);
+
+    // 2) Else, oldest task from someone else's
+    for (size_t i = 1; NULL == task && i < pool->num_threads; i++) {
+        struct task_deque *victim = &pool->deques[(worker + i) % pool->num_threads];
+        pthread_mutex_lock(&victim->lock);
+        task = steal_top(victim);
+        pthread_mutex_unlock(&victim->lock);
+    }
+
+    if (NULL != task)
+        __atomic_fetch_sub(&pool->queued, 1, __ATOMIC_SEQ_CST);
+
+    return task;
+}
+
+void push_bottom(struct task_deque *deque, struct ecdaa_task *task)
+{
+    task->next = NULL;
+    task->prev = deque->bottom;
+    if (NULL != deque->bottom)
+        deque->bottom->next = task;
+    else
+        deque->top = task;
+    deque->bottom = task;
+}
+
+struct ecdaa_task *pop_bottom(struct task_deque *deque)
+{
+    struct ecdaa_task *task = deque->bottom;
+    if (NULL != task) {
+        deque->bottom = task->prev;
+        if (NULL != deque->bottom)
+            deque->bottom->next = NULL;
+        else
+            deque->top = NULL;
+    }
+
+    return task;
+}
+
+struct ecdaa_task *steal_top(struct task_deque *deque)
+{
+    struct ecdaa_task *task = deque->top;
+    if (NULL != task) {
+        deque->top = task->next;
+        if (NULL != deque->top)
+            deque->top->prev = NULL;
+        else
+            deque->bottom = NULL;
+    }
+
+    return task;
+}
+
+void stop_workers(struct ecdaa_work_stealing_pool *pool, size_t num_started)
+{
+    pthread_mutex_lock(&pool->idle_lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    for (size_t i = 0; i < num_started; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+
+    for (size_t i = 0; i < pool->num_threads; i++)
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_mutex_destroy(&pool->idle_lock);
+
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
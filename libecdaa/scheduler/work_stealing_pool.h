@@ -0,0 +1,87 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_WORK_STEALING_POOL_H
+#define ECDAA_WORK_STEALING_POOL_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+/*
+ * A unit of work for the pool.
+ *
+ * Tasks are intrusive: embed one in a larger struct, and recover the struct in `run`.
+ * `worker` is the index of the worker running the task,
+ * so the task can push follow-up tasks onto that worker's own deque.
+ */
+struct ecdaa_task {
+    void (*run)(struct ecdaa_task *task, size_t worker);
+
+    struct ecdaa_task *prev;
+    struct ecdaa_task *next;
+};
+
+#define ECDAA_NOT_A_WORKER ((size_t)-1)
+
+/*
+ * Fixed-size pool of worker threads, each with its own task deque.
+ *
+ * A worker runs tasks from the bottom of its own deque (newest first),
+ * and when that's empty steals from the top of the others' (oldest first).
+ * So a task that splits itself into pieces keeps working on them,
+ * while idle workers take the rest.
+ */
+struct ecdaa_work_stealing_pool;
+
+/*
+ * Start a pool of `num_threads` workers (or one per online CPU, if 0).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the worker threads can't be started
+ * -3 on allocation failure
+ */
+int ecdaa_work_stealing_pool_new(struct ecdaa_work_stealing_pool **pool_out,
+                                 size_t num_threads);
+
+/*
+ * Run every queued task, then stop the workers and free the pool.
+ */
+void ecdaa_work_stealing_pool_free(struct ecdaa_work_stealing_pool *pool);
+
+size_t ecdaa_work_stealing_pool_size(struct ecdaa_work_stealing_pool *pool);
+
+/*
+ * Queue `task`.
+ *
+ * From inside a task, pass the `worker` it was run on, to push onto that worker's deque.
+ * From any other thread, pass `ECDAA_NOT_A_WORKER` (the deque is then chosen round-robin).
+ */
+void ecdaa_work_stealing_pool_push(struct ecdaa_work_stealing_pool *pool,
+                                   struct ecdaa_task *task,
+                                   size_t worker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
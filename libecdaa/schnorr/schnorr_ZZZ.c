@@ -19,6 +19,7 @@
 #include "schnorr_ZZZ.h"
 
 #include "internal-utilities/explicit_bzero.h"
+#include "internal-utilities/instrumentation.h"
 #include "amcl-extensions/big_XXX.h"
 #include "amcl-extensions/ecp_ZZZ.h"
 #include "amcl-extensions/ecp2_ZZZ.h"
@@ -46,6 +47,24 @@ int commit(ECP_ZZZ *P1,
            ECP_ZZZ *E,
            ecdaa_rand_func get_random);
 
+static
+int respond(BIG_XXX *c_out,
+            BIG_XXX *s_out,
+            BIG_XXX *n_out,
+            const uint8_t *msg_in,
+            uint32_t msg_len,
+            ECP_ZZZ *basepoint,
+            ECP_ZZZ *public_key,
+            BIG_XXX private_key,
+            const uint8_t *basename,
+            uint32_t basename_len,
+            BIG_XXX *k,
+            ECP_ZZZ *P2,
+            ECP_ZZZ *K,
+            ECP_ZZZ *L,
+            ECP_ZZZ *R,
+            ecdaa_rand_func get_random);
+
 void schnorr_keygen_ZZZ(ECP_ZZZ *public_out,
                         BIG_XXX *private_out,
                         ecdaa_rand_func get_random)
@@ -54,7 +73,7 @@ void schnorr_keygen_ZZZ(ECP_ZZZ *public_out,
 
     ecp_ZZZ_set_to_generator(public_out);
 
-    ECP_ZZZ_mul(public_out, *private_out);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(public_out, *private_out, get_random));
 }
 
 int schnorr_sign_ZZZ(BIG_XXX *c_out,
@@ -77,54 +96,41 @@ int schnorr_sign_ZZZ(BIG_XXX *c_out,
     if (0 != commit_ret)
         return -1;
 
-    // 2) (Sign 1) Compute first hash
-    //      (modular-reduce c', too).
-    BIG_XXX c_prime;
-    if (basename_len != 0) {
-        // If any of these is non-zero, ALL must be non-zero.
-        if (NULL == basename || NULL == K_out)
-            return -1;
-
-        // Compute c' = Hash( R | basepoint | public_key | L | P2 | K_out | basename | msg_in )
-        uint8_t hash_input_begin[SIX_ECP_LENGTH];
-        assert(6*ECP_ZZZ_LENGTH == sizeof(hash_input_begin));
-        ecp_ZZZ_serialize(hash_input_begin, &R);
-        ecp_ZZZ_serialize(hash_input_begin+ECP_ZZZ_LENGTH, basepoint);
-        ecp_ZZZ_serialize(hash_input_begin+2*ECP_ZZZ_LENGTH, public_key);
-        ecp_ZZZ_serialize(hash_input_begin+3*ECP_ZZZ_LENGTH, &L);
-        ecp_ZZZ_serialize(hash_input_begin+4*ECP_ZZZ_LENGTH, &P2);
-        ecp_ZZZ_serialize(hash_input_begin+5*ECP_ZZZ_LENGTH, K_out);
-        big_XXX_from_three_message_hash(&c_prime, hash_input_begin, sizeof(hash_input_begin), basename, basename_len, msg_in, msg_len);
-    } else {
-        // Compute c' = Hash( R | basepoint | public_key | msg_in )
-        uint8_t hash_input_begin[THREE_ECP_LENGTH];
-        assert(3*ECP_ZZZ_LENGTH == sizeof(hash_input_begin));
-        ecp_ZZZ_serialize(hash_input_begin, &R);
-        ecp_ZZZ_serialize(hash_input_begin+ECP_ZZZ_LENGTH, basepoint);
-        ecp_ZZZ_serialize(hash_input_begin+2*ECP_ZZZ_LENGTH, public_key);
-        big_XXX_from_two_message_hash(&c_prime, hash_input_begin, sizeof(hash_input_begin), msg_in, msg_len);
-    }
-    BIG_XXX curve_order;
-    BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
-    BIG_XXX_mod(c_prime, curve_order);
+    return respond(c_out, s_out, n_out, msg_in, msg_len, basepoint, public_key, private_key,
+                   basename, basename_len, &k, &P2, K_out, &L, &R, get_random);
+}
 
-    // 3) (Sign 2) Compute n <- Z_n
-    ecp_ZZZ_random_mod_order(n_out, get_random);
+int schnorr_sign_cached_basename_ZZZ(BIG_XXX *c_out,
+                                     BIG_XXX *s_out,
+                                     BIG_XXX *n_out,
+                                     const uint8_t *msg_in,
+                                     uint32_t msg_len,
+                                     ECP_ZZZ *basepoint,
+                                     ECP_ZZZ *public_key,
+                                     BIG_XXX private_key,
+                                     const uint8_t *basename,
+                                     uint32_t basename_len,
+                                     ECP_ZZZ *P2,
+                                     ECP_ZZZ *K,
+                                     ECP_ZZZ *P2_table,
+                                     ecdaa_rand_func get_random)
+{
+    if (NULL == basename || 0 == basename_len)
+        return -1;
 
-    // 4) (Sign 3) Compute final hash
-    //      c_out = Hash(n | c')
-    uint8_t final_hash_input_begin[2*MODBYTES_XXX];
-    BIG_XXX_toBytes((char*)final_hash_input_begin, *n_out);
-    BIG_XXX_toBytes((char*)(final_hash_input_begin+MODBYTES_XXX), c_prime);
-    big_XXX_from_hash(c_out, final_hash_input_begin, sizeof(final_hash_input_begin));
+    // 1) (Commit) As `commit`, but P2 and K are already known
+    BIG_XXX k;
+    ecp_ZZZ_random_mod_order(&k, get_random);
 
-    // 5) (Sign 4) Compute s = k + c_out * private_key
-    big_XXX_mod_mul_and_add(s_out, k, *c_out, private_key, curve_order);    // normalizes and mod-reduces s_out and c_out
+    ECP_ZZZ L;
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret_fixed_base(&L, P2_table, k, get_random));
 
-    // Clear intermediate, sensitive memory.
-    explicit_bzero(&k, sizeof(BIG_XXX));
+    ECP_ZZZ R;
+    ECP_ZZZ_copy(&R, basepoint);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&R, k, get_random));
 
-    return 0;
+    return respond(c_out, s_out, n_out, msg_in, msg_len, basepoint, public_key, private_key,
+                   basename, basename_len, &k, P2, K, &L, &R, get_random);
 }
 
 int schnorr_verify_ZZZ(BIG_XXX c,
@@ -145,12 +151,12 @@ int schnorr_verify_ZZZ(BIG_XXX c,
     // 2) Multiply basepoint by s (R = s*P)
     ECP_ZZZ R;
     ECP_ZZZ_copy(&R, basepoint);
-    ECP_ZZZ_mul(&R, s);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&R, s));
 
     // 3) Multiply public_key by c (Q_c = c *public_key)
     ECP_ZZZ Q_c;
     ECP_ZZZ_copy(&Q_c, public_key);
-    ECP_ZZZ_mul(&Q_c, c);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&Q_c, c));
 
     // 4) Compute difference of R and c*Q, and save to R (R = s*P - c*public_key)
     ECP_ZZZ_sub(&R, &Q_c);
@@ -175,16 +181,20 @@ int schnorr_verify_ZZZ(BIG_XXX c,
 
         // 2ii) Multiply P2 by s (L = s*P2)
         ECP_ZZZ_copy(&L, &P2);
-        ECP_ZZZ_mul(&L, s);
+        ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&L, s));
 
         // 3) Multiply K by c (K_c = c *K)
         ECP_ZZZ K_c;
         ECP_ZZZ_copy(&K_c, K);
-        ECP_ZZZ_mul(&K_c, c);
+        ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&K_c, c));
 
         // 4) Compute difference of L and c*K, and save to L (L = s*P2 - c*K)
         ECP_ZZZ_sub(&L, &K_c);
 
+        // Convert R and L to affine (for serializing) with one inversion
+        ECP_ZZZ *RL[2] = {&R, &L};
+        ecp_ZZZ_batch_affine(RL, 2);
+
         // c'' = Hash( R | basepoint | public_key | L | P2 | K | basename | msg_in )
         uint8_t hash_input_begin[SIX_ECP_LENGTH];
         assert(6*ECP_ZZZ_LENGTH == sizeof(hash_input_begin));
@@ -243,14 +253,15 @@ int credential_schnorr_sign_ZZZ(BIG_XXX *c_out,
     ecp_ZZZ_random_mod_order(&r, get_random);
 
     // 3) Multiply generator by r: U = r*generator
+    // 4) Multiply member_public_key by r: V = r*member_public_key
     ECP_ZZZ U;
     ECP_ZZZ_copy(&U, &generator);
-    ECP_ZZZ_mul(&U, r);
-
-    // 4) Multiply member_public_key by r: V = r*member_public_key
     ECP_ZZZ V;
     ECP_ZZZ_copy(&V, member_public_key);
-    ECP_ZZZ_mul(&V, r);
+    ECP_ZZZ *UV[2] = {&U, &V};
+    ECDAA_INSTRUMENTATION_BEGIN(mul_start);
+    ecp_ZZZ_mul_secret_multi(UV, 2, r, get_random);
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_ECP_MUL, 2, mul_start);
 
     // 5) Compute c = Hash( U | V | generator | B | member_public_key | D )
     uint8_t hash_input[SIX_ECP_LENGTH];
@@ -291,32 +302,32 @@ int credential_schnorr_verify_ZZZ(BIG_XXX c,
     // 2) Multiply generator by s (R1 = s*P)
     ECP_ZZZ R1;
     ECP_ZZZ_copy(&R1, &generator);
-    ECP_ZZZ_mul(&R1, s);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&R1, s));
 
     // 3) Multiply B by c (B_c = c*B)
     ECP_ZZZ B_c;
     ECP_ZZZ_copy(&B_c, B);
-    ECP_ZZZ_mul(&B_c, c);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&B_c, c));
 
     // 4) Compute difference of R1 and c*B, and save to R1 (R1 = s*P - c*B)
     ECP_ZZZ_sub(&R1, &B_c);
-    // Nb. No need to call ECP_ZZZ_affine here,
-    // as R1 gets passed to ECP_ZZZ_toOctet in a minute (which implicitly converts to affine)
 
     // 5) Multiply member_public_key by s (R2 = s*member_public_key)
     ECP_ZZZ R2;
     ECP_ZZZ_copy(&R2, member_public_key);
-    ECP_ZZZ_mul(&R2, s);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&R2, s));
 
     // 6) Multiply D by c (D_c = c*D)
     ECP_ZZZ D_c;
     ECP_ZZZ_copy(&D_c, D);
-    ECP_ZZZ_mul(&D_c, c);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_glv(&D_c, c));
 
     // 7) Compute difference of R2 and c*D, and save to R2 (R2 = s*member_public_key - c*D)
     ECP_ZZZ_sub(&R2, &D_c);
-    // Nb. No need to call ECP_ZZZ_affine here,
-    // as R2 gets passed to ECP_ZZZ_toOctet in a minute (which implicitly converts to affine)
+
+    // Convert R1 and R2 to affine (for serializing) with one inversion
+    ECP_ZZZ *R1R2[2] = {&R1, &R2};
+    ecp_ZZZ_batch_affine(R1R2, 2);
 
     // 8) Compute c' = Hash( R1 | R2 | generator | B | member_public_key | D )
     //      (modular-reduce c', too).
@@ -363,12 +374,12 @@ int issuer_schnorr_sign_ZZZ(BIG_XXX *c_out,
     // 3) Multiply generator_2 by rx: Ux = rx*generator_2
     ECP2_ZZZ Ux;
     ECP2_ZZZ_copy(&Ux, &generator_2);
-    ECP2_ZZZ_mul(&Ux, rx);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP2_MUL, ecp2_ZZZ_mul_gls(&Ux, rx));
 
     // 4) Multiply generator_2 by ry: Uy = ry*generator_2
     ECP2_ZZZ Uy;
     ECP2_ZZZ_copy(&Uy, &generator_2);
-    ECP2_ZZZ_mul(&Uy, ry);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP2_MUL, ecp2_ZZZ_mul_gls(&Uy, ry));
 
     // 5) Compute c = Hash( Ux | Uy | generator_2 | X | Y )
     uint8_t hash_input[FIVE_ECP2_LENGTH];
@@ -408,12 +419,12 @@ int issuer_schnorr_verify_ZZZ(BIG_XXX c,
     // 2) Multiply generator_2 by sx (R1 = sx*P2)
     ECP2_ZZZ R1;
     ECP2_ZZZ_copy(&R1, &generator_2);
-    ECP2_ZZZ_mul(&R1, sx);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP2_MUL, ecp2_ZZZ_mul_gls(&R1, sx));
 
     // 3) Multiply X by c (X_c = c*X)
     ECP2_ZZZ X_c;
     ECP2_ZZZ_copy(&X_c, X);
-    ECP2_ZZZ_mul(&X_c, c);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP2_MUL, ecp2_ZZZ_mul_gls(&X_c, c));
 
     // 4) Compute difference of R1 and c*X, and save to R1 (R1 = sx*P2 - c*X)
     ECP2_ZZZ_sub(&R1, &X_c);
@@ -423,12 +434,12 @@ int issuer_schnorr_verify_ZZZ(BIG_XXX c,
     // 5) Multiply generator_2 by sy (R2 = sy*P2)
     ECP2_ZZZ R2;
     ECP2_ZZZ_copy(&R2, &generator_2);
-    ECP2_ZZZ_mul(&R2, sy);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP2_MUL, ecp2_ZZZ_mul_gls(&R2, sy));
 
     // 6) Multiply Y by c (Y_c = c*Y)
     ECP2_ZZZ Y_c;
     ECP2_ZZZ_copy(&Y_c, Y);
-    ECP2_ZZZ_mul(&Y_c, c);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP2_MUL, ecp2_ZZZ_mul_gls(&Y_c, c));
 
     // 7) Compute difference of R2 and c*Y, and save to R2 (R2 = sy*P2 - c*Y)
     ECP2_ZZZ_sub(&R2, &Y_c);
@@ -478,7 +489,9 @@ int commit(ECP_ZZZ *P1,
 
     // 3) If s2 is provided,
     //  3i) Do K = [private_key](x2,y2),
-    //  3ii) Do [k](x2,y2)
+    //  3ii) Do [k](x2,y2) (along with step 4)
+    ECP_ZZZ *k_points[2] = {E, NULL};
+    size_t num_k_points = 1;
     if (NULL != s2 || 0 != s2_length) {
         // If any of these is non-zero, ALL must be non-zero.
         if (NULL == s2 || 0 == s2_length || NULL == K)
@@ -490,14 +503,83 @@ int commit(ECP_ZZZ *P1,
         ECP_ZZZ_copy(L, P2);
         ECP_ZZZ_copy(K, P2);
 
-        ECP_ZZZ_mul(K, private_key);
+        ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(K, private_key, get_random));
 
-        ECP_ZZZ_mul(L, *k);
+        k_points[num_k_points++] = L;
     }
 
     // 4) Multiply P1 by k: E = k*P1
     ECP_ZZZ_copy(E, P1);
-    ECP_ZZZ_mul(E, *k);
+    ECDAA_INSTRUMENTATION_BEGIN(mul_start);
+    ecp_ZZZ_mul_secret_multi(k_points, num_k_points, *k, get_random);
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_ECP_MUL, num_k_points, mul_start);
+
+    return 0;
+}
+
+int respond(BIG_XXX *c_out,
+            BIG_XXX *s_out,
+            BIG_XXX *n_out,
+            const uint8_t *msg_in,
+            uint32_t msg_len,
+            ECP_ZZZ *basepoint,
+            ECP_ZZZ *public_key,
+            BIG_XXX private_key,
+            const uint8_t *basename,
+            uint32_t basename_len,
+            BIG_XXX *k,
+            ECP_ZZZ *P2,
+            ECP_ZZZ *K,
+            ECP_ZZZ *L,
+            ECP_ZZZ *R,
+            ecdaa_rand_func get_random)
+{
+    // 1) (Sign 1) Compute first hash
+    //      (modular-reduce c', too).
+    BIG_XXX c_prime;
+    if (basename_len != 0) {
+        // If any of these is non-zero, ALL must be non-zero.
+        if (NULL == basename || NULL == K)
+            return -1;
+
+        // Compute c' = Hash( R | basepoint | public_key | L | P2 | K | basename | msg_in )
+        uint8_t hash_input_begin[SIX_ECP_LENGTH];
+        assert(6*ECP_ZZZ_LENGTH == sizeof(hash_input_begin));
+        ecp_ZZZ_serialize(hash_input_begin, R);
+        ecp_ZZZ_serialize(hash_input_begin+ECP_ZZZ_LENGTH, basepoint);
+        ecp_ZZZ_serialize(hash_input_begin+2*ECP_ZZZ_LENGTH, public_key);
+        ecp_ZZZ_serialize(hash_input_begin+3*ECP_ZZZ_LENGTH, L);
+        ecp_ZZZ_serialize(hash_input_begin+4*ECP_ZZZ_LENGTH, P2);
+        ecp_ZZZ_serialize(hash_input_begin+5*ECP_ZZZ_LENGTH, K);
+        big_XXX_from_three_message_hash(&c_prime, hash_input_begin, sizeof(hash_input_begin), basename, basename_len, msg_in, msg_len);
+    } else {
+        // Compute c' = Hash( R | basepoint | public_key | msg_in )
+        uint8_t hash_input_begin[THREE_ECP_LENGTH];
+        assert(3*ECP_ZZZ_LENGTH == sizeof(hash_input_begin));
+        ecp_ZZZ_serialize(hash_input_begin, R);
+        ecp_ZZZ_serialize(hash_input_begin+ECP_ZZZ_LENGTH, basepoint);
+        ecp_ZZZ_serialize(hash_input_begin+2*ECP_ZZZ_LENGTH, public_key);
+        big_XXX_from_two_message_hash(&c_prime, hash_input_begin, sizeof(hash_input_begin), msg_in, msg_len);
+    }
+    BIG_XXX curve_order;
+    BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
+    BIG_XXX_mod(c_prime, curve_order);
+
+    // 2) (Sign 2) Compute n <- Z_n
+    ecp_ZZZ_random_mod_order(n_out, get_random);
+
+    // 3) (Sign 3) Compute final hash
+    //      c_out = Hash(n | c')
+    uint8_t final_hash_input_begin[2*MODBYTES_XXX];
+    BIG_XXX_toBytes((char*)final_hash_input_begin, *n_out);
+    BIG_XXX_toBytes((char*)(final_hash_input_begin+MODBYTES_XXX), c_prime);
+    big_XXX_from_hash(c_out, final_hash_input_begin, sizeof(final_hash_input_begin));
+
+    // 4) (Sign 4) Compute s = k + c_out * private_key
+    big_XXX_mod_mul_and_add(s_out, *k, *c_out, private_key, curve_order);    // normalizes and mod-reduces s_out and c_out
+
+    // Clear intermediate, sensitive memory.
+    explicit_bzero(k, sizeof(BIG_XXX));
 
     return 0;
 }
@@ -75,6 +75,33 @@ int schnorr_sign_ZZZ(BIG_XXX *c_out,
                      uint32_t basename_len,
                      ecdaa_rand_func get_random);
 
+/*
+ * As `schnorr_sign_ZZZ` with a basename, but with the basename's point P2,
+ * the pseudonym K = [private_key]P2, and a fixed-base table for P2
+ * (cf. `ecp_ZZZ_fixed_base_table_init`) already computed.
+ *
+ * Saves hashing the basename and multiplying by the private key,
+ * and uses the faster fixed-base multiplication for P2.
+ *
+ *  Returns:
+ *   0 on success
+ *   -1 if basename is missing
+ */
+int schnorr_sign_cached_basename_ZZZ(BIG_XXX *c_out,
+                                     BIG_XXX *s_out,
+                                     BIG_XXX *n_out,
+                                     const uint8_t *msg_in,
+                                     uint32_t msg_len,
+                                     ECP_ZZZ *basepoint,
+                                     ECP_ZZZ *public_key,
+                                     BIG_XXX private_key,
+                                     const uint8_t *basename,
+                                     uint32_t basename_len,
+                                     ECP_ZZZ *P2,
+                                     ECP_ZZZ *K,
+                                     ECP_ZZZ *P2_table,
+                                     ecdaa_rand_func get_random);
+
 /*
  * Verify that (c, s, n) is a valid Schnorr signature of msg_in, allowing for a non-standard basepoint.
  *
@@ -18,6 +18,7 @@
 
 #include <ecdaa/signature_ZZZ.h>
 
+#include <ecdaa/basename_session_ZZZ.h>
 #include <ecdaa/member_keypair_ZZZ.h>
 #include <ecdaa/group_public_key_ZZZ.h>
 #include <ecdaa/revocations_ZZZ.h>
@@ -26,10 +27,12 @@
 #include <ecdaa/util/file_io.h>
 
 #include "schnorr/schnorr_ZZZ.h"
+#include "verify/verify_ZZZ.h"
 #include "amcl-extensions/big_XXX.h"
 #include "amcl-extensions/ecp_ZZZ.h"
 #include "amcl-extensions/ecp2_ZZZ.h"
 #include "amcl-extensions/pairing_ZZZ.h"
+#include "internal-utilities/instrumentation.h"
 
 #include <amcl/pair_ZZZ.h>
 #include <amcl/fp12_ZZZ.h>
@@ -39,6 +42,10 @@ void randomize_credential_ZZZ(struct ecdaa_credential_ZZZ *cred,
                               ecdaa_rand_func get_random,
                               struct ecdaa_signature_ZZZ *signature_out);
 
+static
+void random_batch_weight_ZZZ(BIG_XXX *weight_out,
+                             ecdaa_rand_func get_random);
+
 size_t ecdaa_signature_ZZZ_length(void)
 {
     return ECDAA_SIGNATURE_ZZZ_LENGTH;
@@ -79,6 +86,40 @@ int ecdaa_signature_ZZZ_sign(struct ecdaa_signature_ZZZ *signature_out,
     return sign_ret;
 }
 
+int ecdaa_signature_ZZZ_sign_with_session(struct ecdaa_signature_ZZZ *signature_out,
+                                          const uint8_t* message,
+                                          uint32_t message_len,
+                                          struct ecdaa_basename_session_ZZZ *session,
+                                          struct ecdaa_member_secret_key_ZZZ *sk,
+                                          struct ecdaa_credential_ZZZ *cred,
+                                          ecdaa_rand_func get_random)
+{
+    // 1) Randomize credential
+    randomize_credential_ZZZ(cred, get_random, signature_out);
+
+    // 2) The pseudonym is fixed for the session
+    ECP_ZZZ_copy(&signature_out->K, &session->K);
+
+    // 3) Create a Schnorr-like signature on W concatenated with the message,
+    //  where the basepoint is S.
+    int sign_ret = schnorr_sign_cached_basename_ZZZ(&signature_out->c,
+                                                    &signature_out->s,
+                                                    &signature_out->n,
+                                                    message,
+                                                    message_len,
+                                                    &signature_out->S,
+                                                    &signature_out->W,
+                                                    sk->sk,
+                                                    session->basename,
+                                                    session->basename_len,
+                                                    &session->P2,
+                                                    &session->K,
+                                                    session->P2_table,
+                                                    get_random);
+
+    return sign_ret;
+}
+
 int ecdaa_signature_ZZZ_verify(struct ecdaa_signature_ZZZ *signature,
                                struct ecdaa_group_public_key_ZZZ *gpk,
                                struct ecdaa_revocations_ZZZ *revocations,
@@ -89,63 +130,227 @@ int ecdaa_signature_ZZZ_verify(struct ecdaa_signature_ZZZ *signature,
 {
     int ret = 0;
 
-    // 1) Check R,S,T,W for membership in group, and R and S for !=inf
-    // NOTE: We assume the signature was obtained from a call to `deserialize`,
-    //  which already checked the validity of the points R,S,T,W
-
-    // 2) Check Schnorr-type signature
-    int schnorr_ret = schnorr_verify_ZZZ(signature->c,
-                                         signature->s,
-                                         signature->n,
-                                         &signature->K,
-                                         message,
-                                         message_len,
-                                         &signature->S,
-                                         &signature->W,
-                                         basename,
-                                         basename_len);
-    if (0 != schnorr_ret)
+    // 1) Check the Schnorr-type signature and the pairing equations
+    if (0 != verify_signature_proofs_ZZZ(signature, gpk, message, message_len, basename, basename_len))
         ret = -1;
 
-    ECP2_ZZZ basepoint2;
-    ecp2_ZZZ_set_to_generator(&basepoint2);
+    // 2) Check W against sk_revocation_list
+    if (0 != check_sk_revocations_ZZZ(signature, revocations->sk_list, revocations->sk_length, 0))
+        ret = -1;
 
-    // 3) Check e(R, Y) == e(S, P_2)
-    FP12_YYY pairing_one;
-    FP12_YYY pairing_one_prime;
-    compute_pairing_ZZZ(&pairing_one, &signature->R, &gpk->Y);
-    compute_pairing_ZZZ(&pairing_one_prime, &signature->S, &basepoint2);
-    if (!FP12_YYY_equals(&pairing_one, &pairing_one_prime))
+    // 3) Check K against bsn_revocation_list
+    if (0 != check_bsn_revocations_ZZZ(signature, revocations->bsn_list, revocations->bsn_length, 0))
         ret = -1;
 
-    // 4) Compute R+W
-    //      Nb. Add doesn't convert to affine, so do that explicitly
-    ECP_ZZZ RW;
-    ECP_ZZZ_copy(&RW, &signature->R);
-    ECP_ZZZ_add(&RW, &signature->W);
-    ECP_ZZZ_affine(&RW);
-
-    // 5) Check e(T, P_2) == e(R+W, X)
-    FP12_YYY pairing_two;
-    FP12_YYY pairing_two_prime;
-    compute_pairing_ZZZ(&pairing_two, &signature->T, &basepoint2);
-    compute_pairing_ZZZ(&pairing_two_prime, &RW, &gpk->X);
-    if (!FP12_YYY_equals(&pairing_two, &pairing_two_prime))
+    return ret;
+}
+
+int ecdaa_signature_ZZZ_verify_multi_group(size_t *group_index_out,
+                                           struct ecdaa_signature_ZZZ *signature,
+                                           struct ecdaa_group_public_key_ZZZ **gpks,
+                                           struct ecdaa_revocations_ZZZ **revocations,
+                                           size_t num_groups,
+                                           uint8_t* message,
+                                           uint32_t message_len,
+                                           uint8_t *basename,
+                                           uint32_t basename_len)
+{
+    // 1) Check the Schnorr-type signature (which doesn't involve the group)
+    if (0 != verify_signature_schnorr_ZZZ(signature, message, message_len, basename, basename_len))
+        return -1;
+
+    // 2) Compute the pairings that don't involve the group
+    struct signature_pairings_precomputation_ZZZ precomputation;
+    verify_signature_pairings_precompute_ZZZ(&precomputation, signature);
+
+    // 3) Find the group whose X and Y satisfy the pairing equations
+    for (size_t i = 0; i < num_groups; i++) {
+        if (0 != verify_signature_pairings_precomputed_ZZZ(&precomputation, signature, gpks[i]))
+            continue;
+
+        // 4) Check W and K against that group's revocation lists
+        if (0 != check_sk_revocations_ZZZ(signature, revocations[i]->sk_list, revocations[i]->sk_length, 0))
+            return -1;
+
+        if (0 != check_bsn_revocations_ZZZ(signature, revocations[i]->bsn_list, revocations[i]->bsn_length, 0))
+            return -1;
+
+        *group_index_out = i;
+        return 0;
+    }
+
+    return -1;
+}
+
+int ecdaa_signature_ZZZ_verify_fail_fast(struct ecdaa_signature_ZZZ *signature,
+                                         struct ecdaa_group_public_key_ZZZ *gpk,
+                                         struct ecdaa_revocations_ZZZ *revocations,
+                                         uint8_t* message,
+                                         uint32_t message_len,
+                                         uint8_t *basename,
+                                         uint32_t basename_len)
+{
+    // Cheapest checks first, each stopping at its first failure
+    //  (the shared checks used by `ecdaa_signature_ZZZ_verify` are exhaustive).
+
+    // 1) Check K against bsn_revocation_list (point comparisons only)
+    if (0 != check_bsn_revocations_ZZZ(signature, revocations->bsn_list, revocations->bsn_length, 1))
+        return -1;
+
+    // 2) Check the Schnorr-type signature (a hash and a few multiplications)
+    if (0 != verify_signature_schnorr_ZZZ(signature, message, message_len, basename, basename_len))
+        return -1;
+
+    // 3) Check the pairing equations
+    if (0 != verify_signature_pairings_ZZZ(signature, gpk, 1))
+        return -1;
+
+    // 4) Check W against sk_revocation_list (one multiplication per entry)
+    if (0 != check_sk_revocations_ZZZ(signature, revocations->sk_list, revocations->sk_length, 1))
+        return -1;
+
+    return 0;
+}
+
+int ecdaa_signature_ZZZ_verify_with_issuer_key(struct ecdaa_signature_ZZZ *signature,
+                                               struct ecdaa_issuer_secret_key_ZZZ *isk,
+                                               struct ecdaa_revocations_ZZZ *revocations,
+                                               uint8_t* message,
+                                               uint32_t message_len,
+                                               uint8_t *basename,
+                                               uint32_t basename_len,
+                                               ecdaa_rand_func get_random)
+{
+    int ret = 0;
+
+    // 1) Check the Schnorr-type signature
+    if (0 != verify_signature_schnorr_ZZZ(signature, message, message_len, basename, basename_len))
+        ret = -1;
+
+    // 2) Check S == y*R and T == x*(R+W) (in place of the pairing equations)
+    if (0 != verify_signature_with_issuer_key_ZZZ(signature, isk, get_random))
         ret = -1;
 
-    // 6) Check W against sk_revocation_list
-    ECP_ZZZ Wcheck;
-    for (size_t i = 0; i < revocations->sk_length; ++i) {
-        ECP_ZZZ_copy(&Wcheck, &signature->S);
-        ECP_ZZZ_mul(&Wcheck, revocations->sk_list[i].sk);
-        if (ECP_ZZZ_equals(&Wcheck, &signature->W))
+    // 3) Check W against sk_revocation_list
+    if (0 != check_sk_revocations_ZZZ(signature, revocations->sk_list, revocations->sk_length, 0))
+        ret = -1;
+
+    // 4) Check K against bsn_revocation_list
+    if (0 != check_bsn_revocations_ZZZ(signature, revocations->bsn_list, revocations->bsn_length, 0))
+        ret = -1;
+
+    return ret;
+}
+
+int ecdaa_signature_ZZZ_batch_verify(int *results_out,
+                                     struct ecdaa_signature_ZZZ *signatures,
+                                     uint8_t* const *messages,
+                                     const uint32_t *message_lens,
+                                     size_t num_signatures,
+                                     struct ecdaa_group_public_key_ZZZ *gpk,
+                                     struct ecdaa_revocations_ZZZ *revocations,
+                                     uint8_t *basename,
+                                     uint32_t basename_len,
+                                     ecdaa_rand_func get_random)
+{
+    int ret = 0;
+    size_t num_pending = 0;
+
+    // Accumulators for the combined pairing checks:
+    //  sum_R = sum(d_i*R_i), sum_RW = sum(e_i*(R_i+W_i)), sum_ST = sum(d_i*S_i + e_i*T_i)
+    ECP_ZZZ sum_R, sum_RW, sum_ST;
+    ECP_ZZZ_inf(&sum_R);
+    ECP_ZZZ_inf(&sum_RW);
+    ECP_ZZZ_inf(&sum_ST);
+
+    for (size_t i = 0; i < num_signatures; i++) {
+        struct ecdaa_signature_ZZZ *signature = &signatures[i];
+        results_out[i] = 0;
+
+        // 1) Check each Schnorr-type signature, and the revocation lists, individually
+        int schnorr_ret = schnorr_verify_ZZZ(signature->c,
+                                             signature->s,
+                                             signature->n,
+                                             &signature->K,
+                                             messages[i],
+                                             message_lens[i],
+                                             &signature->S,
+                                             &signature->W,
+                                             basename,
+                                             basename_len);
+        if (0 != schnorr_ret)
+            results_out[i] = -1;
+
+        if (0 != check_sk_revocations_ZZZ(signature, revocations->sk_list, revocations->sk_length, 0))
+            results_out[i] = -1;
+
+        if (0 != check_bsn_revocations_ZZZ(signature, revocations->bsn_list, revocations->bsn_length, 0))
+            results_out[i] = -1;
+
+        if (0 != results_out[i]) {
             ret = -1;
+            continue;
+        }
+
+        // 2) Weight this signature's pairing equations by random d_i and e_i,
+        //  and add them into the combined equation
+        num_pending++;
+
+        BIG_XXX d, e;
+        random_batch_weight_ZZZ(&d, get_random);
+        random_batch_weight_ZZZ(&e, get_random);
+
+        ECP_ZZZ term;
+
+        ECP_ZZZ_copy(&term, &signature->R);
+        ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ECP_ZZZ_mul(&term, d));
+        ECP_ZZZ_add(&sum_R, &term);
+
+        ECP_ZZZ_copy(&term, &signature->R);
+        ECP_ZZZ_add(&term, &signature->W);
+        ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ECP_ZZZ_mul(&term, e));
+        ECP_ZZZ_add(&sum_RW, &term);
+
+        ECP_ZZZ_copy(&term, &signature->S);
+        ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ECP_ZZZ_mul(&term, d));
+        ECP_ZZZ_add(&sum_ST, &term);
+
+        ECP_ZZZ_copy(&term, &signature->T);
+        ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ECP_ZZZ_mul(&term, e));
+        ECP_ZZZ_add(&sum_ST, &term);
     }
 
-    // 7) Check K against bsn_revocation_list
-    for (size_t i = 0; i < revocations->bsn_length; ++i) {
-        if (ECP_ZZZ_equals(&revocations->bsn_list[i], &signature->K))
-            ret = -1;
+    if (0 == num_pending)
+        return ret;
+
+    // 3) Check e(sum_R, Y) * e(sum_RW, X) * e(-sum_ST, P_2) == 1
+    //  (the product of e(R_i, Y) == e(S_i, P_2) and e(T_i, P_2) == e(R_i+W_i, X)
+    //  over all i, each raised to its random weight)
+    ECP_ZZZ_neg(&sum_ST);
+    ECP_ZZZ *sums[3] = {&sum_R, &sum_RW, &sum_ST};
+    ecp_ZZZ_batch_affine(sums, 3);
+
+    ECP2_ZZZ basepoint2;
+    ecp2_ZZZ_set_to_generator(&basepoint2);
+
+    FP12_YYY product;
+    compute_pairing_product_ZZZ(&product,
+                                &sum_R, &gpk->Y,
+                                &sum_RW, &gpk->X,
+                                &sum_ST, &basepoint2);
+    if (FP12_YYY_isunity(&product))
+        return ret;
+
+    // 4) Some signature's pairing equations don't hold, so find which,
+    //  by checking the pairings of the (not already rejected) signatures one at a time
+    //  (their Schnorr proofs and revocation checks already passed in step 1)
+    ret = -1;
+    for (size_t i = 0; i < num_signatures; i++) {
+        if (0 != results_out[i])
+            continue;
+
+        if (0 != verify_signature_pairings_ZZZ(&signatures[i], gpk, 0))
+            results_out[i] = -1;
     }
 
     return ret;
@@ -155,6 +360,10 @@ void ecdaa_signature_ZZZ_serialize(uint8_t *buffer_out,
                                    struct ecdaa_signature_ZZZ *signature,
                                    int has_nym)
 {
+    // Convert all the points to affine (as serializing requires) with one inversion
+    ECP_ZZZ *points[5] = {&signature->R, &signature->S, &signature->T, &signature->W, &signature->K};
+    ecp_ZZZ_batch_affine(points, has_nym ? 5 : 4);
+
     BIG_XXX_toBytes((char*)buffer_out, signature->c);
     BIG_XXX_toBytes((char*)(buffer_out + MODBYTES_XXX), signature->s);
 
@@ -170,6 +379,40 @@ void ecdaa_signature_ZZZ_serialize(uint8_t *buffer_out,
     }
 }
 
+void ecdaa_signature_ZZZ_serialize_batch(uint8_t *buffer_out,
+                                         struct ecdaa_signature_ZZZ *signatures,
+                                         size_t num_signatures,
+                                         int has_nym)
+{
+    enum { points_per_signature = 5,
+           signatures_per_chunk = ECP_ZZZ_BATCH_AFFINE_CHUNK / points_per_signature };
+
+    size_t sig_length = has_nym ? ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH : ECDAA_SIGNATURE_ZZZ_LENGTH;
+
+    for (size_t first = 0; first < num_signatures; first += signatures_per_chunk) {
+        size_t chunk_len = num_signatures - first;
+        if (chunk_len > signatures_per_chunk)
+            chunk_len = signatures_per_chunk;
+
+        // 1) Convert the chunk's points to affine with one inversion
+        ECP_ZZZ *points[signatures_per_chunk * points_per_signature];
+        size_t num_points = 0;
+        for (size_t i = first; i < first + chunk_len; i++) {
+            points[num_points++] = &signatures[i].R;
+            points[num_points++] = &signatures[i].S;
+            points[num_points++] = &signatures[i].T;
+            points[num_points++] = &signatures[i].W;
+            if (has_nym)
+                points[num_points++] = &signatures[i].K;
+        }
+        ecp_ZZZ_batch_affine(points, num_points);
+
+        // 2) Serialize (now without any inversions)
+        for (size_t i = first; i < first + chunk_len; i++)
+            ecdaa_signature_ZZZ_serialize(buffer_out + i*sig_length, &signatures[i], has_nym);
+    }
+}
+
 int ecdaa_signature_ZZZ_serialize_file(const char* file,
                                    struct ecdaa_signature_ZZZ *signature,
                                    int has_nym)
@@ -340,22 +583,28 @@ void randomize_credential_ZZZ(struct ecdaa_credential_ZZZ *cred,
     // 2) Multiply the four points in the credential by l,
     //  and save to the four points in the signature
 
-    // 2i) Multiply cred->A by l and save to sig->R (R = l*A)
+    //  (R = l*A, S = l*B, T = l*C, W = l*D)
     ECP_ZZZ_copy(&signature_out->R, &cred->A);
-    ECP_ZZZ_mul(&signature_out->R, l);
-
-    // 2ii) Multiply cred->B by l and save to sig->S (S = l*B)
     ECP_ZZZ_copy(&signature_out->S, &cred->B);
-    ECP_ZZZ_mul(&signature_out->S, l);
-
-    // 2iii) Multiply cred->C by l and save to sig->T (T = l*C)
     ECP_ZZZ_copy(&signature_out->T, &cred->C);
-    ECP_ZZZ_mul(&signature_out->T, l);
-
-    // 2iv) Multiply cred->D by l and save to sig->W (W = l*D)
     ECP_ZZZ_copy(&signature_out->W, &cred->D);
-    ECP_ZZZ_mul(&signature_out->W, l);
+    ECP_ZZZ *points[4] = {&signature_out->R, &signature_out->S, &signature_out->T, &signature_out->W};
+    ECDAA_INSTRUMENTATION_BEGIN(mul_start);
+    ecp_ZZZ_mul_secret_multi(points, 4, l, get_random);
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_ECP_MUL, 4, mul_start);
 
     // Clear sensitive intermediate memory.
     BIG_XXX_zero(l);
 }
+
+void random_batch_weight_ZZZ(BIG_XXX *weight_out,
+                             ecdaa_rand_func get_random)
+{
+    // A forged signature passes the combined check with probability about 2^-64
+    //  (all 64 bits are random; zero is redrawn, rather than forcing a bit)
+    uint8_t weight_bytes[MODBYTES_XXX] = {0};
+    do {
+        get_random(weight_bytes + MODBYTES_XXX - 8, 8);
+        BIG_XXX_fromBytes(*weight_out, (char*)weight_bytes);
+    } while (BIG_XXX_iszilch(*weight_out));
+}
@@ -0,0 +1,412 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ecdaa/verifier_kit_ZZZ.h>
+
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "internal-utilities/instrumentation.h"
+
+#include <amcl/amcl.h>
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAGIC "ECDAAVK"
+#define CURVE_NAME_LENGTH 16
+#define BYTE_ORDER_MARK 0x01020304
+#define SECTION_ALIGNMENT 64
+#define CHECKSUM_LENGTH 32
+
+// Written as-is, followed by the sections (each aligned to SECTION_ALIGNMENT):
+//  group public key | sk_length member secret keys | bsn_length pseudonyms |
+//  bsn_length serialized pseudonyms, sorted (the pseudonym index)
+// Every byte of the file is written (padding included), so the checksum covers all of it.
+struct kit_header {
+    char magic[8];
+    char curve[CURVE_NAME_LENGTH];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    // The AMCL build parameters that determine how field elements are represented
+    uint32_t chunk_bits;
+    uint32_t base_bits;
+    uint32_t modulus_bytes;
+    uint32_t modulus_type;
+    // Sizes of the raw structures, which differ between word sizes
+    uint32_t gpk_size;
+    uint32_t sk_size;
+    uint32_t ecp_size;
+    uint32_t pseudonym_size;
+    uint64_t sk_length;
+    uint64_t bsn_length;
+    uint64_t gpk_offset;
+    uint64_t sk_offset;
+    uint64_t bsn_offset;
+    uint64_t bsn_index_offset;
+    uint64_t total_length;
+    // SHA-256 of the whole file, computed with this field zeroed
+    uint8_t checksum[CHECKSUM_LENGTH];
+};
+
+struct ecdaa_verifier_kit_ZZZ {
+    void *map;
+    size_t map_length;
+    // Copied out of the (read-only) mapping, since it's tiny and the pairings take it non-const
+    struct ecdaa_group_public_key_ZZZ gpk;
+    struct ecdaa_revocations_ZZZ revocations;
+    const uint8_t *bsn_index;
+};
+
+static void fill_header(struct kit_header *header_out,
+                        uint64_t sk_length,
+                        uint64_t bsn_length);
+
+static int check_header(const struct kit_header *header,
+                        size_t file_length);
+
+static void compute_checksum(uint8_t *checksum_out,
+                             const uint8_t *contents,
+                             size_t contents_length);
+
+static uint64_t align_up(uint64_t offset);
+
+static int compare_pseudonyms(const void *lhs, const void *rhs);
+
+int ecdaa_verifier_kit_ZZZ_write_file(const char *file,
+                                      struct ecdaa_group_public_key_ZZZ *gpk,
+                                      struct ecdaa_revocations_ZZZ *revocations)
+{
+    struct kit_header header;
+    fill_header(&header, revocations->sk_length, revocations->bsn_length);
+    if (header.total_length > SIZE_MAX)
+        return -3;
+
+    // The kit is built in a zeroed buffer, so struct padding is written as zeros,
+    //  then checksummed and written in one go
+    uint8_t *contents = calloc(1, (size_t)header.total_length);
+    if (NULL == contents)
+        return -3;
+
+    // Points are stored affine, so using them never needs an inversion
+    struct ecdaa_group_public_key_ZZZ *gpk_out = (struct ecdaa_group_public_key_ZZZ*)(contents + header.gpk_offset);
+    ECP2_ZZZ_copy(&gpk_out->X, &gpk->X);
+    ECP2_ZZZ_affine(&gpk_out->X);
+    ECP2_ZZZ_copy(&gpk_out->Y, &gpk->Y);
+    ECP2_ZZZ_affine(&gpk_out->Y);
+
+    struct ecdaa_member_secret_key_ZZZ *sk_out = (struct ecdaa_member_secret_key_ZZZ*)(contents + header.sk_offset);
+    for (size_t i = 0; i < revocations->sk_length; i++)
+        BIG_XXX_copy(sk_out[i].sk, revocations->sk_list[i].sk);
+
+    ECP_ZZZ *bsn_out = (ECP_ZZZ*)(contents + header.bsn_offset);
+    uint8_t *bsn_index_out = contents + header.bsn_index_offset;
+    for (size_t i = 0; i < revocations->bsn_length; i++) {
+        ECP_ZZZ_copy(&bsn_out[i], &revocations->bsn_list[i]);
+        ECP_ZZZ_affine(&bsn_out[i]);
+        ecp_ZZZ_serialize(bsn_index_out + i*ECP_ZZZ_LENGTH, &bsn_out[i]);
+    }
+    if (0 != revocations->bsn_length)
+        qsort(bsn_index_out, revocations->bsn_length, ECP_ZZZ_LENGTH, compare_pseudonyms);
+
+    memcpy(contents, &header, sizeof(header));
+    compute_checksum(contents + offsetof(struct kit_header, checksum), contents, (size_t)header.total_length);
+
+    size_t file_len = strlen(file);
+    char *temp_file = malloc(file_len + sizeof(".XXXXXX"));
+    if (NULL == temp_file) {
+        free(contents);
+        return -3;
+    }
+    memcpy(temp_file, file, file_len);
+    memcpy(temp_file + file_len, ".XXXXXX", sizeof(".XXXXXX"));
+
+    int fd = mkstemp(temp_file);
+    if (-1 == fd) {
+        free(temp_file);
+        free(contents);
+        return -1;
+    }
+
+    // mkstemp creates the file readable only by its owner, but verifiers may run as other users
+    FILE *fp = NULL;
+    if (0 == fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH))
+        fp = fdopen(fd, "wb");
+    if (NULL == fp) {
+        close(fd);
+        unlink(temp_file);
+        free(temp_file);
+        free(contents);
+        return -1;
+    }
+
+    int ret = 0;
+
+    if (1 != fwrite(contents, (size_t)header.total_length, 1, fp))
+        ret = -1;
+
+    if (0 != fclose(fp))
+        ret = -1;
+
+    if (0 == ret && 0 != rename(temp_file, file))
+        ret = -1;
+
+    if (0 != ret)
+        unlink(temp_file);
+    free(temp_file);
+    free(contents);
+
+    return ret;
+}
+
+int ecdaa_verifier_kit_ZZZ_open(struct ecdaa_verifier_kit_ZZZ **kit_out,
+                                const char *file)
+{
+    int fd = open(file, O_RDONLY);
+    if (-1 == fd)
+        return -1;
+
+    struct stat file_stat;
+    if (0 != fstat(fd, &file_stat) || (size_t)file_stat.st_size < sizeof(struct kit_header)) {
+        close(fd);
+        return -1;
+    }
+    size_t map_length = (size_t)file_stat.st_size;
+
+    // Read-only and shared, so every process uses the same pages.
+    // The revocation checks only read the lists:
+    //  the points are stored affine (fully reduced), so AMCL never normalizes them in place.
+    void *map = mmap(NULL, map_length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map)
+        return -1;
+
+    const struct kit_header *header = map;
+    if (0 != check_header(header, map_length)) {
+        munmap(map, map_length);
+        return -1;
+    }
+
+    uint8_t checksum[CHECKSUM_LENGTH];
+    compute_checksum(checksum, map, map_length);
+    if (0 != memcmp(checksum, header->checksum, CHECKSUM_LENGTH)) {
+        munmap(map, map_length);
+        return -1;
+    }
+
+    struct ecdaa_verifier_kit_ZZZ *kit = malloc(sizeof(struct ecdaa_verifier_kit_ZZZ));
+    if (NULL == kit) {
+        munmap(map, map_length);
+        return -3;
+    }
+
+    uint8_t *base = map;
+    kit->map = map;
+    kit->map_length = map_length;
+    struct ecdaa_group_public_key_ZZZ *mapped_gpk = (struct ecdaa_group_public_key_ZZZ*)(base + header->gpk_offset);
+    ECP2_ZZZ_copy(&kit->gpk.X, &mapped_gpk->X);
+    ECP2_ZZZ_copy(&kit->gpk.Y, &mapped_gpk->Y);
+    kit->revocations.sk_length = (size_t)header->sk_length;
+    kit->revocations.sk_list = (0 != header->sk_length) ? (struct ecdaa_member_secret_key_ZZZ*)(base + header->sk_offset) : NULL;
+    kit->revocations.bsn_length = (size_t)header->bsn_length;
+    kit->revocations.bsn_list = (0 != header->bsn_length) ? (ECP_ZZZ*)(base + header->bsn_offset) : NULL;
+    kit->bsn_index = base + header->bsn_index_offset;
+
+    *kit_out = kit;
+
+    return 0;
+}
+
+void ecdaa_verifier_kit_ZZZ_close(struct ecdaa_verifier_kit_ZZZ *kit)
+{
+    if (NULL == kit)
+        return;
+
+    munmap(kit->map, kit->map_length);
+    free(kit);
+}
+
+struct ecdaa_group_public_key_ZZZ *ecdaa_verifier_kit_ZZZ_group_public_key(struct ecdaa_verifier_kit_ZZZ *kit)
+{
+    return &kit->gpk;
+}
+
+struct ecdaa_revocations_ZZZ *ecdaa_verifier_kit_ZZZ_revocations(struct ecdaa_verifier_kit_ZZZ *kit)
+{
+    return &kit->revocations;
+}
+
+int ecdaa_verifier_kit_ZZZ_verify(struct ecdaa_verifier_kit_ZZZ *kit,
+                                  struct ecdaa_signature_ZZZ *signature,
+                                  uint8_t *message,
+                                  uint32_t message_len,
+                                  uint8_t *basename,
+                                  uint32_t basename_len)
+{
+    int ret = 0;
+
+    // 1) Everything but the pseudonym revocation check
+    struct ecdaa_revocations_ZZZ sk_revocations = {.sk_length=kit->revocations.sk_length,
+                                                   .sk_list=kit->revocations.sk_list,
+                                                   .bsn_length=0,
+                                                   .bsn_list=NULL};
+    if (0 != ecdaa_signature_ZZZ_verify(signature, &kit->gpk, &sk_revocations, message, message_len, basename, basename_len))
+        ret = -1;
+
+    // 2) Look K up in the pseudonym index
+    ECP_ZZZ pseudonym;
+    ECP_ZZZ_copy(&pseudonym, &signature->K);
+    uint8_t pseudonym_buffer[ECP_ZZZ_LENGTH];
+    ecp_ZZZ_serialize(pseudonym_buffer, &pseudonym);
+    if (0 != ecdaa_verifier_kit_ZZZ_check_pseudonym(kit, pseudonym_buffer))
+        ret = -1;
+
+    return ret;
+}
+
+int ecdaa_verifier_kit_ZZZ_check_pseudonym(struct ecdaa_verifier_kit_ZZZ *kit,
+                                           const uint8_t *pseudonym)
+{
+    int ret = 0;
+
+    ECDAA_INSTRUMENTATION_BEGIN(bsn_lookup_start);
+    size_t compared = 0;
+    size_t low = 0;
+    size_t high = kit->revocations.bsn_length;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int order = compare_pseudonyms(pseudonym, kit->bsn_index + middle*ECP_ZZZ_LENGTH);
+        compared++;
+        if (0 == order) {
+            ret = -1;
+            break;
+        }
+        if (order < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_BSN_REVOCATION_SCAN, compared, bsn_lookup_start);
+
+    return ret;
+}
+
+static void fill_header(struct kit_header *header_out,
+                        uint64_t sk_length,
+                        uint64_t bsn_length)
+{
+    memset(header_out, 0, sizeof(struct kit_header));
+
+    memcpy(header_out->magic, MAGIC, sizeof(MAGIC));
+    strncpy(header_out->curve, "ZZZ", CURVE_NAME_LENGTH - 1);
+    header_out->version = ECDAA_VERIFIER_KIT_ZZZ_VERSION;
+    header_out->byte_order_mark = BYTE_ORDER_MARK;
+    header_out->chunk_bits = CHUNK;
+    header_out->base_bits = BASEBITS_XXX;
+    header_out->modulus_bytes = MODBYTES_XXX;
+    header_out->modulus_type = MODTYPE_YYY;
+    header_out->gpk_size = sizeof(struct ecdaa_group_public_key_ZZZ);
+    header_out->sk_size = sizeof(struct ecdaa_member_secret_key_ZZZ);
+    header_out->ecp_size = sizeof(ECP_ZZZ);
+    header_out->pseudonym_size = ECP_ZZZ_LENGTH;
+    header_out->sk_length = sk_length;
+    header_out->bsn_length = bsn_length;
+
+    header_out->gpk_offset = align_up(sizeof(struct kit_header));
+    header_out->sk_offset = align_up(header_out->gpk_offset + header_out->gpk_size);
+    header_out->bsn_offset = align_up(header_out->sk_offset + sk_length * header_out->sk_size);
+    header_out->bsn_index_offset = align_up(header_out->bsn_offset + bsn_length * header_out->ecp_size);
+    header_out->total_length = header_out->bsn_index_offset + bsn_length * header_out->pseudonym_size;
+}
+
+static int check_header(const struct kit_header *header,
+                        size_t file_length)
+{
+    // Anything this build would write differently is rejected
+    struct kit_header expected;
+    fill_header(&expected, 0, 0);
+
+    if (0 != memcmp(header->magic, expected.magic, sizeof(expected.magic))
+            || 0 != memcmp(header->curve, expected.curve, sizeof(expected.curve))
+            || expected.version != header->version
+            || expected.byte_order_mark != header->byte_order_mark
+            || expected.chunk_bits != header->chunk_bits
+            || expected.base_bits != header->base_bits
+            || expected.modulus_bytes != header->modulus_bytes
+            || expected.modulus_type != header->modulus_type
+            || expected.gpk_size != header->gpk_size
+            || expected.sk_size != header->sk_size
+            || expected.ecp_size != header->ecp_size
+            || expected.pseudonym_size != header->pseudonym_size)
+        return -1;
+
+    // Bound the list lengths by the file length first, so the offsets below can't overflow
+    if (header->sk_length > file_length / header->sk_size
+            || header->bsn_length > file_length / header->ecp_size)
+        return -1;
+
+    fill_header(&expected, header->sk_length, header->bsn_length);
+    if (expected.gpk_offset != header->gpk_offset
+            || expected.sk_offset != header->sk_offset
+            || expected.bsn_offset != header->bsn_offset
+            || expected.bsn_index_offset != header->bsn_index_offset
+            || expected.total_length != header->total_length
+            || file_length != header->total_length)
+        return -1;
+
+    return 0;
+}
+
+static void compute_checksum(uint8_t *checksum_out,
+                             const uint8_t *contents,
+                             size_t contents_length)
+{
+    size_t checksum_offset = offsetof(struct kit_header, checksum);
+
+    hash256 hash;
+    HASH256_init(&hash);
+    for (size_t i = 0; i < contents_length; i++) {
+        if (i >= checksum_offset && i < checksum_offset + CHECKSUM_LENGTH)
+            HASH256_process(&hash, 0);
+        else
+            HASH256_process(&hash, contents[i]);
+    }
+    HASH256_hash(&hash, (char*)checksum_out);
+}
+
+static uint64_t align_up(uint64_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+static int compare_pseudonyms(const void *lhs, const void *rhs)
+{
+    return memcmp(lhs, rhs, ECP_ZZZ_LENGTH);
+}
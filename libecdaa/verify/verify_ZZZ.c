@@ -0,0 +1,224 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "verify_ZZZ.h"
+
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include "schnorr/schnorr_ZZZ.h"
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+#include "amcl-extensions/pairing_ZZZ.h"
+#include "internal-utilities/instrumentation.h"
+
+#include <amcl/fp12_ZZZ.h>
+
+int verify_signature_proofs_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                struct ecdaa_group_public_key_ZZZ *gpk,
+                                uint8_t *message,
+                                uint32_t message_len,
+                                uint8_t *basename,
+                                uint32_t basename_len)
+{
+    int ret = 0;
+
+    // 1) Check R,S,T,W for membership in group, and R and S for !=inf
+    // NOTE: We assume the signature was obtained from a call to `deserialize`,
+    //  which already checked the validity of the points R,S,T,W
+
+    // 2) Check Schnorr-type signature
+    if (0 != verify_signature_schnorr_ZZZ(signature, message, message_len, basename, basename_len))
+        ret = -1;
+
+    // 3) Check the pairing equations
+    if (0 != verify_signature_pairings_ZZZ(signature, gpk, 0))
+        ret = -1;
+
+    return ret;
+}
+
+int verify_signature_pairings_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                  struct ecdaa_group_public_key_ZZZ *gpk,
+                                  int fail_fast)
+{
+    int ret = 0;
+
+    ECP2_ZZZ basepoint2;
+    ecp2_ZZZ_set_to_generator(&basepoint2);
+
+    // 1) Check e(R, Y) == e(S, P_2)
+    FP12_YYY pairing_one;
+    FP12_YYY pairing_one_prime;
+    compute_pairing_ZZZ(&pairing_one, &signature->R, &gpk->Y);
+    compute_pairing_ZZZ(&pairing_one_prime, &signature->S, &basepoint2);
+    if (!FP12_YYY_equals(&pairing_one, &pairing_one_prime)) {
+        ret = -1;
+        if (fail_fast)
+            return ret;
+    }
+
+    // 2) Compute R+W
+    //      Nb. Add doesn't convert to affine, so do that explicitly
+    ECP_ZZZ RW;
+    ECP_ZZZ_copy(&RW, &signature->R);
+    ECP_ZZZ_add(&RW, &signature->W);
+    ECP_ZZZ_affine(&RW);
+
+    // 3) Check e(T, P_2) == e(R+W, X)
+    FP12_YYY pairing_two;
+    FP12_YYY pairing_two_prime;
+    compute_pairing_ZZZ(&pairing_two, &signature->T, &basepoint2);
+    compute_pairing_ZZZ(&pairing_two_prime, &RW, &gpk->X);
+    if (!FP12_YYY_equals(&pairing_two, &pairing_two_prime))
+        ret = -1;
+
+    return ret;
+}
+
+void verify_signature_pairings_precompute_ZZZ(struct signature_pairings_precomputation_ZZZ *precomputation_out,
+                                              struct ecdaa_signature_ZZZ *signature)
+{
+    ECP2_ZZZ basepoint2;
+    ecp2_ZZZ_set_to_generator(&basepoint2);
+
+    compute_pairing_ZZZ(&precomputation_out->S_P2, &signature->S, &basepoint2);
+    compute_pairing_ZZZ(&precomputation_out->T_P2, &signature->T, &basepoint2);
+
+    //  Nb. Add doesn't convert to affine, so do that explicitly
+    ECP_ZZZ_copy(&precomputation_out->RW, &signature->R);
+    ECP_ZZZ_add(&precomputation_out->RW, &signature->W);
+    ECP_ZZZ_affine(&precomputation_out->RW);
+}
+
+int verify_signature_pairings_precomputed_ZZZ(struct signature_pairings_precomputation_ZZZ *precomputation,
+                                              struct ecdaa_signature_ZZZ *signature,
+                                              struct ecdaa_group_public_key_ZZZ *gpk)
+{
+    // 1) Check e(R, Y) == e(S, P_2)
+    FP12_YYY pairing_one;
+    compute_pairing_ZZZ(&pairing_one, &signature->R, &gpk->Y);
+    if (!FP12_YYY_equals(&pairing_one, &precomputation->S_P2))
+        return -1;
+
+    // 2) Check e(T, P_2) == e(R+W, X)
+    FP12_YYY pairing_two;
+    compute_pairing_ZZZ(&pairing_two, &precomputation->RW, &gpk->X);
+    if (!FP12_YYY_equals(&pairing_two, &precomputation->T_P2))
+        return -1;
+
+    return 0;
+}
+
+int verify_signature_schnorr_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                 uint8_t *message,
+                                 uint32_t message_len,
+                                 uint8_t *basename,
+                                 uint32_t basename_len)
+{
+    return schnorr_verify_ZZZ(signature->c,
+                              signature->s,
+                              signature->n,
+                              &signature->K,
+                              message,
+                              message_len,
+                              &signature->S,
+                              &signature->W,
+                              basename,
+                              basename_len);
+}
+
+int verify_signature_with_issuer_key_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                         struct ecdaa_issuer_secret_key_ZZZ *isk,
+                                         ecdaa_rand_func get_random)
+{
+    int ret = 0;
+
+    // With x and y known, e(R, Y) == e(S, P_2) iff S == y*R,
+    //  and e(T, P_2) == e(R+W, X) iff T == x*(R+W).
+    //  x and y are the issuer's secrets, so multiply by them in constant time.
+
+    // 1) Check S == y*R
+    ECP_ZZZ yR;
+    ECP_ZZZ_copy(&yR, &signature->R);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&yR, isk->y, get_random));
+    if (!ECP_ZZZ_equals(&yR, &signature->S))
+        ret = -1;
+
+    // 2) Check T == x*(R+W)
+    ECP_ZZZ xRW;
+    ECP_ZZZ_copy(&xRW, &signature->R);
+    ECP_ZZZ_add(&xRW, &signature->W);
+    ECP_ZZZ_affine(&xRW);
+    ECDAA_INSTRUMENTED(ECDAA_INSTRUMENTATION_ECP_MUL, ecp_ZZZ_mul_secret(&xRW, isk->x, get_random));
+    if (!ECP_ZZZ_equals(&xRW, &signature->T))
+        ret = -1;
+
+    return ret;
+}
+
+int check_sk_revocations_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                             struct ecdaa_member_secret_key_ZZZ *sk_list,
+                             size_t sk_length,
+                             int fail_fast)
+{
+    int ret = 0;
+
+    ECDAA_INSTRUMENTATION_BEGIN(sk_scan_start);
+    ECP_ZZZ Wcheck;
+    size_t i;
+    for (i = 0; i < sk_length; ++i) {
+        ECP_ZZZ_copy(&Wcheck, &signature->S);
+        ecp_ZZZ_mul_glv(&Wcheck, sk_list[i].sk);
+        if (ECP_ZZZ_equals(&Wcheck, &signature->W)) {
+            ret = -1;
+            if (fail_fast) {
+                ++i;
+                break;
+            }
+        }
+    }
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_SK_REVOCATION_SCAN, i, sk_scan_start);
+
+    return ret;
+}
+
+int check_bsn_revocations_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                              ECP_ZZZ *bsn_list,
+                              size_t bsn_length,
+                              int fail_fast)
+{
+    int ret = 0;
+
+    ECDAA_INSTRUMENTATION_BEGIN(bsn_scan_start);
+    size_t i;
+    for (i = 0; i < bsn_length; ++i) {
+        if (ECP_ZZZ_equals(&bsn_list[i], &signature->K)) {
+            ret = -1;
+            if (fail_fast) {
+                ++i;
+                break;
+            }
+        }
+    }
+    ECDAA_INSTRUMENTATION_END(ECDAA_INSTRUMENTATION_BSN_REVOCATION_SCAN, i, bsn_scan_start);
+
+    return ret;
+}
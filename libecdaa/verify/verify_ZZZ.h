@@ -0,0 +1,156 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_VERIFY_ZZZ_H
+#define ECDAA_VERIFY_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/rand.h>
+
+#include <amcl/ecp_ZZZ.h>
+#include <amcl/fp12_ZZZ.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ecdaa_signature_ZZZ;
+struct ecdaa_group_public_key_ZZZ;
+struct ecdaa_member_secret_key_ZZZ;
+struct ecdaa_issuer_secret_key_ZZZ;
+
+/*
+ * The independent pieces of `ecdaa_signature_ZZZ_verify`,
+ * so they can be scheduled separately (cf. the verify scheduler).
+ */
+
+/*
+ * Check the Schnorr-type signature and the two pairing equations.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if any check fails
+ */
+int verify_signature_proofs_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                struct ecdaa_group_public_key_ZZZ *gpk,
+                                uint8_t *message,
+                                uint32_t message_len,
+                                uint8_t *basename,
+                                uint32_t basename_len);
+
+/*
+ * Check just the Schnorr-type signature.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if the check fails
+ */
+int verify_signature_schnorr_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                 uint8_t *message,
+                                 uint32_t message_len,
+                                 uint8_t *basename,
+                                 uint32_t basename_len);
+
+/*
+ * Check just the two pairing equations.
+ *
+ * Both are always computed, unless `fail_fast` is non-zero,
+ * in which case the second is skipped if the first fails.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if either check fails
+ */
+int verify_signature_pairings_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                  struct ecdaa_group_public_key_ZZZ *gpk,
+                                  int fail_fast);
+
+/*
+ * The half of the pairing equations that doesn't depend on the group:
+ * e(S, P_2), e(T, P_2), and R+W.
+ */
+struct signature_pairings_precomputation_ZZZ {
+    FP12_YYY S_P2;
+    FP12_YYY T_P2;
+    ECP_ZZZ RW;
+};
+
+void verify_signature_pairings_precompute_ZZZ(struct signature_pairings_precomputation_ZZZ *precomputation_out,
+                                              struct ecdaa_signature_ZZZ *signature);
+
+/*
+ * Same as `verify_signature_pairings_ZZZ`, but using the signature's precomputed half,
+ * so only the pairings involving `gpk` (e(R, Y) and e(R+W, X)) are computed.
+ * Returns:
+ * 0 on success
+ * -1 if either check fails
+ */
+int verify_signature_pairings_precomputed_ZZZ(struct signature_pairings_precomputation_ZZZ *precomputation,
+                                              struct ecdaa_signature_ZZZ *signature,
+                                              struct ecdaa_group_public_key_ZZZ *gpk);
+
+/*
+ * Check the equivalent of the two pairing equations, using the issuer's secret key
+ *  (S == y*R and T == x*(R+W)).
+ *
+ * Returns:
+ * 0 on success
+ * -1 if either check fails
+ */
+int verify_signature_with_issuer_key_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                                         struct ecdaa_issuer_secret_key_ZZZ *isk,
+                                         ecdaa_rand_func get_random);
+
+/*
+ * Check W against `sk_length` entries of a secret key revocation list.
+ *
+ * Every entry is checked, unless `fail_fast` is non-zero,
+ * in which case the scan stops at the first match.
+ *
+ * Returns:
+ * 0 if none of them made the signature
+ * -1 if one of them did
+ */
+int check_sk_revocations_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                             struct ecdaa_member_secret_key_ZZZ *sk_list,
+                             size_t sk_length,
+                             int fail_fast);
+
+/*
+ * Check K against `bsn_length` entries of a pseudonym revocation list.
+ *
+ * Every entry is checked, unless `fail_fast` is non-zero,
+ * in which case the scan stops at the first match.
+ *
+ * Returns:
+ * 0 if the pseudonym isn't listed
+ * -1 if it is
+ */
+int check_bsn_revocations_ZZZ(struct ecdaa_signature_ZZZ *signature,
+                              ECP_ZZZ *bsn_list,
+                              size_t bsn_length,
+                              int fail_fast);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
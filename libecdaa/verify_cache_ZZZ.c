@@ -0,0 +1,366 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ecdaa/verify_cache_ZZZ.h>
+
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include "amcl-extensions/ecp_ZZZ.h"
+
+#include <amcl/amcl.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_SHARDS 16
+#define NUM_WAYS 4
+#define DIGEST_LENGTH 32
+
+struct cache_entry {
+    uint64_t last_used;     // 0 if the entry is unused
+    uint8_t digest[DIGEST_LENGTH];
+    int result;
+};
+
+// Each shard is a set-associative table: a digest maps to one set of NUM_WAYS entries,
+// and a full set evicts its least-recently-used entry.
+struct cache_shard {
+    pthread_mutex_t lock;
+    uint64_t clock;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+struct ecdaa_verify_cache_ZZZ {
+    struct cache_shard shards[NUM_SHARDS];
+    struct cache_entry *entries;    // NUM_SHARDS * sets_per_shard sets, of NUM_WAYS entries each
+    size_t sets_per_shard;          // A power of two
+
+    pthread_mutex_t revocations_lock;   // Guards `revocations` and `revocations_digest`
+    struct ecdaa_revocations_ZZZ revocations;
+    uint8_t revocations_digest[DIGEST_LENGTH];  // Of the lists' contents
+};
+
+static void compute_revocations_digest(uint8_t *digest_out,
+                                      struct ecdaa_revocations_ZZZ *revocations);
+
+static void compute_digest(uint8_t *digest_out,
+                           const uint8_t *revocations_digest,
+                           struct ecdaa_group_public_key_ZZZ *gpk,
+                           uint8_t *signature_buffer,
+                           size_t signature_len,
+                           uint8_t *message_buffer,
+                           uint32_t message_len,
+                           uint8_t *basename,
+                           uint32_t basename_len);
+
+static void hash_bytes(hash256 *hash, const uint8_t *bytes, size_t length);
+
+static void hash_uint64(hash256 *hash, uint64_t value);
+
+static struct cache_entry *find_set(struct ecdaa_verify_cache_ZZZ *cache,
+                                    const uint8_t *digest);
+
+static struct cache_entry *find_entry(struct cache_entry *set,
+                                      const uint8_t *digest);
+
+static struct cache_entry *find_victim(struct cache_entry *set);
+
+int ecdaa_verify_cache_ZZZ_new(struct ecdaa_verify_cache_ZZZ **cache_out,
+                               size_t capacity)
+{
+    if (0 == capacity)
+        return -1;
+
+    size_t min_sets = (capacity + NUM_SHARDS*NUM_WAYS - 1) / (NUM_SHARDS*NUM_WAYS);
+    size_t sets_per_shard = 1;
+    while (sets_per_shard < min_sets)
+        sets_per_shard *= 2;
+
+    struct ecdaa_verify_cache_ZZZ *cache = malloc(sizeof(struct ecdaa_verify_cache_ZZZ));
+    if (NULL == cache)
+        return -3;
+
+    cache->entries = calloc(NUM_SHARDS * sets_per_shard * NUM_WAYS, sizeof(struct cache_entry));
+    if (NULL == cache->entries) {
+        free(cache);
+        return -3;
+    }
+    cache->sets_per_shard = sets_per_shard;
+
+    if (0 != pthread_mutex_init(&cache->revocations_lock, NULL)) {
+        free(cache->entries);
+        free(cache);
+        return -3;
+    }
+    cache->revocations.sk_length = 0;
+    cache->revocations.sk_list = NULL;
+    cache->revocations.bsn_length = 0;
+    cache->revocations.bsn_list = NULL;
+    compute_revocations_digest(cache->revocations_digest, &cache->revocations);
+
+    for (size_t i = 0; i < NUM_SHARDS; i++) {
+        if (0 != pthread_mutex_init(&cache->shards[i].lock, NULL)) {
+            while (i-- > 0)
+                pthread_mutex_destroy(&cache->shards[i].lock);
+            pthread_mutex_destroy(&cache->revocations_lock);
+            free(cache->entries);
+            free(cache);
+            return -3;
+        }
+        cache->shards[i].clock = 0;
+        cache->shards[i].hits = 0;
+        cache->shards[i].misses = 0;
+    }
+
+    *cache_out = cache;
+
+    return 0;
+}
+
+void ecdaa_verify_cache_ZZZ_free(struct ecdaa_verify_cache_ZZZ *cache)
+{
+    if (NULL == cache)
+        return;
+
+    for (size_t i = 0; i < NUM_SHARDS; i++)
+        pthread_mutex_destroy(&cache->shards[i].lock);
+    pthread_mutex_destroy(&cache->revocations_lock);
+
+    free(cache->entries);
+    free(cache);
+}
+
+int ecdaa_verify_cache_ZZZ_deserialize_and_verify(struct ecdaa_verify_cache_ZZZ *cache,
+                                                  struct ecdaa_group_public_key_ZZZ *gpk,
+                                                  uint8_t *signature_buffer,
+                                                  uint8_t *message_buffer,
+                                                  uint32_t message_len,
+                                                  uint8_t *basename,
+                                                  uint32_t basename_len,
+                                                  int has_nym)
+{
+    // Snapshot the installed lists, so this call verifies against (and caches under) one set
+    struct ecdaa_revocations_ZZZ revocations;
+    uint8_t revocations_digest[DIGEST_LENGTH];
+    pthread_mutex_lock(&cache->revocations_lock);
+    revocations = cache->revocations;
+    memcpy(revocations_digest, cache->revocations_digest, DIGEST_LENGTH);
+    pthread_mutex_unlock(&cache->revocations_lock);
+
+    size_t signature_len = has_nym ? ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH : ECDAA_SIGNATURE_ZZZ_LENGTH;
+
+    uint8_t digest[DIGEST_LENGTH];
+    compute_digest(digest,
+                   revocations_digest,
+                   gpk,
+                   signature_buffer,
+                   signature_len,
+                   message_buffer,
+                   message_len,
+                   basename,
+                   basename_len);
+
+    struct cache_shard *shard = &cache->shards[digest[0] % NUM_SHARDS];
+    struct cache_entry *set = find_set(cache, digest);
+
+    int hit = 0;
+    int result = 0;
+
+    pthread_mutex_lock(&shard->lock);
+    struct cache_entry *entry = find_entry(set, digest);
+    if (NULL != entry) {
+        entry->last_used = ++shard->clock;
+        shard->hits++;
+        hit = 1;
+        result = entry->result;
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (hit)
+        return result;
+
+    // Verify without holding the lock, so other lookups in this shard aren't blocked
+    struct ecdaa_signature_ZZZ signature;
+    result = ecdaa_signature_ZZZ_deserialize_and_verify(&signature,
+                                                        gpk,
+                                                        &revocations,
+                                                        signature_buffer,
+                                                        message_buffer,
+                                                        message_len,
+                                                        basename,
+                                                        basename_len,
+                                                        has_nym);
+
+    pthread_mutex_lock(&shard->lock);
+    shard->misses++;
+    // Another thread may have cached the same signature in the meantime
+    entry = find_entry(set, digest);
+    if (NULL == entry)
+        entry = find_victim(set);
+    memcpy(entry->digest, digest, DIGEST_LENGTH);
+    entry->result = result;
+    entry->last_used = ++shard->clock;
+    pthread_mutex_unlock(&shard->lock);
+
+    return result;
+}
+
+void ecdaa_verify_cache_ZZZ_set_revocations(struct ecdaa_verify_cache_ZZZ *cache,
+                                             struct ecdaa_revocations_ZZZ *revocations)
+{
+    // Hash outside the lock, so lookups aren't blocked while long lists are hashed
+    uint8_t revocations_digest[DIGEST_LENGTH];
+    compute_revocations_digest(revocations_digest, revocations);
+
+    pthread_mutex_lock(&cache->revocations_lock);
+    cache->revocations = *revocations;
+    memcpy(cache->revocations_digest, revocations_digest, DIGEST_LENGTH);
+    pthread_mutex_unlock(&cache->revocations_lock);
+}
+
+void ecdaa_verify_cache_ZZZ_revocations_changed(struct ecdaa_verify_cache_ZZZ *cache)
+{
+    // Results for the old contents are keyed by the old digest, so they only match again
+    // if the lists return to those contents, and are otherwise evicted as their sets fill up
+    pthread_mutex_lock(&cache->revocations_lock);
+    struct ecdaa_revocations_ZZZ revocations = cache->revocations;
+    pthread_mutex_unlock(&cache->revocations_lock);
+
+    ecdaa_verify_cache_ZZZ_set_revocations(cache, &revocations);
+}
+
+void ecdaa_verify_cache_ZZZ_stats(struct ecdaa_verify_cache_stats_ZZZ *stats_out,
+                                  struct ecdaa_verify_cache_ZZZ *cache)
+{
+    stats_out->hits = 0;
+    stats_out->misses = 0;
+
+    for (size_t i = 0; i < NUM_SHARDS; i++) {
+        pthread_mutex_lock(&cache->shards[i].lock);
+        stats_out->hits += cache->shards[i].hits;
+        stats_out->misses += cache->shards[i].misses;
+        pthread_mutex_unlock(&cache->shards[i].lock);
+    }
+}
+
+static void compute_revocations_digest(uint8_t *digest_out,
+                                      struct ecdaa_revocations_ZZZ *revocations)
+{
+    hash256 hash;
+    HASH256_init(&hash);
+
+    uint8_t sk_buffer[ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH];
+    hash_uint64(&hash, revocations->sk_length);
+    for (size_t i = 0; i < revocations->sk_length; i++) {
+        ecdaa_member_secret_key_ZZZ_serialize(sk_buffer, &revocations->sk_list[i]);
+        hash_bytes(&hash, sk_buffer, sizeof(sk_buffer));
+    }
+
+    uint8_t bsn_buffer[ECP_ZZZ_LENGTH];
+    hash_uint64(&hash, revocations->bsn_length);
+    for (size_t i = 0; i < revocations->bsn_length; i++) {
+        ecp_ZZZ_serialize(bsn_buffer, &revocations->bsn_list[i]);
+        hash_bytes(&hash, bsn_buffer, sizeof(bsn_buffer));
+    }
+
+    HASH256_hash(&hash, (char*)digest_out);
+}
+
+static void compute_digest(uint8_t *digest_out,
+                           const uint8_t *revocations_digest,
+                           struct ecdaa_group_public_key_ZZZ *gpk,
+                           uint8_t *signature_buffer,
+                           size_t signature_len,
+                           uint8_t *message_buffer,
+                           uint32_t message_len,
+                           uint8_t *basename,
+                           uint32_t basename_len)
+{
+    uint8_t gpk_buffer[ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH];
+    ecdaa_group_public_key_ZZZ_serialize(gpk_buffer, gpk);
+
+    // Variable-length inputs are length-prefixed, so different inputs can't collide by concatenation
+    hash256 hash;
+    HASH256_init(&hash);
+    hash_bytes(&hash, revocations_digest, DIGEST_LENGTH);
+    hash_bytes(&hash, gpk_buffer, sizeof(gpk_buffer));
+    hash_uint64(&hash, signature_len);
+    hash_bytes(&hash, signature_buffer, signature_len);
+    hash_uint64(&hash, message_len);
+    hash_bytes(&hash, message_buffer, message_len);
+    hash_uint64(&hash, basename_len);
+    hash_bytes(&hash, basename, basename_len);
+    HASH256_hash(&hash, (char*)digest_out);
+}
+
+static void hash_bytes(hash256 *hash, const uint8_t *bytes, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+        HASH256_process(hash, bytes[i]);
+}
+
+static void hash_uint64(hash256 *hash, uint64_t value)
+{
+    for (size_t i = 0; i < 8; i++)
+        HASH256_process(hash, (uint8_t)(value >> (56 - 8*i)));
+}
+
+static struct cache_entry *find_set(struct ecdaa_verify_cache_ZZZ *cache,
+                                    const uint8_t *digest)
+{
+    // digest[0] picks the shard, so the set index comes from the following bytes
+    uint64_t index = 0;
+    for (size_t i = 1; i < 9; i++)
+        index = (index << 8) | digest[i];
+
+    size_t shard = digest[0] % NUM_SHARDS;
+    size_t set = (size_t)index & (cache->sets_per_shard - 1);
+
+    return &cache->entries[(shard * cache->sets_per_shard + set) * NUM_WAYS];
+}
+
+static struct cache_entry *find_entry(struct cache_entry *set,
+                                      const uint8_t *digest)
+{
+    for (size_t i = 0; i < NUM_WAYS; i++) {
+        if (0 != set[i].last_used && 0 == memcmp(set[i].digest, digest, DIGEST_LENGTH))
+            return &set[i];
+    }
+
+    return NULL;
+}
+
+static struct cache_entry *find_victim(struct cache_entry *set)
+{
+    // Unused entries have `last_used == 0`, so they're picked first
+    struct cache_entry *victim = &set[0];
+    for (size_t i = 1; i < NUM_WAYS; i++) {
+        if (set[i].last_used < victim->last_used)
+            victim = &set[i];
+    }
+
+    return victim;
+}
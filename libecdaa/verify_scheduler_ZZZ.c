@@ -0,0 +1,241 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <ecdaa/verify_scheduler_ZZZ.h>
+
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include "verify/verify_ZZZ.h"
+#include "scheduler/work_stealing_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+struct ecdaa_verify_scheduler_ZZZ {
+    struct ecdaa_work_stealing_pool *pool;
+
+    // Guards every job's `done`, and `in_flight`
+    pthread_mutex_t completion_lock;
+    pthread_cond_t completed;
+    size_t in_flight;
+};
+
+struct job_state;
+
+// Checks one chunk of the secret key revocation list
+struct sk_chunk_task {
+    struct ecdaa_task task;
+    struct job_state *state;
+    size_t first;
+    size_t length;
+};
+
+struct job_state {
+    // Checks the proofs and pseudonym revocations, after queueing the sk chunks
+    struct ecdaa_task root;
+
+    struct ecdaa_verify_scheduler_ZZZ *scheduler;
+    struct ecdaa_verify_job_ZZZ *job;
+
+    // Accessed atomically
+    int failed;
+    size_t remaining;
+
+    size_t num_chunks;
+    struct sk_chunk_task chunks[];
+};
+
+static void run_root(struct ecdaa_task *task, size_t worker);
+
+static void run_sk_chunk(struct ecdaa_task *task, size_t worker);
+
+static void finish_part(struct job_state *state, int part_ret);
+
+int ecdaa_verify_scheduler_ZZZ_new(struct ecdaa_verify_scheduler_ZZZ **scheduler_out,
+                                   size_t num_threads)
+{
+    struct ecdaa_verify_scheduler_ZZZ *scheduler = malloc(sizeof(struct ecdaa_verify_scheduler_ZZZ));
+    if (NULL == scheduler)
+        return -3;
+
+    int pool_ret = ecdaa_work_stealing_pool_new(&scheduler->pool, num_threads);
+    if (0 != pool_ret) {
+        free(scheduler);
+        return pool_ret;
+    }
+
+    pthread_mutex_init(&scheduler->completion_lock, NULL);
+    pthread_cond_init(&scheduler->completed, NULL);
+    scheduler->in_flight = 0;
+
+    *scheduler_out = scheduler;
+
+    return 0;
+}
+
+void ecdaa_verify_scheduler_ZZZ_free(struct ecdaa_verify_scheduler_ZZZ *scheduler)
+{
+    if (NULL == scheduler)
+        return;
+
+    pthread_mutex_lock(&scheduler->completion_lock);
+    while (0 != scheduler->in_flight)
+        pthread_cond_wait(&scheduler->completed, &scheduler->completion_lock);
+    pthread_mutex_unlock(&scheduler->completion_lock);
+
+    // Joins the workers, so no callback is still running after this
+    ecdaa_work_stealing_pool_free(scheduler->pool);
+
+    pthread_cond_destroy(&scheduler->completed);
+    pthread_mutex_destroy(&scheduler->completion_lock);
+    free(scheduler);
+}
+
+int ecdaa_verify_scheduler_ZZZ_submit(struct ecdaa_verify_scheduler_ZZZ *scheduler,
+                                      struct ecdaa_verify_job_ZZZ *job)
+{
+    // 1) Split the sk revocation list, if it's long enough to be worth it
+    size_t sk_length = job->revocations->sk_length;
+    size_t num_chunks = (sk_length + ECDAA_VERIFY_SCHEDULER_SK_CHUNK_LENGTH - 1) / ECDAA_VERIFY_SCHEDULER_SK_CHUNK_LENGTH;
+    if (num_chunks < 2)
+        num_chunks = 0;     // checked by the root task instead
+
+    struct job_state *state = malloc(sizeof(struct job_state) + num_chunks * sizeof(struct sk_chunk_task));
+    if (NULL == state)
+        return -3;
+
+    state->root.run = run_root;
+    state->scheduler = scheduler;
+    state->job = job;
+    state->failed = 0;
+    state->remaining = 1 + num_chunks;
+    state->num_chunks = num_chunks;
+
+    for (size_t i = 0; i < num_chunks; i++) {
+        state->chunks[i].task.run = run_sk_chunk;
+        state->chunks[i].state = state;
+        state->chunks[i].first = i * ECDAA_VERIFY_SCHEDULER_SK_CHUNK_LENGTH;
+        state->chunks[i].length = ECDAA_VERIFY_SCHEDULER_SK_CHUNK_LENGTH;
+    }
+    if (0 != num_chunks)
+        state->chunks[num_chunks - 1].length = sk_length - state->chunks[num_chunks - 1].first;
+
+    pthread_mutex_lock(&scheduler->completion_lock);
+    job->done = 0;
+    scheduler->in_flight++;
+    pthread_mutex_unlock(&scheduler->completion_lock);
+
+    // 2) Queue the root task, which queues the rest once a worker picks it up
+    ecdaa_work_stealing_pool_push(scheduler->pool, &state->root, ECDAA_NOT_A_WORKER);
+
+    return 0;
+}
+
+int ecdaa_verify_scheduler_ZZZ_wait(struct ecdaa_verify_scheduler_ZZZ *scheduler,
+                                    struct ecdaa_verify_job_ZZZ *job)
+{
+    pthread_mutex_lock(&scheduler->completion_lock);
+    while (!job->done)
+        pthread_cond_wait(&scheduler->completed, &scheduler->completion_lock);
+    int result = job->result;
+    pthread_mutex_unlock(&scheduler->completion_lock);
+
+    return result;
+}
+
+void run_root(struct ecdaa_task *task, size_t worker)
+{
+    struct job_state *state = (struct job_state*)task;
+    struct ecdaa_verify_job_ZZZ *job = state->job;
+
+    // 1) Queue the sk chunks on our own deque, for idle workers to steal
+    size_t num_chunks = state->num_chunks;
+    for (size_t i = 0; i < num_chunks; i++)
+        ecdaa_work_stealing_pool_push(state->scheduler->pool, &state->chunks[i].task, worker);
+
+    // 2) Meanwhile, check the proofs and pseudonym revocations
+    int ret = 0;
+    if (0 != verify_signature_proofs_ZZZ(job->signature,
+                                         job->gpk,
+                                         job->message,
+                                         job->message_len,
+                                         job->basename,
+                                         job->basename_len))
+        ret = -1;
+
+    if (0 != check_bsn_revocations_ZZZ(job->signature,
+                                       job->revocations->bsn_list,
+                                       job->revocations->bsn_length,
+                                       0))
+        ret = -1;
+
+    // 3) Short sk revocation lists aren't split
+    if (0 == num_chunks &&
+        0 != check_sk_revocations_ZZZ(job->signature,
+                                      job->revocations->sk_list,
+                                      job->revocations->sk_length,
+                                      0))
+        ret = -1;
+
+    finish_part(state, ret);
+}
+
+void run_sk_chunk(struct ecdaa_task *task, size_t worker)
+{
+    (void)worker;
+
+    struct sk_chunk_task *chunk = (struct sk_chunk_task*)task;
+    struct ecdaa_verify_job_ZZZ *job = chunk->state->job;
+
+    int ret = check_sk_revocations_ZZZ(job->signature,
+                                       job->revocations->sk_list + chunk->first,
+                                       chunk->length,
+                                       0);
+
+    finish_part(chunk->state, ret);
+}
+
+void finish_part(struct job_state *state, int part_ret)
+{
+    if (0 != part_ret)
+        __atomic_store_n(&state->failed, 1, __ATOMIC_RELAXED);
+
+    if (0 != __atomic_sub_fetch(&state->remaining, 1, __ATOMIC_ACQ_REL))
+        return;
+
+    // Last part done: complete the job
+    struct ecdaa_verify_scheduler_ZZZ *scheduler = state->scheduler;
+    struct ecdaa_verify_job_ZZZ *job = state->job;
+    int result = __atomic_load_n(&state->failed, __ATOMIC_RELAXED) ? -1 : 0;
+    ecdaa_verify_callback_ZZZ callback = job->callback;
+    void *user_data = job->user_data;
+    free(state);
+
+    pthread_mutex_lock(&scheduler->completion_lock);
+    job->result = result;
+    job->done = 1;
+    scheduler->in_flight--;
+    pthread_cond_broadcast(&scheduler->completed);
+    pthread_mutex_unlock(&scheduler->completion_lock);
+
+    // The job itself may be gone by now, so only use the copies
+    if (NULL != callback)
+        callback(result, user_data);
+}
@@ -0,0 +1,179 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/basename_session_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <string.h>
+
+static void init_matches_sign();
+static void empty_basename_fails();
+static void sign_with_session_then_verify();
+static void sign_with_session_wrong_basename_fails();
+
+typedef struct session_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+} session_fixture;
+
+static void setup(session_fixture* fixture);
+static void teardown(session_fixture *fixture);
+
+int main()
+{
+    init_matches_sign();
+    empty_basename_fails();
+    sign_with_session_then_verify();
+    sign_with_session_wrong_basename_fails();
+}
+
+static void setup(session_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    fixture->revocations.sk_length=0;
+    fixture->revocations.sk_list=NULL;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+}
+
+static void teardown(session_fixture *fixture)
+{
+    (void)fixture;
+}
+
+static void init_matches_sign()
+{
+    printf("Starting basename_session::init_matches_sign...\n");
+
+    session_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_basename_session_ZZZ session;
+    TEST_ASSERT(0 == ecdaa_basename_session_ZZZ_init(&session, fixture.basename, fixture.basename_len, &fixture.sk, test_randomness));
+
+    ECP_ZZZ P2;
+    TEST_ASSERT(0 <= ecp_ZZZ_fromhash(&P2, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(ECP_ZZZ_equals(&P2, &session.P2));
+
+    // The session's pseudonym is the one in an ordinary basename signature
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+    TEST_ASSERT(ECP_ZZZ_equals(&sig.K, &session.K));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void empty_basename_fails()
+{
+    printf("Starting basename_session::empty_basename_fails...\n");
+
+    session_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_basename_session_ZZZ session;
+    TEST_ASSERT(0 != ecdaa_basename_session_ZZZ_init(&session, NULL, 0, &fixture.sk, test_randomness));
+    TEST_ASSERT(0 != ecdaa_basename_session_ZZZ_init(&session, fixture.basename, 0, &fixture.sk, test_randomness));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_with_session_then_verify()
+{
+    printf("Starting basename_session::sign_with_session_then_verify...\n");
+
+    session_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_basename_session_ZZZ session;
+    TEST_ASSERT(0 == ecdaa_basename_session_ZZZ_init(&session, fixture.basename, fixture.basename_len, &fixture.sk, test_randomness));
+
+    for (int i = 0; i < 3; i++) {
+        struct ecdaa_signature_ZZZ sig;
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign_with_session(&sig, fixture.msg, fixture.msg_len, &session, &fixture.sk, &fixture.cred, test_randomness));
+
+        TEST_ASSERT(ECP_ZZZ_equals(&sig.K, &session.K));
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    }
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_with_session_wrong_basename_fails()
+{
+    printf("Starting basename_session::sign_with_session_wrong_basename_fails...\n");
+
+    session_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_basename_session_ZZZ session;
+    TEST_ASSERT(0 == ecdaa_basename_session_ZZZ_init(&session, fixture.basename, fixture.basename_len, &fixture.sk, test_randomness));
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign_with_session(&sig, fixture.msg, fixture.msg_len, &session, &fixture.sk, &fixture.cred, test_randomness));
+
+    uint8_t *wrong_basename = (uint8_t*) "WRONG_BASENAME";
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, wrong_basename, (uint32_t)strlen((char*)wrong_basename)));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -43,6 +43,7 @@ static void setup(credential_test_fixture* fixture);
 static void teardown(credential_test_fixture* fixture);
 
 static void cred_generate_then_validate();
+static void cred_generate_then_validate_with_issuer_key();
 static void lengths_same();
 static void cred_generate_then_serialize_deserialize();
 static void cred_generate_then_serialize_deserialize_file();
@@ -51,6 +52,7 @@ static void cred_generate_then_serialize_deserialize_fp();
 int main()
 {
     cred_generate_then_validate();
+    cred_generate_then_validate_with_issuer_key();
     lengths_same();
     cred_generate_then_serialize_deserialize();
     cred_generate_then_serialize_deserialize_file();
@@ -95,6 +97,29 @@ static void cred_generate_then_validate()
     printf("\tsuccess\n");
 }
 
+static void cred_generate_then_validate_with_issuer_key()
+{
+    printf("Starting credential::cred_generate_then_validate_with_issuer_key...\n");
+
+    credential_test_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    TEST_ASSERT(0 == ecdaa_credential_ZZZ_generate(&cred, &cred_sig, &fixture.isk, &fixture.pk, test_randomness));
+
+    TEST_ASSERT(0 == ecdaa_credential_ZZZ_validate_with_issuer_key(&cred, &cred_sig, &fixture.pk, &fixture.isk, test_randomness));
+
+    struct ecdaa_issuer_secret_key_ZZZ other_isk;
+    ecp_ZZZ_random_mod_order(&other_isk.x, test_randomness);
+    ecp_ZZZ_random_mod_order(&other_isk.y, test_randomness);
+    TEST_ASSERT(0 != ecdaa_credential_ZZZ_validate_with_issuer_key(&cred, &cred_sig, &fixture.pk, &other_isk, test_randomness));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
 static void lengths_same()
 {
     printf("Starting credential::lengths_same...\n");
@@ -0,0 +1,270 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/curve.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <string.h>
+
+static void lookup_by_name();
+static void lengths_match();
+static void unknown_curve_fails();
+static void sign_then_verify_good();
+static void sign_then_verify_no_basename();
+static void verify_wrong_message_fails();
+static void verify_on_rev_lists_fails();
+static void bad_gpk_fails();
+
+typedef struct curve_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    uint8_t gpk_buffer[ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH];
+    uint8_t sk_buffer[ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH];
+    uint8_t cred_buffer[ECDAA_CREDENTIAL_ZZZ_LENGTH];
+    struct ecdaa_verifier_context *verifier;
+    struct ecdaa_member_context *member;
+} curve_fixture;
+
+static void setup(curve_fixture* fixture);
+static void teardown(curve_fixture *fixture);
+
+int main()
+{
+    lookup_by_name();
+    lengths_match();
+    unknown_curve_fails();
+    sign_then_verify_good();
+    sign_then_verify_no_basename();
+    verify_wrong_message_fails();
+    verify_on_rev_lists_fails();
+    bad_gpk_fails();
+}
+
+static void setup(curve_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    ecdaa_group_public_key_ZZZ_serialize(fixture->gpk_buffer, &fixture->ipk.gpk);
+    ecdaa_member_secret_key_ZZZ_serialize(fixture->sk_buffer, &fixture->sk);
+    ecdaa_credential_ZZZ_serialize(fixture->cred_buffer, &fixture->cred);
+
+    TEST_ASSERT(0 == ecdaa_verifier_context_new(&fixture->verifier, ECDAA_CURVE_ZZZ, fixture->gpk_buffer));
+    TEST_ASSERT(0 == ecdaa_member_context_new(&fixture->member, ECDAA_CURVE_ZZZ, fixture->sk_buffer, fixture->cred_buffer));
+}
+
+static void teardown(curve_fixture *fixture)
+{
+    ecdaa_verifier_context_free(fixture->verifier);
+    ecdaa_member_context_free(fixture->member);
+}
+
+static void lookup_by_name()
+{
+    printf("Starting curve::lookup_by_name...\n");
+
+    TEST_ASSERT(1 == ecdaa_curve_is_supported(ECDAA_CURVE_ZZZ));
+
+    enum ecdaa_curve_id curve;
+    TEST_ASSERT(0 == ecdaa_curve_from_name(&curve, "ZZZ"));
+    TEST_ASSERT(ECDAA_CURVE_ZZZ == curve);
+    TEST_ASSERT(0 == strcmp("ZZZ", ecdaa_curve_name(ECDAA_CURVE_ZZZ)));
+
+    TEST_ASSERT(-1 == ecdaa_curve_from_name(&curve, "NOTACURVE"));
+
+    printf("\tsuccess\n");
+}
+
+static void lengths_match()
+{
+    printf("Starting curve::lengths_match...\n");
+
+    TEST_ASSERT(ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH == ecdaa_curve_group_public_key_length(ECDAA_CURVE_ZZZ));
+    TEST_ASSERT(ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH == ecdaa_curve_member_secret_key_length(ECDAA_CURVE_ZZZ));
+    TEST_ASSERT(ECDAA_CREDENTIAL_ZZZ_LENGTH == ecdaa_curve_credential_length(ECDAA_CURVE_ZZZ));
+    TEST_ASSERT(ECDAA_SIGNATURE_ZZZ_LENGTH == ecdaa_curve_signature_length(ECDAA_CURVE_ZZZ, 0));
+    TEST_ASSERT(ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH == ecdaa_curve_signature_length(ECDAA_CURVE_ZZZ, 1));
+    TEST_ASSERT(ECP_ZZZ_LENGTH == ecdaa_curve_pseudonym_length(ECDAA_CURVE_ZZZ));
+
+    printf("\tsuccess\n");
+}
+
+static void unknown_curve_fails()
+{
+    printf("Starting curve::unknown_curve_fails...\n");
+
+    enum ecdaa_curve_id bogus = (enum ecdaa_curve_id)0;
+
+    TEST_ASSERT(0 == ecdaa_curve_is_supported(bogus));
+    TEST_ASSERT(NULL == ecdaa_curve_name(bogus));
+    TEST_ASSERT(0 == ecdaa_curve_signature_length(bogus, 1));
+
+    uint8_t buffer[ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH] = {0};
+    struct ecdaa_verifier_context *verifier;
+    TEST_ASSERT(-2 == ecdaa_verifier_context_new(&verifier, bogus, buffer));
+    struct ecdaa_member_context *member;
+    TEST_ASSERT(-2 == ecdaa_member_context_new(&member, bogus, buffer, buffer));
+
+    printf("\tsuccess\n");
+}
+
+static void sign_then_verify_good()
+{
+    printf("Starting curve::sign_then_verify_good...\n");
+
+    curve_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(ECDAA_CURVE_ZZZ == ecdaa_verifier_context_curve(fixture.verifier));
+    TEST_ASSERT(ECDAA_CURVE_ZZZ == ecdaa_member_context_curve(fixture.member));
+
+    uint8_t sig_buffer[ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+    TEST_ASSERT(0 == ecdaa_member_context_sign(fixture.member, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, test_randomness));
+
+    TEST_ASSERT(0 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // And the curve-specific API agrees
+    struct ecdaa_signature_ZZZ sig;
+    struct ecdaa_revocations_ZZZ revocations = {.sk_length=0, .sk_list=NULL, .bsn_length=0, .bsn_list=NULL};
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_deserialize_and_verify(&sig, &fixture.ipk.gpk, &revocations, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, 1));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_then_verify_no_basename()
+{
+    printf("Starting curve::sign_then_verify_no_basename...\n");
+
+    curve_fixture fixture;
+    setup(&fixture);
+
+    uint8_t sig_buffer[ECDAA_SIGNATURE_ZZZ_LENGTH];
+    TEST_ASSERT(0 == ecdaa_member_context_sign(fixture.member, sig_buffer, fixture.msg, fixture.msg_len, NULL, 0, test_randomness));
+
+    TEST_ASSERT(0 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, fixture.msg, fixture.msg_len, NULL, 0));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_wrong_message_fails()
+{
+    printf("Starting curve::verify_wrong_message_fails...\n");
+
+    curve_fixture fixture;
+    setup(&fixture);
+
+    uint8_t sig_buffer[ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+    TEST_ASSERT(0 == ecdaa_member_context_sign(fixture.member, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, test_randomness));
+
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    TEST_ASSERT(-2 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, wrong_msg, (uint32_t)strlen((char*)wrong_msg), fixture.basename, fixture.basename_len));
+
+    // Corrupt the point-format byte of R
+    sig_buffer[2*MODBYTES_XXX] = 0x3;
+    TEST_ASSERT(-1 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_on_rev_lists_fails()
+{
+    printf("Starting curve::verify_on_rev_lists_fails...\n");
+
+    curve_fixture fixture;
+    setup(&fixture);
+
+    uint8_t sig_buffer[ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+    TEST_ASSERT(0 == ecdaa_member_context_sign(fixture.member, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, test_randomness));
+
+    // Secret-key revocation
+    TEST_ASSERT(0 == ecdaa_verifier_context_set_revocations(fixture.verifier, fixture.sk_buffer, 1, NULL, 0));
+    TEST_ASSERT(-2 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Basename revocation
+    uint8_t *pseudonym;
+    uint32_t pseudonym_length;
+    ecdaa_signature_ZZZ_access_pseudonym_in_serialized(&pseudonym, &pseudonym_length, sig_buffer);
+    TEST_ASSERT(ecdaa_curve_pseudonym_length(ECDAA_CURVE_ZZZ) == pseudonym_length);
+    TEST_ASSERT(0 == ecdaa_verifier_context_set_revocations(fixture.verifier, NULL, 0, pseudonym, 1));
+    TEST_ASSERT(-2 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Malformed entry leaves the old lists in place
+    uint8_t bad_point[ECP_ZZZ_LENGTH] = {0};
+    TEST_ASSERT(-1 == ecdaa_verifier_context_set_revocations(fixture.verifier, NULL, 0, bad_point, 1));
+    TEST_ASSERT(-2 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Clearing the lists
+    TEST_ASSERT(0 == ecdaa_verifier_context_set_revocations(fixture.verifier, NULL, 0, NULL, 0));
+    TEST_ASSERT(0 == ecdaa_verifier_context_verify(fixture.verifier, sig_buffer, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void bad_gpk_fails()
+{
+    printf("Starting curve::bad_gpk_fails...\n");
+
+    uint8_t buffer[ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH] = {0};
+    struct ecdaa_verifier_context *verifier;
+    TEST_ASSERT(-1 == ecdaa_verifier_context_new(&verifier, ECDAA_CURVE_ZZZ, buffer));
+
+    printf("\tsuccess\n");
+}
@@ -18,6 +18,7 @@
 
 #include "ecdaa-test-utils.h"
 
+#include "amcl-extensions/ecp_ZZZ.h"
 #include "amcl-extensions/ecp2_ZZZ.h"
 
 #include <stdio.h>
@@ -28,6 +29,8 @@ static void g2_serialize_then_deserialize_basepoint();
 static void g2_lengths_same();
 static void g2_deserialize_badformat_fails();
 static void g2_deserialize_badcoords_fails();
+static void g2_deserialize_checks_subgroup();
+static void mul_gls_matches_mul();
 
 int main()
 {
@@ -36,6 +39,8 @@ int main()
     g2_lengths_same();
     g2_deserialize_badformat_fails();
     g2_deserialize_badcoords_fails();
+    g2_deserialize_checks_subgroup();
+    mul_gls_matches_mul();
 
     return 0;
 }
@@ -106,3 +111,61 @@ static void g2_deserialize_badcoords_fails()
 
     printf("\tsuccess\n");
 }
+
+static void g2_deserialize_checks_subgroup()
+{
+    printf("Starting ecp2_ZZZ::g2_deserialize_checks_subgroup...\n");
+
+    uint8_t buffer[ECP2_ZZZ_LENGTH];
+    ECP2_ZZZ deserialized_point;
+
+    for (int i = 0; i < 20; i++) {
+        BIG_XXX scalar;
+        ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+
+        ECP2_ZZZ point;
+        ecp2_ZZZ_set_to_generator(&point);
+        ECP2_ZZZ_mul(&point, scalar);
+
+        ecp2_ZZZ_serialize(buffer, &point);
+        TEST_ASSERT(0 == ecp2_ZZZ_deserialize(&deserialized_point, buffer));
+    }
+
+    // The twist always has a cofactor, so an arbitrary point on it is (almost surely) outside G2
+    BIG_XXX xa, xb;
+    BIG_XXX_one(xa);
+    BIG_XXX_zero(xb);
+    FP2_YYY x;
+    ECP2_ZZZ point;
+    do {
+        BIG_XXX_inc(xa, 1);
+        FP2_YYY_from_BIGs(&x, xa, xb);
+    } while (!ECP2_ZZZ_setx(&point, &x));
+
+    ecp2_ZZZ_serialize(buffer, &point);
+    TEST_ASSERT(-1 == ecp2_ZZZ_deserialize(&deserialized_point, buffer));
+
+    printf("\tsuccess\n");
+}
+
+static void mul_gls_matches_mul()
+{
+    printf("Starting ecp2_ZZZ::mul_gls_matches_mul...\n");
+
+    for (int i = 0; i < 50; i++) {
+        BIG_XXX scalar;
+        ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+
+        ECP2_ZZZ expected;
+        ecp2_ZZZ_set_to_generator(&expected);
+        ECP2_ZZZ_mul(&expected, scalar);
+
+        ECP2_ZZZ actual;
+        ecp2_ZZZ_set_to_generator(&actual);
+        ecp2_ZZZ_mul_gls(&actual, scalar);
+
+        TEST_ASSERT(ECP2_ZZZ_equals(&expected, &actual));
+    }
+
+    printf("\tsuccess\n");
+}
@@ -28,7 +28,13 @@ static void g1_serialize_then_deserialize_basepoint();
 static void g1_lengths_same();
 static void g1_deserialize_badformat_fails();
 static void g1_deserialize_badcoords_fails();
+static void g1_deserialize_checks_subgroup();
 static void random_num_mod_order_is_valid();
+static void mul_glv_matches_mul();
+static void mul_secret_matches_mul();
+static void mul_secret_fixed_base_matches_mul();
+static void mul_secret_multi_matches_mul();
+static void batch_affine_matches_affine();
 
 int main()
 {
@@ -37,7 +43,13 @@ int main()
     g1_lengths_same();
     g1_deserialize_badformat_fails();
     g1_deserialize_badcoords_fails();
+    g1_deserialize_checks_subgroup();
     random_num_mod_order_is_valid();
+    mul_glv_matches_mul();
+    mul_secret_matches_mul();
+    mul_secret_fixed_base_matches_mul();
+    mul_secret_multi_matches_mul();
+    batch_affine_matches_affine();
 
     return 0;
 }
@@ -109,6 +121,46 @@ static void g1_deserialize_badcoords_fails()
     printf("\tsuccess\n");
 }
 
+static void g1_deserialize_checks_subgroup()
+{
+    printf("Starting ecp_ZZZ::g1_deserialize_checks_subgroup...\n");
+
+    uint8_t buffer[ECP_ZZZ_LENGTH];
+    ECP_ZZZ deserialized_point;
+
+    for (int i = 0; i < 20; i++) {
+        BIG_XXX scalar;
+        ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+
+        ECP_ZZZ point;
+        ecp_ZZZ_set_to_generator(&point);
+        ECP_ZZZ_mul(&point, scalar);
+
+        ecp_ZZZ_serialize(buffer, &point);
+        TEST_ASSERT(0 == ecp_ZZZ_deserialize(&deserialized_point, buffer));
+    }
+
+    // With a cofactor, some points on the curve are outside G1
+    BIG_XXX cofactor;
+    BIG_XXX_rcopy(cofactor, CURVE_Cof_ZZZ);
+    if (!BIG_XXX_isunity(cofactor)) {
+        BIG_XXX x;
+        BIG_XXX_one(x);
+        ECP_ZZZ point;
+        while (!ECP_ZZZ_setx(&point, x, 0))
+            BIG_XXX_inc(x, 1);
+
+        ecp_ZZZ_serialize(buffer, &point);
+        TEST_ASSERT(-1 == ecp_ZZZ_deserialize(&deserialized_point, buffer));
+
+        ECP_ZZZ_mul(&point, cofactor);
+        ecp_ZZZ_serialize(buffer, &point);
+        TEST_ASSERT(0 == ecp_ZZZ_deserialize(&deserialized_point, buffer));
+    }
+
+    printf("\tsuccess\n");
+}
+
 void random_num_mod_order_is_valid()
 {
     printf("Starting pairing_curve_utils::random_num_mod_order_is_valid...\n");
@@ -133,3 +185,184 @@ void random_num_mod_order_is_valid()
 
     printf("\tsuccess\n");
 }
+
+static void mul_glv_matches_mul()
+{
+    printf("Starting ecp_ZZZ::mul_glv_matches_mul...\n");
+
+    for (int i = 0; i < 50; i++) {
+        BIG_XXX scalar;
+        ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+
+        ECP_ZZZ expected;
+        ecp_ZZZ_set_to_generator(&expected);
+        ECP_ZZZ_mul(&expected, scalar);
+
+        ECP_ZZZ actual;
+        ecp_ZZZ_set_to_generator(&actual);
+        ecp_ZZZ_mul_glv(&actual, scalar);
+
+        TEST_ASSERT(ECP_ZZZ_equals(&expected, &actual));
+    }
+
+    printf("\tsuccess\n");
+}
+
+static void mul_secret_matches_mul()
+{
+    printf("Starting ecp_ZZZ::mul_secret_matches_mul...\n");
+
+    BIG_XXX curve_order;
+    BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
+
+    for (int i = 0; i < 53; i++) {
+        BIG_XXX scalar;
+        if (0 == i) {
+            BIG_XXX_zero(scalar);
+        } else if (1 == i) {
+            BIG_XXX_one(scalar);
+        } else if (2 == i) {
+            BIG_XXX_copy(scalar, curve_order);
+            BIG_XXX_dec(scalar, 1);
+            BIG_XXX_norm(scalar);
+        } else {
+            ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+        }
+
+        ECP_ZZZ expected;
+        ecp_ZZZ_set_to_generator(&expected);
+        ECP_ZZZ_mul(&expected, scalar);
+
+        ECP_ZZZ actual;
+        ecp_ZZZ_set_to_generator(&actual);
+        ecp_ZZZ_mul_secret(&actual, scalar, test_randomness);
+
+        TEST_ASSERT(ECP_ZZZ_equals(&expected, &actual));
+    }
+
+    printf("\tsuccess\n");
+}
+
+static void mul_secret_fixed_base_matches_mul()
+{
+    printf("Starting ecp_ZZZ::mul_secret_fixed_base_matches_mul...\n");
+
+    BIG_XXX curve_order;
+    BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
+
+    ECP_ZZZ base;
+    uint8_t *basename = (uint8_t*) "BASENAME";
+    TEST_ASSERT(0 <= ecp_ZZZ_fromhash(&base, basename, (uint32_t)strlen((char*)basename)));
+
+    ECP_ZZZ table[ECP_ZZZ_FIXED_BASE_TABLE_SIZE];
+    ecp_ZZZ_fixed_base_table_init(table, &base);
+
+    for (int i = 0; i < 53; i++) {
+        BIG_XXX scalar;
+        if (0 == i) {
+            BIG_XXX_zero(scalar);
+        } else if (1 == i) {
+            BIG_XXX_one(scalar);
+        } else if (2 == i) {
+            BIG_XXX_copy(scalar, curve_order);
+            BIG_XXX_dec(scalar, 1);
+            BIG_XXX_norm(scalar);
+        } else {
+            ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+        }
+
+        ECP_ZZZ expected;
+        ECP_ZZZ_copy(&expected, &base);
+        ECP_ZZZ_mul(&expected, scalar);
+
+        ECP_ZZZ actual;
+        ecp_ZZZ_mul_secret_fixed_base(&actual, table, scalar, test_randomness);
+
+        TEST_ASSERT(ECP_ZZZ_equals(&expected, &actual));
+    }
+
+    printf("\tsuccess\n");
+}
+
+static void mul_secret_multi_matches_mul()
+{
+    printf("Starting ecp_ZZZ::mul_secret_multi_matches_mul...\n");
+
+    for (size_t num_points = 1; num_points <= ECP_ZZZ_MUL_SECRET_MULTI_MAX; num_points++) {
+        BIG_XXX scalar;
+        ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+
+        ECP_ZZZ expected[ECP_ZZZ_MUL_SECRET_MULTI_MAX];
+        ECP_ZZZ actual[ECP_ZZZ_MUL_SECRET_MULTI_MAX];
+        ECP_ZZZ *actual_ptrs[ECP_ZZZ_MUL_SECRET_MULTI_MAX];
+        for (size_t j = 0; j < num_points; j++) {
+            // Distinct bases
+            BIG_XXX base_scalar;
+            ecp_ZZZ_random_mod_order(&base_scalar, test_randomness);
+            ecp_ZZZ_set_to_generator(&actual[j]);
+            ECP_ZZZ_mul(&actual[j], base_scalar);
+            actual_ptrs[j] = &actual[j];
+
+            ECP_ZZZ_copy(&expected[j], &actual[j]);
+            ECP_ZZZ_mul(&expected[j], scalar);
+        }
+
+        ecp_ZZZ_mul_secret_multi(actual_ptrs, num_points, scalar, test_randomness);
+
+        for (size_t j = 0; j < num_points; j++)
+            TEST_ASSERT(ECP_ZZZ_equals(&expected[j], &actual[j]));
+    }
+
+    printf("\tsuccess\n");
+}
+
+static void batch_affine_matches_affine()
+{
+    printf("Starting ecp_ZZZ::batch_affine_matches_affine...\n");
+
+    // More than one chunk, with some points at infinity and some already affine
+    enum { num_points = ECP_ZZZ_BATCH_AFFINE_CHUNK + 10 };
+
+    ECP_ZZZ generator;
+    ecp_ZZZ_set_to_generator(&generator);
+
+    ECP_ZZZ points[num_points];
+    ECP_ZZZ *point_ptrs[num_points];
+    ECP_ZZZ expected[num_points];
+    for (size_t i = 0; i < num_points; i++) {
+        if (0 == i % 7) {
+            ECP_ZZZ_inf(&points[i]);
+        } else {
+            BIG_XXX scalar;
+            ecp_ZZZ_random_mod_order(&scalar, test_randomness);
+            ecp_ZZZ_set_to_generator(&points[i]);
+            ECP_ZZZ_mul(&points[i], scalar);
+            if (0 != i % 5)
+                ECP_ZZZ_add(&points[i], &generator);    // projective
+        }
+        point_ptrs[i] = &points[i];
+
+        ECP_ZZZ_copy(&expected[i], &points[i]);
+        ECP_ZZZ_affine(&expected[i]);
+    }
+
+    ecp_ZZZ_batch_affine(point_ptrs, num_points);
+
+    FP_YYY one;
+    FP_YYY_one(&one);
+    for (size_t i = 0; i < num_points; i++) {
+        TEST_ASSERT(ECP_ZZZ_equals(&expected[i], &points[i]));
+
+        if (!ECP_ZZZ_isinf(&points[i])) {
+            TEST_ASSERT(FP_YYY_equals(&one, &points[i].z));
+
+            uint8_t expected_buffer[ECP_ZZZ_LENGTH];
+            uint8_t buffer[ECP_ZZZ_LENGTH];
+            ecp_ZZZ_serialize(expected_buffer, &expected[i]);
+            ecp_ZZZ_serialize(buffer, &points[i]);
+            TEST_ASSERT(0 == memcmp(expected_buffer, buffer, ECP_ZZZ_LENGTH));
+        }
+    }
+
+    printf("\tsuccess\n");
+}
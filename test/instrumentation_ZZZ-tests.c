@@ -0,0 +1,329 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/instrumentation.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <string.h>
+
+static void event_names();
+static void disabled_reports_error();
+static void verify_counts();
+static void callback_invoked();
+static void fail_fast_skips_pairings();
+static void revoked_scan_exhaustive_unless_fail_fast();
+static void multi_group_shares_pairings();
+
+typedef struct instrumentation_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list[3];
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_signature_ZZZ sig;
+} instrumentation_fixture;
+
+static void setup(instrumentation_fixture* fixture);
+static void teardown(instrumentation_fixture *fixture);
+
+int main()
+{
+    event_names();
+    disabled_reports_error();
+    verify_counts();
+    callback_invoked();
+    fail_fast_skips_pairings();
+    revoked_scan_exhaustive_unless_fail_fast();
+    multi_group_shares_pairings();
+}
+
+static void setup(instrumentation_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    // Revocation list of other (random) members, so the signature still verifies
+    for (size_t i = 0; i < 3; i++)
+        ecp_ZZZ_random_mod_order(&fixture->sk_rev_list[i].sk, test_randomness);
+    fixture->revocations.sk_length=3;
+    fixture->revocations.sk_list=fixture->sk_rev_list;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&fixture->sig, fixture->msg, fixture->msg_len, fixture->basename, fixture->basename_len, &fixture->sk, &fixture->cred, test_randomness));
+}
+
+static void teardown(instrumentation_fixture *fixture)
+{
+    (void)fixture;
+}
+
+static void event_names()
+{
+    printf("Starting instrumentation::event_names...\n");
+
+    for (int i = 0; i < ECDAA_INSTRUMENTATION_EVENT_COUNT; i++)
+        TEST_ASSERT(NULL != ecdaa_instrumentation_event_name((enum ecdaa_instrumentation_event)i));
+
+    TEST_ASSERT(NULL == ecdaa_instrumentation_event_name(ECDAA_INSTRUMENTATION_EVENT_COUNT));
+
+    printf("\tsuccess\n");
+}
+
+static void disabled_reports_error()
+{
+    printf("Starting instrumentation::disabled_reports_error...\n");
+
+    if (ecdaa_instrumentation_enabled()) {
+        printf("\tskipped (instrumentation enabled)\n");
+        return;
+    }
+
+    struct ecdaa_instrumentation_counter counter;
+    TEST_ASSERT(-1 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_PAIRING));
+    TEST_ASSERT(-1 == ecdaa_instrumentation_set_callback(NULL, NULL));
+
+    printf("\tsuccess\n");
+}
+
+static void verify_counts()
+{
+    printf("Starting instrumentation::verify_counts...\n");
+
+    if (!ecdaa_instrumentation_enabled()) {
+        printf("\tskipped (instrumentation disabled)\n");
+        return;
+    }
+
+    instrumentation_fixture fixture;
+    setup(&fixture);
+
+    ecdaa_instrumentation_reset();
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&fixture.sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    struct ecdaa_instrumentation_counter counter;
+
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_PAIRING));
+    TEST_ASSERT(4 == counter.calls);
+    TEST_ASSERT(4 == counter.items);
+    TEST_ASSERT(0 != counter.nanoseconds);
+
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_HASH_TO_CURVE));
+    TEST_ASSERT(1 == counter.calls);
+    TEST_ASSERT(counter.items >= 1);
+
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_SK_REVOCATION_SCAN));
+    TEST_ASSERT(1 == counter.calls);
+    TEST_ASSERT(3 == counter.items);
+
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_ECP_MUL));
+    TEST_ASSERT(4 == counter.calls);
+
+    ecdaa_instrumentation_reset();
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_PAIRING));
+    TEST_ASSERT(0 == counter.calls);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void count_pairings(enum ecdaa_instrumentation_event event,
+                           uint64_t items,
+                           uint64_t nanoseconds,
+                           void *user_data)
+{
+    (void)items;
+    (void)nanoseconds;
+
+    if (ECDAA_INSTRUMENTATION_PAIRING == event)
+        *(unsigned*)user_data += 1;
+}
+
+static void callback_invoked()
+{
+    printf("Starting instrumentation::callback_invoked...\n");
+
+    if (!ecdaa_instrumentation_enabled()) {
+        printf("\tskipped (instrumentation disabled)\n");
+        return;
+    }
+
+    instrumentation_fixture fixture;
+    setup(&fixture);
+
+    unsigned pairings = 0;
+    TEST_ASSERT(0 == ecdaa_instrumentation_set_callback(count_pairings, &pairings));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&fixture.sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(4 == pairings);
+
+    TEST_ASSERT(0 == ecdaa_instrumentation_set_callback(NULL, NULL));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&fixture.sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(4 == pairings);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void fail_fast_skips_pairings()
+{
+    printf("Starting instrumentation::fail_fast_skips_pairings...\n");
+
+    if (!ecdaa_instrumentation_enabled()) {
+        printf("\tskipped (instrumentation disabled)\n");
+        return;
+    }
+
+    instrumentation_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    uint32_t wrong_msg_len = (uint32_t)strlen((char*)wrong_msg);
+
+    struct ecdaa_instrumentation_counter counter;
+
+    // The full verify still computes every pairing for a bad signature
+    ecdaa_instrumentation_reset();
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&fixture.sig, &fixture.ipk.gpk, &fixture.revocations, wrong_msg, wrong_msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_PAIRING));
+    TEST_ASSERT(4 == counter.calls);
+
+    // Fail-fast stops at the Schnorr check
+    ecdaa_instrumentation_reset();
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_fail_fast(&fixture.sig, &fixture.ipk.gpk, &fixture.revocations, wrong_msg, wrong_msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_PAIRING));
+    TEST_ASSERT(0 == counter.calls);
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_SK_REVOCATION_SCAN));
+    TEST_ASSERT(0 == counter.calls);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void revoked_scan_exhaustive_unless_fail_fast()
+{
+    printf("Starting instrumentation::revoked_scan_exhaustive_unless_fail_fast...\n");
+
+    if (!ecdaa_instrumentation_enabled()) {
+        printf("\tskipped (instrumentation disabled)\n");
+        return;
+    }
+
+    instrumentation_fixture fixture;
+    setup(&fixture);
+
+    // Revoke the signer, at the front of the list
+    BIG_XXX_copy(fixture.sk_rev_list[0].sk, fixture.sk.sk);
+
+    struct ecdaa_instrumentation_counter counter;
+
+    // The full verify scans every entry, and computes every pairing
+    ecdaa_instrumentation_reset();
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&fixture.sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_SK_REVOCATION_SCAN));
+    TEST_ASSERT(3 == counter.items);
+
+    // Fail-fast stops at the match
+    ecdaa_instrumentation_reset();
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_fail_fast(&fixture.sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_SK_REVOCATION_SCAN));
+    TEST_ASSERT(1 == counter.items);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void multi_group_shares_pairings()
+{
+    printf("Starting instrumentation::multi_group_shares_pairings...\n");
+
+    if (!ecdaa_instrumentation_enabled()) {
+        printf("\tskipped (instrumentation disabled)\n");
+        return;
+    }
+
+    instrumentation_fixture fixture;
+    setup(&fixture);
+
+    // Two other groups, with the signer's last
+    struct ecdaa_issuer_public_key_ZZZ other_ipks[2];
+    struct ecdaa_issuer_secret_key_ZZZ other_isks[2];
+    for (size_t i = 0; i < 2; i++)
+        TEST_ASSERT(0 == ecdaa_issuer_key_pair_ZZZ_generate(&other_ipks[i], &other_isks[i], test_randomness));
+    struct ecdaa_group_public_key_ZZZ *gpks[3] = {&other_ipks[0].gpk, &other_ipks[1].gpk, &fixture.ipk.gpk};
+    struct ecdaa_revocations_ZZZ *revocations[3] = {&fixture.revocations, &fixture.revocations, &fixture.revocations};
+
+    ecdaa_instrumentation_reset();
+
+    size_t group_index;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify_multi_group(&group_index, &fixture.sig, gpks, revocations, 3, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(2 == group_index);
+
+    // Two shared, one for each other group, two for the signer's group
+    struct ecdaa_instrumentation_counter counter;
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_PAIRING));
+    TEST_ASSERT(6 == counter.calls);
+
+    // Only the matching group's revocation list is scanned
+    TEST_ASSERT(0 == ecdaa_instrumentation_get(&counter, ECDAA_INSTRUMENTATION_SK_REVOCATION_SCAN));
+    TEST_ASSERT(1 == counter.calls);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,362 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/member_bundle_ZZZ.h>
+#include <ecdaa/basename_session_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <amcl/amcl.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void roundtrip_preserves_contents();
+static void loaded_bundle_signs();
+static void duplicate_basename_rejected();
+static void corruption_rejected();
+static void file_roundtrip();
+static void session_pointer_stable();
+static void oversized_basename_rejected();
+
+typedef struct bundle_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    uint8_t *other_basename;
+    uint32_t other_basename_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_member_bundle_ZZZ *bundle;
+} bundle_fixture;
+
+static void setup(bundle_fixture* fixture);
+static void teardown(bundle_fixture *fixture);
+
+int main()
+{
+    roundtrip_preserves_contents();
+    loaded_bundle_signs();
+    duplicate_basename_rejected();
+    corruption_rejected();
+    file_roundtrip();
+    session_pointer_stable();
+    oversized_basename_rejected();
+}
+
+static void setup(bundle_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    fixture->other_basename = (uint8_t*) "OTHER BASENAME";
+    fixture->other_basename_len = (uint32_t)strlen((char*)fixture->other_basename);
+
+    fixture->revocations.sk_length=0;
+    fixture->revocations.sk_list=NULL;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_new(&fixture->bundle, &fixture->sk, &fixture->cred, &fixture->ipk.gpk));
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_add_basename(fixture->bundle, fixture->basename, fixture->basename_len, test_randomness));
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_add_basename(fixture->bundle, fixture->other_basename, fixture->other_basename_len, test_randomness));
+}
+
+static void teardown(bundle_fixture *fixture)
+{
+    ecdaa_member_bundle_ZZZ_free(fixture->bundle);
+}
+
+static void serialize_bundle(uint8_t **buffer_out, size_t *length_out, struct ecdaa_member_bundle_ZZZ *bundle)
+{
+    *length_out = ecdaa_member_bundle_ZZZ_length(bundle);
+    *buffer_out = malloc(*length_out);
+    TEST_ASSERT(NULL != *buffer_out);
+    ecdaa_member_bundle_ZZZ_serialize(*buffer_out, bundle);
+}
+
+static void roundtrip_preserves_contents()
+{
+    printf("Starting member_bundle::roundtrip_preserves_contents...\n");
+
+    bundle_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *buffer;
+    size_t length;
+    serialize_bundle(&buffer, &length, fixture.bundle);
+
+    struct ecdaa_member_bundle_ZZZ *loaded;
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, length));
+
+    TEST_ASSERT(0 == BIG_XXX_comp(fixture.sk.sk, ecdaa_member_bundle_ZZZ_secret_key(loaded)->sk));
+
+    struct ecdaa_credential_ZZZ *cred = ecdaa_member_bundle_ZZZ_credential(loaded);
+    TEST_ASSERT(ECP_ZZZ_equals(&fixture.cred.A, &cred->A));
+    TEST_ASSERT(ECP_ZZZ_equals(&fixture.cred.B, &cred->B));
+    TEST_ASSERT(ECP_ZZZ_equals(&fixture.cred.C, &cred->C));
+    TEST_ASSERT(ECP_ZZZ_equals(&fixture.cred.D, &cred->D));
+
+    struct ecdaa_group_public_key_ZZZ *gpk = ecdaa_member_bundle_ZZZ_group_public_key(loaded);
+    TEST_ASSERT(ECP2_ZZZ_equals(&fixture.ipk.gpk.X, &gpk->X));
+    TEST_ASSERT(ECP2_ZZZ_equals(&fixture.ipk.gpk.Y, &gpk->Y));
+
+    struct ecdaa_basename_session_ZZZ expected;
+    TEST_ASSERT(0 == ecdaa_basename_session_ZZZ_init(&expected, fixture.basename, fixture.basename_len, &fixture.sk, test_randomness));
+    struct ecdaa_basename_session_ZZZ *session = ecdaa_member_bundle_ZZZ_find_session(loaded, fixture.basename, fixture.basename_len);
+    TEST_ASSERT(NULL != session);
+    TEST_ASSERT(ECP_ZZZ_equals(&expected.P2, &session->P2));
+    TEST_ASSERT(ECP_ZZZ_equals(&expected.K, &session->K));
+    for (size_t i = 0; i < ECDAA_BASENAME_SESSION_ZZZ_TABLE_SIZE; i++)
+        TEST_ASSERT(ECP_ZZZ_equals(&expected.P2_table[i], &session->P2_table[i]));
+
+    TEST_ASSERT(NULL != ecdaa_member_bundle_ZZZ_find_session(loaded, fixture.other_basename, fixture.other_basename_len));
+    TEST_ASSERT(NULL == ecdaa_member_bundle_ZZZ_find_session(loaded, fixture.msg, fixture.msg_len));
+
+    // Re-serializing gives the same bytes
+    uint8_t *reserialized;
+    size_t reserialized_length;
+    serialize_bundle(&reserialized, &reserialized_length, loaded);
+    TEST_ASSERT(length == reserialized_length);
+    TEST_ASSERT(0 == memcmp(buffer, reserialized, length));
+
+    free(reserialized);
+    free(buffer);
+    ecdaa_member_bundle_ZZZ_free(loaded);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void loaded_bundle_signs()
+{
+    printf("Starting member_bundle::loaded_bundle_signs...\n");
+
+    bundle_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *buffer;
+    size_t length;
+    serialize_bundle(&buffer, &length, fixture.bundle);
+
+    struct ecdaa_member_bundle_ZZZ *loaded;
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, length));
+
+    struct ecdaa_signature_ZZZ sig;
+
+    // With a session
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, loaded, test_randomness));
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Basename without a session
+    uint8_t *new_basename = (uint8_t*) "NEW BASENAME";
+    uint32_t new_basename_len = (uint32_t)strlen((char*)new_basename);
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, new_basename, new_basename_len, loaded, test_randomness));
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, new_basename, new_basename_len));
+
+    // No basename
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, NULL, 0, loaded, test_randomness));
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, NULL, 0));
+
+    free(buffer);
+    ecdaa_member_bundle_ZZZ_free(loaded);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void duplicate_basename_rejected()
+{
+    printf("Starting member_bundle::duplicate_basename_rejected...\n");
+
+    bundle_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(-1 == ecdaa_member_bundle_ZZZ_add_basename(fixture.bundle, fixture.basename, fixture.basename_len, test_randomness));
+    TEST_ASSERT(-1 == ecdaa_member_bundle_ZZZ_add_basename(fixture.bundle, fixture.basename, 0, test_randomness));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void corruption_rejected()
+{
+    printf("Starting member_bundle::corruption_rejected...\n");
+
+    bundle_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *buffer;
+    size_t length;
+    serialize_bundle(&buffer, &length, fixture.bundle);
+
+    struct ecdaa_member_bundle_ZZZ *loaded;
+
+    // Any flipped bit fails the checksum
+    buffer[length / 2] ^= 1;
+    TEST_ASSERT(-1 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, length));
+    buffer[length / 2] ^= 1;
+
+    TEST_ASSERT(-1 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, length - 1));
+    TEST_ASSERT(-1 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, 10));
+
+    buffer[4] += 1;     // version
+    TEST_ASSERT(-1 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, length));
+    buffer[4] -= 1;
+
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, length));
+    ecdaa_member_bundle_ZZZ_free(loaded);
+
+    free(buffer);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void file_roundtrip()
+{
+    printf("Starting member_bundle::file_roundtrip...\n");
+
+    bundle_fixture fixture;
+    setup(&fixture);
+
+    char file[] = "/tmp/ecdaa-member-bundle-XXXXXX";
+    int fd = mkstemp(file);
+    TEST_ASSERT(-1 != fd);
+    close(fd);
+
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_serialize_file(file, fixture.bundle));
+
+    struct ecdaa_member_bundle_ZZZ *loaded;
+    TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_deserialize_file(&loaded, file));
+
+    uint8_t *buffer;
+    size_t length;
+    serialize_bundle(&buffer, &length, fixture.bundle);
+    uint8_t *reserialized;
+    size_t reserialized_length;
+    serialize_bundle(&reserialized, &reserialized_length, loaded);
+    TEST_ASSERT(length == reserialized_length);
+    TEST_ASSERT(0 == memcmp(buffer, reserialized, length));
+
+    free(reserialized);
+    free(buffer);
+    ecdaa_member_bundle_ZZZ_free(loaded);
+    unlink(file);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void session_pointer_stable()
+{
+    printf("Starting member_bundle::session_pointer_stable...\n");
+
+    bundle_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_basename_session_ZZZ *session = ecdaa_member_bundle_ZZZ_find_session(fixture.bundle, fixture.basename, fixture.basename_len);
+    TEST_ASSERT(NULL != session);
+
+    // Enough additions to grow the bundle's session list several times
+    for (size_t i = 0; i < 16; i++) {
+        uint8_t basename[32];
+        int basename_len = snprintf((char*)basename, sizeof(basename), "EXTRA BASENAME %zu", i);
+        TEST_ASSERT(0 == ecdaa_member_bundle_ZZZ_add_basename(fixture.bundle, basename, (uint32_t)basename_len, test_randomness));
+    }
+
+    TEST_ASSERT(session == ecdaa_member_bundle_ZZZ_find_session(fixture.bundle, fixture.basename, fixture.basename_len));
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign_with_session(&sig, fixture.msg, fixture.msg_len, session, ecdaa_member_bundle_ZZZ_secret_key(fixture.bundle), ecdaa_member_bundle_ZZZ_credential(fixture.bundle), test_randomness));
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void oversized_basename_rejected()
+{
+    printf("Starting member_bundle::oversized_basename_rejected...\n");
+
+    bundle_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *buffer;
+    size_t length;
+    serialize_bundle(&buffer, &length, fixture.bundle);
+
+    // Length field of the first session, just after the header, keys, and credential
+    size_t offset = 4 + 1 + 4
+        + ECDAA_MEMBER_SECRET_KEY_ZZZ_LENGTH
+        + ECDAA_CREDENTIAL_ZZZ_LENGTH
+        + ECDAA_GROUP_PUBLIC_KEY_ZZZ_LENGTH;
+    memset(buffer + offset, 0xff, 4);
+
+    // Re-checksum, so the length itself is what gets rejected
+    hash256 hash;
+    HASH256_init(&hash);
+    for (size_t i = 0; i < length - 32; i++)
+        HASH256_process(&hash, buffer[i]);
+    HASH256_hash(&hash, (char*)(buffer + length - 32));
+
+    struct ecdaa_member_bundle_ZZZ *loaded;
+    TEST_ASSERT(-1 == ecdaa_member_bundle_ZZZ_deserialize(&loaded, buffer, length));
+
+    free(buffer);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,285 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/merkle_batch_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static void sign_then_verify_every_message();
+static void wrong_message_fails();
+static void tampered_batch_fails();
+static void serialize_deserialize();
+static void deserialize_bad_proof_fails();
+
+#define MAX_MESSAGES 13
+
+typedef struct merkle_batch_fixture {
+    uint8_t message_storage[MAX_MESSAGES][32];
+    uint8_t *messages[MAX_MESSAGES];
+    uint32_t message_lens[MAX_MESSAGES];
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_merkle_proof_ZZZ proofs[MAX_MESSAGES];
+} merkle_batch_fixture;
+
+static void setup(merkle_batch_fixture* fixture);
+static void teardown(merkle_batch_fixture *fixture);
+
+int main()
+{
+    sign_then_verify_every_message();
+    wrong_message_fails();
+    tampered_batch_fails();
+    serialize_deserialize();
+    deserialize_bad_proof_fails();
+}
+
+static void setup(merkle_batch_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    for (size_t i = 0; i < MAX_MESSAGES; i++) {
+        int len = snprintf((char*)fixture->message_storage[i], sizeof(fixture->message_storage[i]), "Telemetry record %zu", i);
+        fixture->messages[i] = fixture->message_storage[i];
+        fixture->message_lens[i] = (uint32_t)len;
+    }
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    fixture->revocations.sk_length=0;
+    fixture->revocations.sk_list=NULL;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+}
+
+static void teardown(merkle_batch_fixture *fixture)
+{
+    (void)fixture;
+}
+
+static void sign_then_verify_every_message()
+{
+    printf("Starting merkle_batch::sign_then_verify_every_message...\n");
+
+    merkle_batch_fixture fixture;
+    setup(&fixture);
+
+    // Full, unbalanced, and single-message trees
+    uint32_t batch_sizes[] = {1, 2, 3, 5, 8, MAX_MESSAGES};
+    for (size_t b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++) {
+        uint32_t num_messages = batch_sizes[b];
+
+        struct ecdaa_merkle_batch_ZZZ batch;
+        TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, fixture.proofs, fixture.messages, fixture.message_lens, num_messages, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+        TEST_ASSERT(num_messages == batch.num_messages);
+
+        TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify(&batch, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len));
+
+        for (uint32_t i = 0; i < num_messages; i++) {
+            TEST_ASSERT(i == fixture.proofs[i].message_index);
+            TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify_message(&batch, &fixture.proofs[i], fixture.messages[i], fixture.message_lens[i]));
+        }
+    }
+
+    // Unlinkable
+    struct ecdaa_merkle_batch_ZZZ batch;
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, fixture.proofs, fixture.messages, fixture.message_lens, 5, NULL, 0, &fixture.sk, &fixture.cred, test_randomness));
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify(&batch, &fixture.ipk.gpk, &fixture.revocations, NULL, 0));
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify_message(&batch, &fixture.proofs[4], fixture.messages[4], fixture.message_lens[4]));
+
+    // Empty batch
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_sign(&batch, fixture.proofs, fixture.messages, fixture.message_lens, 0, NULL, 0, &fixture.sk, &fixture.cred, test_randomness));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void wrong_message_fails()
+{
+    printf("Starting merkle_batch::wrong_message_fails...\n");
+
+    merkle_batch_fixture fixture;
+    setup(&fixture);
+
+    uint32_t num_messages = 5;
+
+    struct ecdaa_merkle_batch_ZZZ batch;
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, fixture.proofs, fixture.messages, fixture.message_lens, num_messages, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    // Message not in the batch
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    uint32_t wrong_msg_len = (uint32_t)strlen((char*)wrong_msg);
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify_message(&batch, &fixture.proofs[0], wrong_msg, wrong_msg_len));
+
+    // Message in the batch, but at a different position
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify_message(&batch, &fixture.proofs[0], fixture.messages[1], fixture.message_lens[1]));
+
+    // Message in the batch, but claimed at a different position
+    struct ecdaa_merkle_proof_ZZZ moved_proof = fixture.proofs[2];
+    moved_proof.message_index = 3;
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify_message(&batch, &moved_proof, fixture.messages[2], fixture.message_lens[2]));
+
+    // Tampered sibling
+    struct ecdaa_merkle_proof_ZZZ tampered_proof = fixture.proofs[2];
+    tampered_proof.siblings[0][0] ^= 1;
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify_message(&batch, &tampered_proof, fixture.messages[2], fixture.message_lens[2]));
+
+    // Missing sibling
+    struct ecdaa_merkle_proof_ZZZ short_proof = fixture.proofs[2];
+    short_proof.num_siblings--;
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify_message(&batch, &short_proof, fixture.messages[2], fixture.message_lens[2]));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void tampered_batch_fails()
+{
+    printf("Starting merkle_batch::tampered_batch_fails...\n");
+
+    merkle_batch_fixture fixture;
+    setup(&fixture);
+
+    uint32_t num_messages = 5;
+
+    struct ecdaa_merkle_batch_ZZZ batch;
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, fixture.proofs, fixture.messages, fixture.message_lens, num_messages, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    struct ecdaa_merkle_batch_ZZZ tampered = batch;
+    tampered.root[0] ^= 1;
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify(&tampered, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len));
+
+    tampered = batch;
+    tampered.num_messages = num_messages + 1;
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify(&tampered, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify_message(&tampered, &fixture.proofs[0], fixture.messages[0], fixture.message_lens[0]));
+
+    // Revoked signer
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list_bad_raw[1];
+    BIG_XXX_copy(sk_rev_list_bad_raw[0].sk, fixture.sk.sk);
+    struct ecdaa_revocations_ZZZ rev_list_bad = {.sk_length=1, .sk_list=sk_rev_list_bad_raw, .bsn_length=0, .bsn_list=NULL};
+    TEST_ASSERT(0 != ecdaa_merkle_batch_ZZZ_verify(&batch, &fixture.ipk.gpk, &rev_list_bad, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void serialize_deserialize()
+{
+    printf("Starting merkle_batch::serialize_deserialize...\n");
+
+    merkle_batch_fixture fixture;
+    setup(&fixture);
+
+    uint32_t num_messages = MAX_MESSAGES;
+
+    struct ecdaa_merkle_batch_ZZZ batch;
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, fixture.proofs, fixture.messages, fixture.message_lens, num_messages, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    uint8_t batch_buffer[ECDAA_MERKLE_BATCH_ZZZ_WITH_NYM_LENGTH];
+    ecdaa_merkle_batch_ZZZ_serialize(batch_buffer, &batch, 1);
+
+    struct ecdaa_merkle_batch_ZZZ batch_deserialized;
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_deserialize(&batch_deserialized, batch_buffer, 1));
+    TEST_ASSERT(0 == memcmp(batch.root, batch_deserialized.root, sizeof(batch.root)));
+    TEST_ASSERT(num_messages == batch_deserialized.num_messages);
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify(&batch_deserialized, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len));
+
+    for (uint32_t i = 0; i < num_messages; i++) {
+        uint8_t proof_buffer[ECDAA_MERKLE_PROOF_ZZZ_MAX_LENGTH];
+        size_t proof_length = ecdaa_merkle_proof_ZZZ_serialize(proof_buffer, &fixture.proofs[i]);
+        TEST_ASSERT(proof_length == ecdaa_merkle_proof_ZZZ_length(&fixture.proofs[i]));
+
+        struct ecdaa_merkle_proof_ZZZ proof_deserialized;
+        TEST_ASSERT(0 == ecdaa_merkle_proof_ZZZ_deserialize(&proof_deserialized, proof_buffer, proof_length));
+        TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_verify_message(&batch_deserialized, &proof_deserialized, fixture.messages[i], fixture.message_lens[i]));
+    }
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void deserialize_bad_proof_fails()
+{
+    printf("Starting merkle_batch::deserialize_bad_proof_fails...\n");
+
+    merkle_batch_fixture fixture;
+    setup(&fixture);
+
+    uint32_t num_messages = 5;
+
+    struct ecdaa_merkle_batch_ZZZ batch;
+    TEST_ASSERT(0 == ecdaa_merkle_batch_ZZZ_sign(&batch, fixture.proofs, fixture.messages, fixture.message_lens, num_messages, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    uint8_t proof_buffer[ECDAA_MERKLE_PROOF_ZZZ_MAX_LENGTH];
+    size_t proof_length = ecdaa_merkle_proof_ZZZ_serialize(proof_buffer, &fixture.proofs[1]);
+
+    struct ecdaa_merkle_proof_ZZZ proof;
+
+    // Truncated, or with trailing bytes
+    TEST_ASSERT(0 != ecdaa_merkle_proof_ZZZ_deserialize(&proof, proof_buffer, proof_length - 1));
+    TEST_ASSERT(0 != ecdaa_merkle_proof_ZZZ_deserialize(&proof, proof_buffer, proof_length + 1));
+    TEST_ASSERT(0 != ecdaa_merkle_proof_ZZZ_deserialize(&proof, proof_buffer, 4));
+
+    // Index past the end of the batch
+    proof_buffer[3] = (uint8_t)num_messages;
+    TEST_ASSERT(0 != ecdaa_merkle_proof_ZZZ_deserialize(&proof, proof_buffer, proof_length));
+
+    // Empty batch
+    memset(proof_buffer, 0, 8);
+    TEST_ASSERT(0 != ecdaa_merkle_proof_ZZZ_deserialize(&proof, proof_buffer, proof_length));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,432 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/pseudonym_index_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include <sys/resource.h>
+
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+static void add_then_lookup();
+static void counts_and_timestamps();
+static void signatures_link_under_basename();
+static void malformed_pseudonym_rejected();
+static void grows_past_initial_capacity();
+static void replays_log();
+static void drops_partial_log_record();
+static void failed_append_rolled_back();
+static void concurrent_lookups();
+
+#define NUM_PSEUDONYMS 200
+#define NUM_THREADS 4
+
+static void random_pseudonym(uint8_t *pseudonym_out);
+static void temp_log_file(char *name_out);
+
+int main()
+{
+    add_then_lookup();
+    counts_and_timestamps();
+    signatures_link_under_basename();
+    malformed_pseudonym_rejected();
+    grows_past_initial_capacity();
+    replays_log();
+    drops_partial_log_record();
+    failed_append_rolled_back();
+    concurrent_lookups();
+}
+
+static void random_pseudonym(uint8_t *pseudonym_out)
+{
+    BIG_XXX x;
+    ecp_ZZZ_random_mod_order(&x, test_randomness);
+
+    ECP_ZZZ point;
+    ecp_ZZZ_set_to_generator(&point);
+    ECP_ZZZ_mul(&point, x);
+
+    ecp_ZZZ_serialize(pseudonym_out, &point);
+}
+
+static void temp_log_file(char *name_out)
+{
+    strcpy(name_out, "/tmp/ecdaa-pseudonym-index-XXXXXX");
+    int fd = mkstemp(name_out);
+    TEST_ASSERT(-1 != fd);
+    close(fd);
+}
+
+static void add_then_lookup()
+{
+    printf("Starting pseudonym_index::add_then_lookup...\n");
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, NULL));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    uint8_t seen[ECP_ZZZ_LENGTH];
+    uint8_t unseen[ECP_ZZZ_LENGTH];
+    random_pseudonym(seen);
+    random_pseudonym(unseen);
+
+    TEST_ASSERT(-1 == ecdaa_pseudonym_index_ZZZ_lookup(index, seen, NULL));
+
+    struct ecdaa_pseudonym_record_ZZZ record;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, seen, 100, &record));
+    TEST_ASSERT(1 == record.count);
+
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_lookup(index, seen, &record));
+    TEST_ASSERT(1 == record.count);
+    TEST_ASSERT(-1 == ecdaa_pseudonym_index_ZZZ_lookup(index, unseen, &record));
+    TEST_ASSERT(1 == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    printf("\tsuccess\n");
+}
+
+static void counts_and_timestamps()
+{
+    printf("Starting pseudonym_index::counts_and_timestamps...\n");
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, NULL));
+
+    uint8_t pseudonym[ECP_ZZZ_LENGTH];
+    random_pseudonym(pseudonym);
+
+    struct ecdaa_pseudonym_record_ZZZ record;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonym, 10, NULL));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonym, 20, NULL));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonym, 30, &record));
+    TEST_ASSERT(3 == record.count);
+    TEST_ASSERT(10 == record.first_seen);
+    TEST_ASSERT(30 == record.last_seen);
+    TEST_ASSERT(1 == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    printf("\tsuccess\n");
+}
+
+static void signatures_link_under_basename()
+{
+    printf("Starting pseudonym_index::signatures_link_under_basename...\n");
+
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    ecp_ZZZ_random_mod_order(&isk.x, test_randomness);
+    ecp_ZZZ_random_mod_order(&isk.y, test_randomness);
+
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    ecp_ZZZ_set_to_generator(&pk.Q);
+    ecp_ZZZ_random_mod_order(&sk.sk, test_randomness);
+    ECP_ZZZ_mul(&pk.Q, sk.sk);
+
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    TEST_ASSERT(0 == ecdaa_credential_ZZZ_generate(&cred, &cred_sig, &isk, &pk, test_randomness));
+
+    uint8_t *msg = (uint8_t*) "Test message";
+    uint32_t msg_len = (uint32_t)strlen((char*)msg);
+    uint8_t *basename = (uint8_t*) "BASENAME";
+    uint32_t basename_len = (uint32_t)strlen((char*)basename);
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, NULL));
+
+    struct ecdaa_signature_ZZZ sig;
+    struct ecdaa_pseudonym_record_ZZZ record;
+    for (uint64_t i = 1; i <= 2; i++) {
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, msg, msg_len, basename, basename_len, &sk, &cred, test_randomness));
+        TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add(index, &sig, i, &record));
+        TEST_ASSERT(i == record.count);
+    }
+
+    uint8_t sig_buffer[ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+    ecdaa_signature_ZZZ_serialize(sig_buffer, &sig, 1);
+    uint8_t *pseudonym;
+    uint32_t pseudonym_length;
+    ecdaa_signature_ZZZ_access_pseudonym_in_serialized(&pseudonym, &pseudonym_length, sig_buffer);
+    TEST_ASSERT(ECDAA_PSEUDONYM_ZZZ_LENGTH == pseudonym_length);
+
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_lookup(index, pseudonym, &record));
+    TEST_ASSERT(2 == record.count);
+    TEST_ASSERT(1 == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    printf("\tsuccess\n");
+}
+
+static void malformed_pseudonym_rejected()
+{
+    printf("Starting pseudonym_index::malformed_pseudonym_rejected...\n");
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, NULL));
+
+    uint8_t pseudonym[ECP_ZZZ_LENGTH];
+    random_pseudonym(pseudonym);
+    pseudonym[ECP_ZZZ_LENGTH - 1] ^= 1;
+
+    TEST_ASSERT(-1 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonym, 1, NULL));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    printf("\tsuccess\n");
+}
+
+static void grows_past_initial_capacity()
+{
+    printf("Starting pseudonym_index::grows_past_initial_capacity...\n");
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, NULL));
+
+    static uint8_t pseudonyms[NUM_PSEUDONYMS][ECP_ZZZ_LENGTH];
+    for (size_t i = 0; i < NUM_PSEUDONYMS; i++) {
+        random_pseudonym(pseudonyms[i]);
+        TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonyms[i], i, NULL));
+    }
+    TEST_ASSERT(NUM_PSEUDONYMS == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    struct ecdaa_pseudonym_record_ZZZ record;
+    for (size_t i = 0; i < NUM_PSEUDONYMS; i++) {
+        TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_lookup(index, pseudonyms[i], &record));
+        TEST_ASSERT(1 == record.count);
+        TEST_ASSERT(i == record.first_seen);
+    }
+
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    printf("\tsuccess\n");
+}
+
+static void replays_log()
+{
+    printf("Starting pseudonym_index::replays_log...\n");
+
+    char log_file[64];
+    temp_log_file(log_file);
+
+    uint8_t first[ECP_ZZZ_LENGTH];
+    uint8_t second[ECP_ZZZ_LENGTH];
+    random_pseudonym(first);
+    random_pseudonym(second);
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, first, 1, NULL));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, second, 2, NULL));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, first, 3, NULL));
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(2 == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    struct ecdaa_pseudonym_record_ZZZ record;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_lookup(index, first, &record));
+    TEST_ASSERT(2 == record.count);
+    TEST_ASSERT(1 == record.first_seen);
+    TEST_ASSERT(3 == record.last_seen);
+
+    // New additions keep extending the same log
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, second, 4, NULL));
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_lookup(index, second, &record));
+    TEST_ASSERT(2 == record.count);
+    TEST_ASSERT(4 == record.last_seen);
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    unlink(log_file);
+
+    printf("\tsuccess\n");
+}
+
+static void drops_partial_log_record()
+{
+    printf("Starting pseudonym_index::drops_partial_log_record...\n");
+
+    char log_file[64];
+    temp_log_file(log_file);
+
+    uint8_t pseudonym[ECP_ZZZ_LENGTH];
+    random_pseudonym(pseudonym);
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonym, 1, NULL));
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    // Simulate a crash part-way through writing a second record
+    FILE *log = fopen(log_file, "ab");
+    TEST_ASSERT(NULL != log);
+    TEST_ASSERT(10 == fwrite(pseudonym, 1, 10, log));
+    fclose(log);
+
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(1 == ecdaa_pseudonym_index_ZZZ_size(index));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonym, 2, NULL));
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    struct ecdaa_pseudonym_record_ZZZ record;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_lookup(index, pseudonym, &record));
+    TEST_ASSERT(2 == record.count);
+    TEST_ASSERT(2 == record.last_seen);
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    // A record that isn't a point is corruption, not truncation
+    log = fopen(log_file, "ab");
+    TEST_ASSERT(NULL != log);
+    uint8_t garbage[ECDAA_PSEUDONYM_INDEX_ZZZ_LOG_RECORD_LENGTH] = {0};
+    TEST_ASSERT(1 == fwrite(garbage, sizeof(garbage), 1, log));
+    fclose(log);
+
+    TEST_ASSERT(-1 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+
+    unlink(log_file);
+
+    printf("\tsuccess\n");
+}
+
+struct lookup_thread_args {
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    uint8_t (*pseudonyms)[ECP_ZZZ_LENGTH];
+    int failures;
+};
+
+static void *lookup_thread(void *arg)
+{
+    struct lookup_thread_args *args = arg;
+
+    for (int round = 0; round < 10; round++) {
+        for (size_t i = 0; i < NUM_PSEUDONYMS; i++) {
+            struct ecdaa_pseudonym_record_ZZZ record;
+            if (0 != ecdaa_pseudonym_index_ZZZ_lookup(args->index, args->pseudonyms[i], &record))
+                args->failures++;
+        }
+    }
+
+    return NULL;
+}
+
+static void failed_append_rolled_back()
+{
+    printf("Starting pseudonym_index::failed_append_rolled_back...\n");
+
+    char log_file[64];
+    temp_log_file(log_file);
+
+    uint8_t first[ECP_ZZZ_LENGTH];
+    uint8_t second[ECP_ZZZ_LENGTH];
+    random_pseudonym(first);
+    random_pseudonym(second);
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, first, 1, NULL));
+
+    // Cap the file size part-way through the next record, so only part of it is written
+    struct rlimit old_limit;
+    TEST_ASSERT(0 == getrlimit(RLIMIT_FSIZE, &old_limit));
+    struct rlimit new_limit = old_limit;
+    new_limit.rlim_cur = ECDAA_PSEUDONYM_INDEX_ZZZ_LOG_RECORD_LENGTH + ECDAA_PSEUDONYM_INDEX_ZZZ_LOG_RECORD_LENGTH / 2;
+    void (*old_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    TEST_ASSERT(0 == setrlimit(RLIMIT_FSIZE, &new_limit));
+
+    TEST_ASSERT(-1 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, second, 2, NULL));
+    TEST_ASSERT(-1 == ecdaa_pseudonym_index_ZZZ_lookup(index, second, NULL));
+
+    TEST_ASSERT(0 == setrlimit(RLIMIT_FSIZE, &old_limit));
+    signal(SIGXFSZ, old_handler);
+
+    // The torn record was removed, so later records stay aligned
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, second, 3, NULL));
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    struct ecdaa_pseudonym_record_ZZZ record;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, log_file));
+    TEST_ASSERT(2 == ecdaa_pseudonym_index_ZZZ_size(index));
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_lookup(index, second, &record));
+    TEST_ASSERT(1 == record.count);
+    TEST_ASSERT(3 == record.first_seen);
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    unlink(log_file);
+
+    printf("\tsuccess\n");
+}
+
+static void concurrent_lookups()
+{
+    printf("Starting pseudonym_index::concurrent_lookups...\n");
+
+    struct ecdaa_pseudonym_index_ZZZ *index;
+    TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_new(&index, NULL));
+
+    static uint8_t pseudonyms[NUM_PSEUDONYMS][ECP_ZZZ_LENGTH];
+    static uint8_t added_meanwhile[NUM_PSEUDONYMS][ECP_ZZZ_LENGTH];
+    for (size_t i = 0; i < NUM_PSEUDONYMS; i++) {
+        random_pseudonym(pseudonyms[i]);
+        random_pseudonym(added_meanwhile[i]);
+        TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, pseudonyms[i], 0, NULL));
+    }
+
+    pthread_t threads[NUM_THREADS];
+    struct lookup_thread_args args[NUM_THREADS];
+    for (size_t i = 0; i < NUM_THREADS; i++) {
+        args[i].index = index;
+        args[i].pseudonyms = pseudonyms;
+        args[i].failures = 0;
+        TEST_ASSERT(0 == pthread_create(&threads[i], NULL, lookup_thread, &args[i]));
+    }
+
+    // Additions (and the resizes they cause) run alongside the lookups
+    for (size_t i = 0; i < NUM_PSEUDONYMS; i++)
+        TEST_ASSERT(0 == ecdaa_pseudonym_index_ZZZ_add_serialized(index, added_meanwhile[i], 1, NULL));
+
+    for (size_t i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT(0 == pthread_join(threads[i], NULL));
+        TEST_ASSERT(0 == args[i].failures);
+    }
+
+    TEST_ASSERT(2 * NUM_PSEUDONYMS == ecdaa_pseudonym_index_ZZZ_size(index));
+
+    ecdaa_pseudonym_index_ZZZ_free(index);
+
+    printf("\tsuccess\n");
+}
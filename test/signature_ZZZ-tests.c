@@ -45,6 +45,16 @@ static void serialize_deserialize_file();
 static void serialize_deserialize_fp();
 static void pseudonym();
 static void deserialize_garbage_fails();
+static void batch_verify_good();
+static void batch_verify_finds_bad();
+static void verify_with_issuer_key_good();
+static void verify_with_issuer_key_bad();
+static void verify_fail_fast_good();
+static void verify_fail_fast_bad();
+static void serialize_batch_matches_serialize();
+static void verify_multi_group_finds_group();
+static void verify_multi_group_no_group_fails();
+static void verify_multi_group_revoked_fails();
 
 typedef struct sign_and_verify_fixture {
     uint8_t *msg;
@@ -76,6 +86,16 @@ int main()
     serialize_deserialize_fp();
     pseudonym();
     deserialize_garbage_fails();
+    batch_verify_good();
+    batch_verify_finds_bad();
+    verify_with_issuer_key_good();
+    verify_with_issuer_key_bad();
+    verify_fail_fast_good();
+    verify_fail_fast_bad();
+    serialize_batch_matches_serialize();
+    verify_multi_group_finds_group();
+    verify_multi_group_no_group_fails();
+    verify_multi_group_revoked_fails();
 }
 
 static void setup(sign_and_verify_fixture* fixture)
@@ -112,6 +132,18 @@ static void teardown(sign_and_verify_fixture *fixture)
     (void)fixture;
 }
 
+static void random_group_public_key(struct ecdaa_group_public_key_ZZZ *gpk_out)
+{
+    BIG_XXX x, y;
+    ecp_ZZZ_random_mod_order(&x, test_randomness);
+    ecp_ZZZ_random_mod_order(&y, test_randomness);
+
+    ecp2_ZZZ_set_to_generator(&gpk_out->X);
+    ECP2_ZZZ_mul(&gpk_out->X, x);
+    ecp2_ZZZ_set_to_generator(&gpk_out->Y);
+    ECP2_ZZZ_mul(&gpk_out->Y, y);
+}
+
 static void sign_then_verify_good()
 {
     printf("Starting signature::sign_then_verify_good...\n");
@@ -418,3 +450,316 @@ static void deserialize_garbage_fails()
 //     printf("\tsuccess\n");
 // }
 
+#define BATCH_SIZE 4
+
+static void batch_verify_good()
+{
+    printf("Starting signature::batch_verify_good...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *messages[BATCH_SIZE] = {(uint8_t*)"one", (uint8_t*)"two", (uint8_t*)"three", (uint8_t*)"four"};
+    uint32_t message_lens[BATCH_SIZE];
+    struct ecdaa_signature_ZZZ sigs[BATCH_SIZE];
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        message_lens[i] = (uint32_t)strlen((char*)messages[i]);
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sigs[i], messages[i], message_lens[i], fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+    }
+
+    int results[BATCH_SIZE];
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_batch_verify(results, sigs, messages, message_lens, BATCH_SIZE, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len, test_randomness));
+    for (size_t i = 0; i < BATCH_SIZE; i++)
+        TEST_ASSERT(0 == results[i]);
+
+    // A batch of one is fine too
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_batch_verify(results, sigs, messages, message_lens, 1, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len, test_randomness));
+    TEST_ASSERT(0 == results[0]);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void batch_verify_finds_bad()
+{
+    printf("Starting signature::batch_verify_finds_bad...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *messages[BATCH_SIZE] = {(uint8_t*)"one", (uint8_t*)"two", (uint8_t*)"three", (uint8_t*)"four"};
+    uint32_t message_lens[BATCH_SIZE];
+    struct ecdaa_signature_ZZZ sigs[BATCH_SIZE];
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        message_lens[i] = (uint32_t)strlen((char*)messages[i]);
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sigs[i], messages[i], message_lens[i], fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+    }
+
+    // Signature 1 fails its Schnorr check (wrong message)
+    messages[1] = (uint8_t*)"TWO";
+
+    // Signature 2 passes its Schnorr check, but not the pairing check (T isn't in the Schnorr hash)
+    ECP_ZZZ_copy(&sigs[2].T, &sigs[3].T);
+
+    int results[BATCH_SIZE];
+    TEST_ASSERT(-1 == ecdaa_signature_ZZZ_batch_verify(results, sigs, messages, message_lens, BATCH_SIZE, &fixture.ipk.gpk, &fixture.revocations, fixture.basename, fixture.basename_len, test_randomness));
+    TEST_ASSERT(0 == results[0]);
+    TEST_ASSERT(-1 == results[1]);
+    TEST_ASSERT(-1 == results[2]);
+    TEST_ASSERT(0 == results[3]);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_with_issuer_key_good()
+{
+    printf("Starting signature::verify_with_issuer_key_good...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify_with_issuer_key(&sig, &fixture.isk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, test_randomness));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_with_issuer_key_bad()
+{
+    printf("Starting signature::verify_with_issuer_key_bad...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    // Wrong issuer
+    struct ecdaa_issuer_secret_key_ZZZ other_isk;
+    ecp_ZZZ_random_mod_order(&other_isk.x, test_randomness);
+    ecp_ZZZ_random_mod_order(&other_isk.y, test_randomness);
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_with_issuer_key(&sig, &other_isk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, test_randomness));
+
+    // On sk revocation list
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list_bad_raw[1];
+    BIG_XXX_copy(sk_rev_list_bad_raw[0].sk, fixture.sk.sk);
+    struct ecdaa_revocations_ZZZ rev_list_bad = {.sk_length=1, .sk_list=sk_rev_list_bad_raw, .bsn_length=0, .bsn_list=NULL};
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_with_issuer_key(&sig, &fixture.isk, &rev_list_bad, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, test_randomness));
+
+    // T isn't in the Schnorr hash, so only the issuer-key check catches this
+    struct ecdaa_signature_ZZZ other_sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&other_sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+    ECP_ZZZ_copy(&sig.T, &other_sig.T);
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_with_issuer_key(&sig, &fixture.isk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, test_randomness));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_fail_fast_good()
+{
+    printf("Starting signature::verify_fail_fast_good...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify_fail_fast(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_fail_fast_bad()
+{
+    printf("Starting signature::verify_fail_fast_bad...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    // On bsn revocation list
+    ECP_ZZZ bsn_rev_list_bad_raw[1];
+    ECP_ZZZ_copy(&bsn_rev_list_bad_raw[0], &sig.K);
+    struct ecdaa_revocations_ZZZ bsn_rev_list_bad = {.bsn_length=1, .bsn_list=bsn_rev_list_bad_raw, .sk_length=0, .sk_list=NULL};
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_fail_fast(&sig, &fixture.ipk.gpk, &bsn_rev_list_bad, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Wrong message
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_fail_fast(&sig, &fixture.ipk.gpk, &fixture.revocations, wrong_msg, (uint32_t)strlen((char*)wrong_msg), fixture.basename, fixture.basename_len));
+
+    // On sk revocation list
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list_bad_raw[1];
+    BIG_XXX_copy(sk_rev_list_bad_raw[0].sk, fixture.sk.sk);
+    struct ecdaa_revocations_ZZZ sk_rev_list_bad = {.sk_length=1, .sk_list=sk_rev_list_bad_raw, .bsn_length=0, .bsn_list=NULL};
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_fail_fast(&sig, &fixture.ipk.gpk, &sk_rev_list_bad, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Passes the Schnorr check, but not the pairing check (T isn't in the Schnorr hash)
+    struct ecdaa_signature_ZZZ other_sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&other_sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+    ECP_ZZZ_copy(&sig.T, &other_sig.T);
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_fail_fast(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void serialize_batch_matches_serialize()
+{
+    printf("Starting signature::serialize_batch_matches_serialize...\n");
+
+    // More than fit in one affine-conversion chunk
+    enum { num_sigs = 15 };
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    ECP_ZZZ generator;
+    ecp_ZZZ_set_to_generator(&generator);
+
+    struct ecdaa_signature_ZZZ sigs[num_sigs];
+    struct ecdaa_signature_ZZZ sigs_copy[num_sigs];
+    for (size_t i = 0; i < num_sigs; i++) {
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sigs[i], fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+        // Leave some points in projective coordinates
+        ECP_ZZZ_add(&sigs[i].R, &generator);
+        ECP_ZZZ_sub(&sigs[i].R, &generator);
+        ECP_ZZZ_add(&sigs[i].K, &generator);
+        ECP_ZZZ_sub(&sigs[i].K, &generator);
+
+        sigs_copy[i] = sigs[i];
+    }
+
+    for (int has_nym = 0; has_nym <= 1; has_nym++) {
+        size_t sig_length = has_nym ? ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH : ECDAA_SIGNATURE_ZZZ_LENGTH;
+
+        uint8_t batch_buffer[num_sigs * ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+        ecdaa_signature_ZZZ_serialize_batch(batch_buffer, sigs, num_sigs, has_nym);
+
+        for (size_t i = 0; i < num_sigs; i++) {
+            uint8_t buffer[ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+            ecdaa_signature_ZZZ_serialize(buffer, &sigs_copy[i], has_nym);
+            TEST_ASSERT(0 == memcmp(buffer, batch_buffer + i*sig_length, sig_length));
+        }
+    }
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_multi_group_finds_group()
+{
+    printf("Starting signature::verify_multi_group_finds_group...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    // The signer's group is in the middle
+    struct ecdaa_group_public_key_ZZZ other_gpks[2];
+    random_group_public_key(&other_gpks[0]);
+    random_group_public_key(&other_gpks[1]);
+    struct ecdaa_group_public_key_ZZZ *gpks[3] = {&other_gpks[0], &fixture.ipk.gpk, &other_gpks[1]};
+    struct ecdaa_revocations_ZZZ *revocations[3] = {&fixture.revocations, &fixture.revocations, &fixture.revocations};
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    size_t group_index = 0;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revocations, 3, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(1 == group_index);
+
+    // Unlinkable signatures, too
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, NULL, 0, &fixture.sk, &fixture.cred, test_randomness));
+
+    group_index = 0;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revocations, 3, fixture.msg, fixture.msg_len, NULL, 0));
+    TEST_ASSERT(1 == group_index);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_multi_group_no_group_fails()
+{
+    printf("Starting signature::verify_multi_group_no_group_fails...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_group_public_key_ZZZ other_gpks[2];
+    random_group_public_key(&other_gpks[0]);
+    random_group_public_key(&other_gpks[1]);
+    struct ecdaa_group_public_key_ZZZ *gpks[3] = {&other_gpks[0], &other_gpks[1], &fixture.ipk.gpk};
+    struct ecdaa_revocations_ZZZ *revocations[3] = {&fixture.revocations, &fixture.revocations, &fixture.revocations};
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    size_t group_index;
+
+    // Signer's group isn't a candidate
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revocations, 2, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Wrong message
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    uint32_t wrong_msg_len = (uint32_t)strlen((char*)wrong_msg);
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revocations, 3, wrong_msg, wrong_msg_len, fixture.basename, fixture.basename_len));
+
+    // No candidates
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revocations, 0, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_multi_group_revoked_fails()
+{
+    printf("Starting signature::verify_multi_group_revoked_fails...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list_bad_raw[1];
+    BIG_XXX_copy(sk_rev_list_bad_raw[0].sk, fixture.sk.sk);
+    struct ecdaa_revocations_ZZZ rev_list_bad = {.sk_length=1, .sk_list=sk_rev_list_bad_raw, .bsn_length=0, .bsn_list=NULL};
+
+    struct ecdaa_group_public_key_ZZZ other_gpk;
+    random_group_public_key(&other_gpk);
+    struct ecdaa_group_public_key_ZZZ *gpks[2] = {&other_gpk, &fixture.ipk.gpk};
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    size_t group_index;
+
+    // Revoked in its own group
+    struct ecdaa_revocations_ZZZ *revoked_in_group[2] = {&fixture.revocations, &rev_list_bad};
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revoked_in_group, 2, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Revocations of other groups don't apply
+    struct ecdaa_revocations_ZZZ *revoked_elsewhere[2] = {&rev_list_bad, &fixture.revocations};
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify_multi_group(&group_index, &sig, gpks, revoked_elsewhere, 2, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(1 == group_index);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
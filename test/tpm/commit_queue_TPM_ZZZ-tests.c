@@ -0,0 +1,214 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "../ecdaa-test-utils.h"
+#include "tpm_ZZZ-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa-tpm/commit_queue_TPM_ZZZ.h>
+#include <ecdaa-tpm/member_keypair_TPM_ZZZ.h>
+#include <ecdaa-tpm/tpm_context.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <string.h>
+
+static void init_bad_arguments_fails();
+static void refill_fills_to_capacity();
+static void sign_from_queue_then_verify();
+static void sign_from_empty_queue_then_verify();
+static void sign_from_queue_unlinkable();
+
+typedef struct commit_queue_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_tpm_commit_queue_ZZZ queue;
+    struct tpm_test_context tpm_ctx;
+} commit_queue_fixture;
+
+static void setup(commit_queue_fixture* fixture);
+static void teardown(commit_queue_fixture *fixture);
+
+int main()
+{
+    init_bad_arguments_fails();
+    refill_fills_to_capacity();
+    sign_from_queue_then_verify();
+    sign_from_empty_queue_then_verify();
+    sign_from_queue_unlinkable();
+}
+
+static void setup(commit_queue_fixture* fixture)
+{
+    TEST_ASSERT(0 == tpm_initialize(&fixture->tpm_ctx));
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    uint8_t *nonce = (uint8_t*)"nonce";
+    uint32_t nonce_len = 5;
+    TEST_ASSERT(0 == ecdaa_member_key_pair_TPM_ZZZ_generate(&fixture->pk, fixture->tpm_ctx.serialized_public_key, nonce, nonce_len, &fixture->tpm_ctx.tpm_ctx));
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    fixture->revocations.sk_length=0;
+    fixture->revocations.sk_list=NULL;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+}
+
+static void teardown(commit_queue_fixture *fixture)
+{
+    tpm_cleanup(&fixture->tpm_ctx);
+}
+
+static void init_bad_arguments_fails()
+{
+    printf("Starting commit_queue_TPM_ZZZ::init_bad_arguments_fails...\n");
+
+    struct ecdaa_tpm_commit_queue_ZZZ queue;
+    struct ecdaa_credential_ZZZ cred;
+    uint8_t *basename = (uint8_t*) "BASENAME";
+
+    TEST_ASSERT(0 != ecdaa_tpm_commit_queue_ZZZ_init(&queue, 0, &cred, NULL, 0));
+    TEST_ASSERT(0 != ecdaa_tpm_commit_queue_ZZZ_init(&queue, ECDAA_TPM_COMMIT_QUEUE_MAX_LENGTH + 1, &cred, NULL, 0));
+    TEST_ASSERT(0 != ecdaa_tpm_commit_queue_ZZZ_init(&queue, 1, &cred, basename, 0));
+    TEST_ASSERT(0 != ecdaa_tpm_commit_queue_ZZZ_init(&queue, 1, &cred, NULL, 8));
+
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_init(&queue, ECDAA_TPM_COMMIT_QUEUE_MAX_LENGTH, &cred, basename, 8));
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_length(&queue));
+
+    printf("\tsuccess\n");
+}
+
+static void refill_fills_to_capacity()
+{
+    printf("Starting commit_queue_TPM_ZZZ::refill_fills_to_capacity...\n");
+
+    commit_queue_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_init(&fixture.queue, 3, &fixture.cred, fixture.basename, fixture.basename_len));
+
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_refill(&fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+    TEST_ASSERT(3 == ecdaa_tpm_commit_queue_ZZZ_length(&fixture.queue));
+
+    // Already full, so nothing to do
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_refill(&fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+    TEST_ASSERT(3 == ecdaa_tpm_commit_queue_ZZZ_length(&fixture.queue));
+
+    ecdaa_tpm_commit_queue_ZZZ_clear(&fixture.queue);
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_length(&fixture.queue));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_from_queue_then_verify()
+{
+    printf("Starting commit_queue_TPM_ZZZ::sign_from_queue_then_verify...\n");
+
+    commit_queue_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_init(&fixture.queue, 3, &fixture.cred, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_refill(&fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    // Use the commits out of order w.r.t. when they were made, interleaved with a refill
+    for (unsigned i = 0; i < 5; i++) {
+        struct ecdaa_signature_ZZZ sig;
+        TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, &fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+        if (2 == i) {
+            TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_length(&fixture.queue));
+            TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_refill(&fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+        }
+    }
+    TEST_ASSERT(1 == ecdaa_tpm_commit_queue_ZZZ_length(&fixture.queue));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_from_empty_queue_then_verify()
+{
+    printf("Starting commit_queue_TPM_ZZZ::sign_from_empty_queue_then_verify...\n");
+
+    commit_queue_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_init(&fixture.queue, 2, &fixture.cred, fixture.basename, fixture.basename_len));
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, &fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_length(&fixture.queue));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_from_queue_unlinkable()
+{
+    printf("Starting commit_queue_TPM_ZZZ::sign_from_queue_unlinkable...\n");
+
+    commit_queue_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_init(&fixture.queue, 2, &fixture.cred, NULL, 0));
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_refill(&fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_tpm_commit_queue_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, &fixture.queue, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, NULL, 0));
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
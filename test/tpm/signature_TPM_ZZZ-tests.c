@@ -36,11 +36,16 @@
 #include <string.h>
 
 #include <sys/time.h>
+#include <sys/select.h>
 
 static void sign_then_verify_good();
 static void sign_then_verify_bad_basename_fails();
 static void sign_then_verify_no_basename();
 static void sign_then_verify_unlinkable();
+static void async_sign_then_verify_good();
+static void async_sign_nonblocking_then_verify_unlinkable();
+static void batch_sign_then_verify();
+static void batch_sign_unlinkable_then_verify();
 
 typedef struct sign_and_verify_fixture {
     uint8_t *msg;
@@ -65,6 +70,10 @@ int main()
     sign_then_verify_bad_basename_fails();
     sign_then_verify_no_basename();
     sign_then_verify_unlinkable();
+    async_sign_then_verify_good();
+    async_sign_nonblocking_then_verify_unlinkable();
+    batch_sign_then_verify();
+    batch_sign_unlinkable_then_verify();
 }
 
 static void setup(sign_and_verify_fixture* fixture)
@@ -183,3 +192,122 @@ static void sign_then_verify_unlinkable()
 
     printf("\tsuccess\n");
 }
+
+static void async_sign_then_verify_good()
+{
+    printf("Starting signature_TPM_ZZZ::async_sign_then_verify_good...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    struct ecdaa_signature_TPM_ZZZ_async async;
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_async_start(&async, &sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.cred, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    int ret;
+    while (1 == (ret = ecdaa_signature_TPM_ZZZ_sign_async_step(&async, TSS2_TCTI_TIMEOUT_BLOCK)))
+        ;
+    TEST_ASSERT(0 == ret);
+
+    // Stepping a completed signature is a no-op
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_async_step(&async, TSS2_TCTI_TIMEOUT_BLOCK));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void async_sign_nonblocking_then_verify_unlinkable()
+{
+    printf("Starting signature_TPM_ZZZ::async_sign_nonblocking_then_verify_unlinkable...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    struct ecdaa_signature_TPM_ZZZ_async async;
+
+    // non-NULL basename, 0 basename_length
+    TEST_ASSERT(0 != ecdaa_signature_TPM_ZZZ_sign_async_start(&async, &sig, fixture.msg, fixture.msg_len, fixture.basename, 0, &fixture.cred, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+    TEST_ASSERT(0 != ecdaa_signature_TPM_ZZZ_sign_async_step(&async, 0));
+
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_async_start(&async, &sig, fixture.msg, fixture.msg_len, NULL, 0, &fixture.cred, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    int ret;
+    unsigned steps = 0;
+    while (1 == (ret = ecdaa_signature_TPM_ZZZ_sign_async_step(&async, 0))) {
+        struct timeval pause = {.tv_sec=0, .tv_usec=1000};
+        select(0, NULL, NULL, NULL, &pause);
+        TEST_ASSERT(++steps < 100000);
+    }
+    TEST_ASSERT(0 == ret);
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, NULL, 0));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void batch_sign_then_verify()
+{
+    printf("Starting signature_TPM_ZZZ::batch_sign_then_verify...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    const uint8_t *messages[5] = {(uint8_t*)"one", (uint8_t*)"two", (uint8_t*)"three", (uint8_t*)"four", (uint8_t*)"five"};
+    uint32_t message_lens[5];
+    for (int i = 0; i < 5; i++)
+        message_lens[i] = (uint32_t)strlen((char*)messages[i]);
+
+    // An empty batch is a no-op
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_batch(NULL, messages, message_lens, 0, fixture.basename, fixture.basename_len, &fixture.cred, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    struct ecdaa_signature_ZZZ sigs[5];
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_batch(sigs, messages, message_lens, 5, fixture.basename, fixture.basename_len, &fixture.cred, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sigs[i], &fixture.ipk.gpk, &fixture.revocations, (uint8_t*)messages[i], message_lens[i], fixture.basename, fixture.basename_len));
+
+        // Same basename, so same pseudonym
+        TEST_ASSERT(ECP_ZZZ_equals(&sigs[0].K, &sigs[i].K));
+    }
+
+    // Each signature is bound to its own message
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&sigs[0], &fixture.ipk.gpk, &fixture.revocations, (uint8_t*)messages[1], message_lens[1], fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void batch_sign_unlinkable_then_verify()
+{
+    printf("Starting signature_TPM_ZZZ::batch_sign_unlinkable_then_verify...\n");
+
+    sign_and_verify_fixture fixture;
+    setup(&fixture);
+
+    const uint8_t *messages[3] = {fixture.msg, fixture.msg, fixture.msg};
+    uint32_t message_lens[3] = {fixture.msg_len, fixture.msg_len, fixture.msg_len};
+
+    struct ecdaa_signature_ZZZ sigs[3];
+
+    // non-NULL basename, 0 basename_length
+    TEST_ASSERT(0 != ecdaa_signature_TPM_ZZZ_sign_batch(sigs, messages, message_lens, 3, fixture.basename, 0, &fixture.cred, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_batch(sigs, messages, message_lens, 3, NULL, 0, &fixture.cred, test_randomness, &fixture.tpm_ctx.tpm_ctx));
+
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sigs[i], &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, NULL, 0));
+
+    // Each signature uses a differently-randomized credential
+    TEST_ASSERT(!ECP_ZZZ_equals(&sigs[0].S, &sigs[1].S));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,188 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "../ecdaa-test-utils.h"
+
+#include <ecdaa-tpm/tpm_context_pool.h>
+#include <ecdaa-tpm/tpm_context.h>
+
+#include <pthread.h>
+#include <string.h>
+
+#define NUM_CONTEXTS 3
+#define NUM_THREADS 8
+#define ITERATIONS_PER_THREAD 1000
+
+static void init_bad_arguments_fails();
+static void acquire_all_then_release();
+static void release_foreign_context_fails();
+static void concurrent_acquire_is_exclusive();
+
+typedef struct pool_fixture {
+    // The pool never touches the contexts, so they needn't be connected to a TPM.
+    struct ecdaa_tpm_context contexts[NUM_CONTEXTS];
+    struct ecdaa_tpm_context *context_ptrs[NUM_CONTEXTS];
+    struct ecdaa_tpm_context_pool pool;
+    int holders[NUM_CONTEXTS];
+} pool_fixture;
+
+static void setup(pool_fixture* fixture);
+static void teardown(pool_fixture *fixture);
+
+int main()
+{
+    init_bad_arguments_fails();
+    acquire_all_then_release();
+    release_foreign_context_fails();
+    concurrent_acquire_is_exclusive();
+}
+
+static void setup(pool_fixture* fixture)
+{
+    memset(fixture->contexts, 0, sizeof(fixture->contexts));
+    for (int i = 0; i < NUM_CONTEXTS; i++) {
+        fixture->context_ptrs[i] = &fixture->contexts[i];
+        fixture->holders[i] = 0;
+    }
+
+    TEST_ASSERT(0 == ecdaa_tpm_context_pool_init(&fixture->pool, fixture->context_ptrs, NUM_CONTEXTS));
+}
+
+static void teardown(pool_fixture *fixture)
+{
+    ecdaa_tpm_context_pool_free(&fixture->pool);
+}
+
+static int context_index(pool_fixture *fixture, struct ecdaa_tpm_context *tpm_ctx)
+{
+    for (int i = 0; i < NUM_CONTEXTS; i++) {
+        if (tpm_ctx == &fixture->contexts[i])
+            return i;
+    }
+    return -1;
+}
+
+static void init_bad_arguments_fails()
+{
+    printf("Starting tpm_context_pool::init_bad_arguments_fails...\n");
+
+    struct ecdaa_tpm_context contexts[2];
+    struct ecdaa_tpm_context *context_ptrs[ECDAA_TPM_CONTEXT_POOL_MAX_SIZE + 1];
+    for (int i = 0; i < ECDAA_TPM_CONTEXT_POOL_MAX_SIZE + 1; i++)
+        context_ptrs[i] = &contexts[i % 2];
+
+    struct ecdaa_tpm_context_pool pool;
+
+    TEST_ASSERT(-1 == ecdaa_tpm_context_pool_init(&pool, context_ptrs, 0));
+    TEST_ASSERT(-1 == ecdaa_tpm_context_pool_init(&pool, context_ptrs, ECDAA_TPM_CONTEXT_POOL_MAX_SIZE + 1));
+
+    context_ptrs[1] = NULL;
+    TEST_ASSERT(-1 == ecdaa_tpm_context_pool_init(&pool, context_ptrs, 2));
+
+    printf("\tsuccess\n");
+}
+
+static void acquire_all_then_release()
+{
+    printf("Starting tpm_context_pool::acquire_all_then_release...\n");
+
+    pool_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_tpm_context *acquired[NUM_CONTEXTS];
+    for (int i = 0; i < NUM_CONTEXTS; i++) {
+        acquired[i] = ecdaa_tpm_context_pool_acquire(&fixture.pool);
+        int index = context_index(&fixture, acquired[i]);
+        TEST_ASSERT(-1 != index);
+        TEST_ASSERT(0 == fixture.holders[index]);
+        fixture.holders[index] = 1;
+    }
+
+    for (int i = 0; i < NUM_CONTEXTS; i++)
+        TEST_ASSERT(0 == ecdaa_tpm_context_pool_release(&fixture.pool, acquired[i]));
+
+    // A context can't be released twice.
+    TEST_ASSERT(-1 == ecdaa_tpm_context_pool_release(&fixture.pool, acquired[0]));
+
+    // Acquisitions rotate through the contexts.
+    struct ecdaa_tpm_context *first = ecdaa_tpm_context_pool_acquire(&fixture.pool);
+    TEST_ASSERT(0 == ecdaa_tpm_context_pool_release(&fixture.pool, first));
+    struct ecdaa_tpm_context *second = ecdaa_tpm_context_pool_acquire(&fixture.pool);
+    TEST_ASSERT(0 == ecdaa_tpm_context_pool_release(&fixture.pool, second));
+    TEST_ASSERT(first != second);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void release_foreign_context_fails()
+{
+    printf("Starting tpm_context_pool::release_foreign_context_fails...\n");
+
+    pool_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_tpm_context foreign;
+    TEST_ASSERT(-1 == ecdaa_tpm_context_pool_release(&fixture.pool, &foreign));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void *acquire_repeatedly(void *arg)
+{
+    pool_fixture *fixture = arg;
+
+    for (int i = 0; i < ITERATIONS_PER_THREAD; i++) {
+        struct ecdaa_tpm_context *tpm_ctx = ecdaa_tpm_context_pool_acquire(&fixture->pool);
+        int index = context_index(fixture, tpm_ctx);
+        TEST_ASSERT(-1 != index);
+
+        int holders = __atomic_add_fetch(&fixture->holders[index], 1, __ATOMIC_SEQ_CST);
+        TEST_ASSERT(1 == holders);
+        __atomic_sub_fetch(&fixture->holders[index], 1, __ATOMIC_SEQ_CST);
+
+        TEST_ASSERT(0 == ecdaa_tpm_context_pool_release(&fixture->pool, tpm_ctx));
+    }
+
+    return NULL;
+}
+
+static void concurrent_acquire_is_exclusive()
+{
+    printf("Starting tpm_context_pool::concurrent_acquire_is_exclusive...\n");
+
+    pool_fixture fixture;
+    setup(&fixture);
+
+    pthread_t threads[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++)
+        TEST_ASSERT(0 == pthread_create(&threads[i], NULL, acquire_repeatedly, &fixture));
+
+    for (int i = 0; i < NUM_THREADS; i++)
+        TEST_ASSERT(0 == pthread_join(threads[i], NULL));
+
+    for (int i = 0; i < NUM_CONTEXTS; i++)
+        TEST_ASSERT(0 == fixture.holders[i]);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,245 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "../ecdaa-test-utils.h"
+#include "tcti_mock_ZZZ.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa-tpm/member_keypair_TPM_ZZZ.h>
+#include <ecdaa-tpm/signature_TPM_ZZZ.h>
+#include <ecdaa-tpm/tpm_context.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+
+#include <string.h>
+
+#define MOCK_KEY_HANDLE 0x81000001
+
+static void keygen_then_validate();
+static void sign_then_verify();
+static void sign_unlinkable_then_verify();
+static void wrong_password_fails();
+static void short_nonce_is_retried();
+static void async_sign_with_latency();
+
+typedef struct mock_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    uint8_t *nonce;
+    uint32_t nonce_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct tcti_mock_ZZZ mock;
+    struct ecdaa_tpm_context tpm_ctx;
+} mock_fixture;
+
+static void setup(mock_fixture* fixture);
+static void teardown(mock_fixture *fixture);
+
+int main()
+{
+    keygen_then_validate();
+    sign_then_verify();
+    sign_unlinkable_then_verify();
+    wrong_password_fails();
+    short_nonce_is_retried();
+    async_sign_with_latency();
+}
+
+static void setup(mock_fixture* fixture)
+{
+    TEST_ASSERT(0 == tcti_mock_ZZZ_init(&fixture->mock, MOCK_KEY_HANDLE, "password", 8, test_randomness));
+    TEST_ASSERT(0 == ecdaa_tpm_context_init(&fixture->tpm_ctx, MOCK_KEY_HANDLE, "password", 8, tcti_mock_ZZZ_tcti(&fixture->mock)));
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    fixture->nonce = (uint8_t*)"nonce";
+    fixture->nonce_len = 5;
+
+    uint8_t serialized_public_key[ECP_ZZZ_LENGTH];
+    tcti_mock_ZZZ_serialize_public_key(serialized_public_key, &fixture->mock);
+    TEST_ASSERT(0 == ecdaa_member_key_pair_TPM_ZZZ_generate(&fixture->pk, serialized_public_key, fixture->nonce, fixture->nonce_len, &fixture->tpm_ctx));
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    TEST_ASSERT(0 == ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness));
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    fixture->revocations.sk_length=0;
+    fixture->revocations.sk_list=NULL;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+}
+
+static void teardown(mock_fixture *fixture)
+{
+    ecdaa_tpm_context_free(&fixture->tpm_ctx);
+    Tss2_Tcti_Finalize(tcti_mock_ZZZ_tcti(&fixture->mock));
+}
+
+static void keygen_then_validate()
+{
+    printf("Starting tpm_mock::keygen_then_validate...\n");
+
+    mock_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(0 == ecdaa_member_public_key_ZZZ_validate(&fixture.pk, fixture.nonce, fixture.nonce_len));
+
+    // Wrong nonce
+    TEST_ASSERT(0 != ecdaa_member_public_key_ZZZ_validate(&fixture.pk, (uint8_t*)"wrong", 5));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_then_verify()
+{
+    printf("Starting tpm_mock::sign_then_verify...\n");
+
+    mock_fixture fixture;
+    setup(&fixture);
+
+    unsigned long commands_before = fixture.mock.commands_received;
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.cred, test_randomness, &fixture.tpm_ctx));
+
+    // One TPM2_Commit and one TPM2_Sign
+    TEST_ASSERT(2 == fixture.mock.commands_received - commands_before);
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Wrong basename
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, (uint8_t*)"wrong", 5));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void sign_unlinkable_then_verify()
+{
+    printf("Starting tpm_mock::sign_unlinkable_then_verify...\n");
+
+    mock_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, NULL, 0, &fixture.cred, test_randomness, &fixture.tpm_ctx));
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, NULL, 0));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void wrong_password_fails()
+{
+    printf("Starting tpm_mock::wrong_password_fails...\n");
+
+    mock_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_tpm_context wrong_ctx;
+    TEST_ASSERT(0 == ecdaa_tpm_context_init(&wrong_ctx, MOCK_KEY_HANDLE, "wrong", 5, tcti_mock_ZZZ_tcti(&fixture.mock)));
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 != ecdaa_signature_TPM_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.cred, test_randomness, &wrong_ctx));
+    TEST_ASSERT(TPM2_RC_AUTH_FAIL == wrong_ctx.last_return_code);
+
+    ecdaa_tpm_context_free(&wrong_ctx);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void short_nonce_is_retried()
+{
+    printf("Starting tpm_mock::short_nonce_is_retried...\n");
+
+    mock_fixture fixture;
+    setup(&fixture);
+
+    tcti_mock_ZZZ_short_nonces(&fixture.mock, 2);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.cred, test_randomness, &fixture.tpm_ctx));
+    TEST_ASSERT(0 == fixture.mock.short_nonces);
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void async_sign_with_latency()
+{
+    printf("Starting tpm_mock::async_sign_with_latency...\n");
+
+    mock_fixture fixture;
+    setup(&fixture);
+
+    tcti_mock_ZZZ_set_latency(&fixture.mock, 20000, 20000);
+
+    struct ecdaa_signature_ZZZ sig;
+    struct ecdaa_signature_TPM_ZZZ_async async;
+    TEST_ASSERT(0 == ecdaa_signature_TPM_ZZZ_sign_async_start(&async, &sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.cred, test_randomness, &fixture.tpm_ctx));
+
+    // The TPM2_Commit response isn't ready yet
+    TEST_ASSERT(1 == ecdaa_signature_TPM_ZZZ_sign_async_step(&async, 0));
+
+    int ret;
+    unsigned steps = 0;
+    while (1 == (ret = ecdaa_signature_TPM_ZZZ_sign_async_step(&async, 1)))
+        TEST_ASSERT(++steps < 1000);
+    TEST_ASSERT(0 == ret);
+
+    // Both commands' latencies were waited out across several steps
+    TEST_ASSERT(steps >= 2);
+
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
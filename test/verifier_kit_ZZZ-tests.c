@@ -0,0 +1,324 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/verifier_kit_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static void open_matches_written();
+static void verify_with_kit();
+static void shared_by_many_opens();
+static void malformed_kit_rejected();
+static void pseudonym_index_lookup();
+
+#define NUM_SK_REVOCATIONS 5
+#define NUM_BSN_REVOCATIONS 3
+
+typedef struct kit_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list[NUM_SK_REVOCATIONS];
+    ECP_ZZZ bsn_rev_list[NUM_BSN_REVOCATIONS];
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    char kit_file[64];
+} kit_fixture;
+
+static void setup(kit_fixture* fixture);
+static void teardown(kit_fixture *fixture);
+
+int main()
+{
+    open_matches_written();
+    verify_with_kit();
+    shared_by_many_opens();
+    malformed_kit_rejected();
+    pseudonym_index_lookup();
+}
+
+static void setup(kit_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    // Revocation lists of other (random) members, so the signature still verifies
+    for (size_t i = 0; i < NUM_SK_REVOCATIONS; i++)
+        ecp_ZZZ_random_mod_order(&fixture->sk_rev_list[i].sk, test_randomness);
+    for (size_t i = 0; i < NUM_BSN_REVOCATIONS; i++) {
+        BIG_XXX x;
+        ecp_ZZZ_random_mod_order(&x, test_randomness);
+        ecp_ZZZ_set_to_generator(&fixture->bsn_rev_list[i]);
+        ECP_ZZZ_mul(&fixture->bsn_rev_list[i], x);
+    }
+    fixture->revocations.sk_length=NUM_SK_REVOCATIONS;
+    fixture->revocations.sk_list=fixture->sk_rev_list;
+    fixture->revocations.bsn_length=NUM_BSN_REVOCATIONS;
+    fixture->revocations.bsn_list=fixture->bsn_rev_list;
+
+    strcpy(fixture->kit_file, "/tmp/ecdaa-verifier-kit-XXXXXX");
+    int fd = mkstemp(fixture->kit_file);
+    TEST_ASSERT(-1 != fd);
+    close(fd);
+}
+
+static void teardown(kit_fixture *fixture)
+{
+    unlink(fixture->kit_file);
+}
+
+static void open_matches_written()
+{
+    printf("Starting verifier_kit::open_matches_written...\n");
+
+    kit_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(fixture.kit_file, &fixture.ipk.gpk, &fixture.revocations));
+
+    struct ecdaa_verifier_kit_ZZZ *kit;
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+
+    struct ecdaa_group_public_key_ZZZ *gpk = ecdaa_verifier_kit_ZZZ_group_public_key(kit);
+    TEST_ASSERT(ECP2_ZZZ_equals(&fixture.ipk.gpk.X, &gpk->X));
+    TEST_ASSERT(ECP2_ZZZ_equals(&fixture.ipk.gpk.Y, &gpk->Y));
+
+    struct ecdaa_revocations_ZZZ *revocations = ecdaa_verifier_kit_ZZZ_revocations(kit);
+    TEST_ASSERT(NUM_SK_REVOCATIONS == revocations->sk_length);
+    for (size_t i = 0; i < NUM_SK_REVOCATIONS; i++)
+        TEST_ASSERT(0 == BIG_XXX_comp(fixture.sk_rev_list[i].sk, revocations->sk_list[i].sk));
+    TEST_ASSERT(NUM_BSN_REVOCATIONS == revocations->bsn_length);
+    for (size_t i = 0; i < NUM_BSN_REVOCATIONS; i++)
+        TEST_ASSERT(ECP_ZZZ_equals(&fixture.bsn_rev_list[i], &revocations->bsn_list[i]));
+
+    ecdaa_verifier_kit_ZZZ_close(kit);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void verify_with_kit()
+{
+    printf("Starting verifier_kit::verify_with_kit...\n");
+
+    kit_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    struct ecdaa_verifier_kit_ZZZ *kit;
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(fixture.kit_file, &fixture.ipk.gpk, &fixture.revocations));
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, ecdaa_verifier_kit_ZZZ_group_public_key(kit), ecdaa_verifier_kit_ZZZ_revocations(kit), fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Re-writing the kit (eg. to revoke this member) doesn't disturb the open one
+    fixture.sk_rev_list[NUM_SK_REVOCATIONS - 1] = fixture.sk;
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(fixture.kit_file, &fixture.ipk.gpk, &fixture.revocations));
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, ecdaa_verifier_kit_ZZZ_group_public_key(kit), ecdaa_verifier_kit_ZZZ_revocations(kit), fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    struct ecdaa_verifier_kit_ZZZ *updated_kit;
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&updated_kit, fixture.kit_file));
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&sig, ecdaa_verifier_kit_ZZZ_group_public_key(updated_kit), ecdaa_verifier_kit_ZZZ_revocations(updated_kit), fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    ecdaa_verifier_kit_ZZZ_close(updated_kit);
+    ecdaa_verifier_kit_ZZZ_close(kit);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void shared_by_many_opens()
+{
+    printf("Starting verifier_kit::shared_by_many_opens...\n");
+
+    kit_fixture fixture;
+    setup(&fixture);
+
+    // Empty revocation lists
+    fixture.revocations.sk_length = 0;
+    fixture.revocations.sk_list = NULL;
+    fixture.revocations.bsn_length = 0;
+    fixture.revocations.bsn_list = NULL;
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(fixture.kit_file, &fixture.ipk.gpk, &fixture.revocations));
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, NULL, 0, &fixture.sk, &fixture.cred, test_randomness));
+
+    struct ecdaa_verifier_kit_ZZZ *kits[4];
+    for (size_t i = 0; i < 4; i++)
+        TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&kits[i], fixture.kit_file));
+
+    for (size_t i = 0; i < 4; i++) {
+        struct ecdaa_revocations_ZZZ *revocations = ecdaa_verifier_kit_ZZZ_revocations(kits[i]);
+        TEST_ASSERT(0 == revocations->sk_length);
+        TEST_ASSERT(0 == revocations->bsn_length);
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_verify(&sig, ecdaa_verifier_kit_ZZZ_group_public_key(kits[i]), revocations, fixture.msg, fixture.msg_len, NULL, 0));
+    }
+
+    for (size_t i = 0; i < 4; i++)
+        ecdaa_verifier_kit_ZZZ_close(kits[i]);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void malformed_kit_rejected()
+{
+    printf("Starting verifier_kit::malformed_kit_rejected...\n");
+
+    kit_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_verifier_kit_ZZZ *kit;
+
+    // Empty file
+    TEST_ASSERT(-1 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+
+    // Missing file
+    TEST_ASSERT(-1 == ecdaa_verifier_kit_ZZZ_open(&kit, "/nonexistent/ecdaa-verifier-kit"));
+
+    // Truncated kit
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(fixture.kit_file, &fixture.ipk.gpk, &fixture.revocations));
+    FILE *fp = fopen(fixture.kit_file, "rb");
+    TEST_ASSERT(NULL != fp);
+    uint8_t buffer[4096];
+    size_t length = fread(buffer, 1, sizeof(buffer), fp);
+    fclose(fp);
+    TEST_ASSERT(length > 16 && length < sizeof(buffer));
+
+    fp = fopen(fixture.kit_file, "wb");
+    TEST_ASSERT(NULL != fp);
+    TEST_ASSERT(length - 1 == fwrite(buffer, 1, length - 1, fp));
+    fclose(fp);
+    TEST_ASSERT(-1 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+
+    // Wrong curve name
+    buffer[8] ^= 1;
+    fp = fopen(fixture.kit_file, "wb");
+    TEST_ASSERT(NULL != fp);
+    TEST_ASSERT(length == fwrite(buffer, 1, length, fp));
+    fclose(fp);
+    TEST_ASSERT(-1 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+    buffer[8] ^= 1;
+
+    // Corrupted contents (in the last pseudonym)
+    buffer[length - 1] ^= 1;
+    fp = fopen(fixture.kit_file, "wb");
+    TEST_ASSERT(NULL != fp);
+    TEST_ASSERT(length == fwrite(buffer, 1, length, fp));
+    fclose(fp);
+    TEST_ASSERT(-1 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+    buffer[length - 1] ^= 1;
+
+    // Restored, it opens again
+    fp = fopen(fixture.kit_file, "wb");
+    TEST_ASSERT(NULL != fp);
+    TEST_ASSERT(length == fwrite(buffer, 1, length, fp));
+    fclose(fp);
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+    ecdaa_verifier_kit_ZZZ_close(kit);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void pseudonym_index_lookup()
+{
+    printf("Starting verifier_kit::pseudonym_index_lookup...\n");
+
+    kit_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len, &fixture.sk, &fixture.cred, test_randomness));
+
+    struct ecdaa_verifier_kit_ZZZ *kit;
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(fixture.kit_file, &fixture.ipk.gpk, &fixture.revocations));
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+
+    // Every revoked pseudonym is found, whatever its position in the (sorted) index
+    for (size_t i = 0; i < NUM_BSN_REVOCATIONS; i++) {
+        uint8_t pseudonym[ECP_ZZZ_LENGTH];
+        ecp_ZZZ_serialize(pseudonym, &fixture.bsn_rev_list[i]);
+        TEST_ASSERT(-1 == ecdaa_verifier_kit_ZZZ_check_pseudonym(kit, pseudonym));
+    }
+
+    uint8_t signer_pseudonym[ECP_ZZZ_LENGTH];
+    ecp_ZZZ_serialize(signer_pseudonym, &sig.K);
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_check_pseudonym(kit, signer_pseudonym));
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_verify(kit, &sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+    TEST_ASSERT(0 != ecdaa_verifier_kit_ZZZ_verify(kit, &sig, (uint8_t*)"Wrong message", 13, fixture.basename, fixture.basename_len));
+
+    ecdaa_verifier_kit_ZZZ_close(kit);
+
+    // Revoke the signer's pseudonym
+    ECP_ZZZ_copy(&fixture.bsn_rev_list[1], &sig.K);
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_write_file(fixture.kit_file, &fixture.ipk.gpk, &fixture.revocations));
+    TEST_ASSERT(0 == ecdaa_verifier_kit_ZZZ_open(&kit, fixture.kit_file));
+
+    TEST_ASSERT(-1 == ecdaa_verifier_kit_ZZZ_check_pseudonym(kit, signer_pseudonym));
+    TEST_ASSERT(0 != ecdaa_verifier_kit_ZZZ_verify(kit, &sig, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    // Same result as the linear scan
+    TEST_ASSERT(0 != ecdaa_signature_ZZZ_verify(&sig, ecdaa_verifier_kit_ZZZ_group_public_key(kit), ecdaa_verifier_kit_ZZZ_revocations(kit), fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    ecdaa_verifier_kit_ZZZ_close(kit);
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,317 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/verify_cache_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <string.h>
+
+static void zero_capacity_rejected();
+static void repeat_is_hit();
+static void invalid_result_cached();
+static void inputs_are_part_of_key();
+static void revocations_changed_invalidates();
+static void different_revocations_not_shared();
+static void reused_list_memory_not_shared();
+
+typedef struct cache_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    uint8_t sig_buffer[ECDAA_SIGNATURE_ZZZ_WITH_NYM_LENGTH];
+    struct ecdaa_verify_cache_ZZZ *cache;
+} cache_fixture;
+
+static void setup(cache_fixture* fixture);
+static void teardown(cache_fixture *fixture);
+
+int main()
+{
+    zero_capacity_rejected();
+    repeat_is_hit();
+    invalid_result_cached();
+    inputs_are_part_of_key();
+    revocations_changed_invalidates();
+    different_revocations_not_shared();
+    reused_list_memory_not_shared();
+}
+
+static void setup(cache_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    fixture->revocations.sk_length=0;
+    fixture->revocations.sk_list=NULL;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+
+    struct ecdaa_signature_ZZZ sig;
+    TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&sig, fixture->msg, fixture->msg_len, fixture->basename, fixture->basename_len, &fixture->sk, &fixture->cred, test_randomness));
+    ecdaa_signature_ZZZ_serialize(fixture->sig_buffer, &sig, 1);
+
+    TEST_ASSERT(0 == ecdaa_verify_cache_ZZZ_new(&fixture->cache, 128));
+}
+
+static void teardown(cache_fixture *fixture)
+{
+    ecdaa_verify_cache_ZZZ_free(fixture->cache);
+}
+
+static int cached_verify(cache_fixture *fixture, uint8_t *msg, uint32_t msg_len)
+{
+    return ecdaa_verify_cache_ZZZ_deserialize_and_verify(fixture->cache,
+                                                         &fixture->ipk.gpk,
+                                                         fixture->sig_buffer,
+                                                         msg,
+                                                         msg_len,
+                                                         fixture->basename,
+                                                         fixture->basename_len,
+                                                         1);
+}
+
+static void zero_capacity_rejected()
+{
+    printf("Starting verify_cache::zero_capacity_rejected...\n");
+
+    struct ecdaa_verify_cache_ZZZ *cache;
+    TEST_ASSERT(-1 == ecdaa_verify_cache_ZZZ_new(&cache, 0));
+
+    printf("\tsuccess\n");
+}
+
+static void repeat_is_hit()
+{
+    printf("Starting verify_cache::repeat_is_hit...\n");
+
+    cache_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_verify_cache_stats_ZZZ stats;
+
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(0 == stats.hits);
+    TEST_ASSERT(1 == stats.misses);
+
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(2 == stats.hits);
+    TEST_ASSERT(1 == stats.misses);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void invalid_result_cached()
+{
+    printf("Starting verify_cache::invalid_result_cached...\n");
+
+    cache_fixture fixture;
+    setup(&fixture);
+
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    uint32_t wrong_msg_len = (uint32_t)strlen((char*)wrong_msg);
+
+    TEST_ASSERT(-2 == cached_verify(&fixture, wrong_msg, wrong_msg_len));
+    TEST_ASSERT(-2 == cached_verify(&fixture, wrong_msg, wrong_msg_len));
+
+    struct ecdaa_verify_cache_stats_ZZZ stats;
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(1 == stats.hits);
+    TEST_ASSERT(1 == stats.misses);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void inputs_are_part_of_key()
+{
+    printf("Starting verify_cache::inputs_are_part_of_key...\n");
+
+    cache_fixture fixture;
+    setup(&fixture);
+
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    // A different message, basename, or signature is a miss (and is really verified)
+    uint8_t *wrong_msg = (uint8_t*) "Wrong message";
+    TEST_ASSERT(-2 == cached_verify(&fixture, wrong_msg, (uint32_t)strlen((char*)wrong_msg)));
+
+    fixture.basename = (uint8_t*) "OTHER BASENAME";
+    fixture.basename_len = (uint32_t)strlen((char*)fixture.basename);
+    TEST_ASSERT(-2 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    fixture.basename = (uint8_t*) "BASENAME";
+    fixture.basename_len = (uint32_t)strlen((char*)fixture.basename);
+    fixture.sig_buffer[0] ^= 1;
+    TEST_ASSERT(0 != cached_verify(&fixture, fixture.msg, fixture.msg_len));
+    fixture.sig_buffer[0] ^= 1;
+
+    struct ecdaa_verify_cache_stats_ZZZ stats;
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(0 == stats.hits);
+    TEST_ASSERT(4 == stats.misses);
+
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(1 == stats.hits);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void revocations_changed_invalidates()
+{
+    printf("Starting verify_cache::revocations_changed_invalidates...\n");
+
+    cache_fixture fixture;
+    setup(&fixture);
+
+    // A list of another (random) member, so the signature still verifies
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list[1];
+    ecp_ZZZ_random_mod_order(&sk_rev_list[0].sk, test_randomness);
+    fixture.revocations.sk_length=1;
+    fixture.revocations.sk_list=sk_rev_list;
+    ecdaa_verify_cache_ZZZ_set_revocations(fixture.cache, &fixture.revocations);
+
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    // Revoke the signer, by modifying the list in place
+    BIG_XXX_copy(sk_rev_list[0].sk, fixture.sk.sk);
+    ecdaa_verify_cache_ZZZ_revocations_changed(fixture.cache);
+
+    TEST_ASSERT(-2 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    struct ecdaa_verify_cache_stats_ZZZ stats;
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(0 == stats.hits);
+    TEST_ASSERT(2 == stats.misses);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void different_revocations_not_shared()
+{
+    printf("Starting verify_cache::different_revocations_not_shared...\n");
+
+    cache_fixture fixture;
+    setup(&fixture);
+
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list_bad_raw[1];
+    BIG_XXX_copy(sk_rev_list_bad_raw[0].sk, fixture.sk.sk);
+    struct ecdaa_revocations_ZZZ rev_list_bad = {.sk_length=1, .sk_list=sk_rev_list_bad_raw, .bsn_length=0, .bsn_list=NULL};
+
+    // Valid against the initial (empty) lists
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    // But revoked against other lists, on the same cache
+    ecdaa_verify_cache_ZZZ_set_revocations(fixture.cache, &rev_list_bad);
+    TEST_ASSERT(-2 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    // And each result is still cached for lists with the same contents, wherever they are
+    ecdaa_verify_cache_ZZZ_set_revocations(fixture.cache, &fixture.revocations);
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list_copy_raw[1];
+    BIG_XXX_copy(sk_rev_list_copy_raw[0].sk, fixture.sk.sk);
+    struct ecdaa_revocations_ZZZ rev_list_copy = {.sk_length=1, .sk_list=sk_rev_list_copy_raw, .bsn_length=0, .bsn_list=NULL};
+    ecdaa_verify_cache_ZZZ_set_revocations(fixture.cache, &rev_list_copy);
+    TEST_ASSERT(-2 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    struct ecdaa_verify_cache_stats_ZZZ stats;
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(2 == stats.hits);
+    TEST_ASSERT(2 == stats.misses);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void reused_list_memory_not_shared()
+{
+    printf("Starting verify_cache::reused_list_memory_not_shared...\n");
+
+    cache_fixture fixture;
+    setup(&fixture);
+
+    // Lists of another (random) member, so the signature verifies
+    struct ecdaa_member_secret_key_ZZZ sk_rev_list[1];
+    ecp_ZZZ_random_mod_order(&sk_rev_list[0].sk, test_randomness);
+    struct ecdaa_revocations_ZZZ rev_list = {.sk_length=1, .sk_list=sk_rev_list, .bsn_length=0, .bsn_list=NULL};
+    ecdaa_verify_cache_ZZZ_set_revocations(fixture.cache, &rev_list);
+
+    TEST_ASSERT(0 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    // New lists at the same address (as after a free and malloc), revoking the signer
+    BIG_XXX_copy(sk_rev_list[0].sk, fixture.sk.sk);
+    ecdaa_verify_cache_ZZZ_set_revocations(fixture.cache, &rev_list);
+
+    TEST_ASSERT(-2 == cached_verify(&fixture, fixture.msg, fixture.msg_len));
+
+    struct ecdaa_verify_cache_stats_ZZZ stats;
+    ecdaa_verify_cache_ZZZ_stats(&stats, fixture.cache);
+    TEST_ASSERT(0 == stats.hits);
+    TEST_ASSERT(2 == stats.misses);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,268 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include "ecdaa-test-utils.h"
+
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "amcl-extensions/ecp2_ZZZ.h"
+
+#include <ecdaa/verify_scheduler_ZZZ.h>
+#include <ecdaa/member_keypair_ZZZ.h>
+#include <ecdaa/credential_ZZZ.h>
+#include <ecdaa/issuer_keypair_ZZZ.h>
+#include <ecdaa/signature_ZZZ.h>
+#include <ecdaa/group_public_key_ZZZ.h>
+#include <ecdaa/revocations_ZZZ.h>
+
+#include <pthread.h>
+#include <string.h>
+
+static void verify_many_jobs();
+static void callbacks_invoked();
+static void long_sk_revocation_list_split();
+static void single_worker();
+
+#define NUM_JOBS 12
+#define LONG_SK_LIST_LENGTH (4*ECDAA_VERIFY_SCHEDULER_SK_CHUNK_LENGTH + 5)
+
+typedef struct scheduler_fixture {
+    uint8_t *msg;
+    uint32_t msg_len;
+    uint8_t *basename;
+    uint32_t basename_len;
+    struct ecdaa_revocations_ZZZ revocations;
+    struct ecdaa_member_public_key_ZZZ pk;
+    struct ecdaa_member_secret_key_ZZZ sk;
+    struct ecdaa_issuer_public_key_ZZZ ipk;
+    struct ecdaa_issuer_secret_key_ZZZ isk;
+    struct ecdaa_credential_ZZZ cred;
+    struct ecdaa_signature_ZZZ sigs[NUM_JOBS];
+    struct ecdaa_verify_job_ZZZ jobs[NUM_JOBS];
+} scheduler_fixture;
+
+static void setup(scheduler_fixture* fixture);
+static void teardown(scheduler_fixture *fixture);
+
+int main()
+{
+    verify_many_jobs();
+    callbacks_invoked();
+    long_sk_revocation_list_split();
+    single_worker();
+}
+
+static void setup(scheduler_fixture* fixture)
+{
+    ecp_ZZZ_random_mod_order(&fixture->isk.x, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.X);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.X, fixture->isk.x);
+
+    ecp_ZZZ_random_mod_order(&fixture->isk.y, test_randomness);
+    ecp2_ZZZ_set_to_generator(&fixture->ipk.gpk.Y);
+    ECP2_ZZZ_mul(&fixture->ipk.gpk.Y, fixture->isk.y);
+
+    ecp_ZZZ_set_to_generator(&fixture->pk.Q);
+    ecp_ZZZ_random_mod_order(&fixture->sk.sk, test_randomness);
+    ECP_ZZZ_mul(&fixture->pk.Q, fixture->sk.sk);
+
+    struct ecdaa_credential_ZZZ_signature cred_sig;
+    ecdaa_credential_ZZZ_generate(&fixture->cred, &cred_sig, &fixture->isk, &fixture->pk, test_randomness);
+
+    fixture->msg = (uint8_t*) "Test message";
+    fixture->msg_len = (uint32_t)strlen((char*)fixture->msg);
+
+    fixture->basename = (uint8_t*) "BASENAME";
+    fixture->basename_len = (uint32_t)strlen((char*)fixture->basename);
+
+    fixture->revocations.sk_length=0;
+    fixture->revocations.sk_list=NULL;
+    fixture->revocations.bsn_length=0;
+    fixture->revocations.bsn_list=NULL;
+
+    for (size_t i = 0; i < NUM_JOBS; i++) {
+        TEST_ASSERT(0 == ecdaa_signature_ZZZ_sign(&fixture->sigs[i], fixture->msg, fixture->msg_len, fixture->basename, fixture->basename_len, &fixture->sk, &fixture->cred, test_randomness));
+
+        memset(&fixture->jobs[i], 0, sizeof(struct ecdaa_verify_job_ZZZ));
+        fixture->jobs[i].signature = &fixture->sigs[i];
+        fixture->jobs[i].gpk = &fixture->ipk.gpk;
+        fixture->jobs[i].revocations = &fixture->revocations;
+        fixture->jobs[i].message = fixture->msg;
+        fixture->jobs[i].message_len = fixture->msg_len;
+        fixture->jobs[i].basename = fixture->basename;
+        fixture->jobs[i].basename_len = fixture->basename_len;
+    }
+}
+
+static void teardown(scheduler_fixture *fixture)
+{
+    (void)fixture;
+}
+
+static void verify_many_jobs()
+{
+    printf("Starting verify_scheduler::verify_many_jobs...\n");
+
+    static scheduler_fixture fixture;
+    setup(&fixture);
+
+    // Every third signature is for a different message
+    for (size_t i = 0; i < NUM_JOBS; i += 3)
+        fixture.jobs[i].message = (uint8_t*) "Other message";
+
+    struct ecdaa_verify_scheduler_ZZZ *scheduler;
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_new(&scheduler, 4));
+
+    for (size_t i = 0; i < NUM_JOBS; i++)
+        TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_submit(scheduler, &fixture.jobs[i]));
+
+    for (size_t i = 0; i < NUM_JOBS; i++) {
+        int expected = (0 == i % 3) ? -1 : 0;
+        TEST_ASSERT(expected == ecdaa_verify_scheduler_ZZZ_wait(scheduler, &fixture.jobs[i]));
+        TEST_ASSERT(1 == fixture.jobs[i].done);
+        TEST_ASSERT(expected == fixture.jobs[i].result);
+    }
+
+    ecdaa_verify_scheduler_ZZZ_free(scheduler);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+struct callback_counter {
+    pthread_mutex_t lock;
+    unsigned valid;
+    unsigned invalid;
+};
+
+static void count_result(int result, void *user_data)
+{
+    struct callback_counter *counter = user_data;
+
+    pthread_mutex_lock(&counter->lock);
+    if (0 == result)
+        counter->valid++;
+    else
+        counter->invalid++;
+    pthread_mutex_unlock(&counter->lock);
+}
+
+static void callbacks_invoked()
+{
+    printf("Starting verify_scheduler::callbacks_invoked...\n");
+
+    static scheduler_fixture fixture;
+    setup(&fixture);
+
+    struct callback_counter counter;
+    pthread_mutex_init(&counter.lock, NULL);
+    counter.valid = 0;
+    counter.invalid = 0;
+
+    fixture.jobs[0].basename = (uint8_t*) "Other basename";
+    fixture.jobs[0].basename_len = (uint32_t)strlen((char*)fixture.jobs[0].basename);
+
+    struct ecdaa_verify_scheduler_ZZZ *scheduler;
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_new(&scheduler, 0));
+
+    for (size_t i = 0; i < NUM_JOBS; i++) {
+        fixture.jobs[i].callback = count_result;
+        fixture.jobs[i].user_data = &counter;
+        TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_submit(scheduler, &fixture.jobs[i]));
+    }
+
+    // Freeing waits for every job (and callback) to finish
+    ecdaa_verify_scheduler_ZZZ_free(scheduler);
+
+    TEST_ASSERT(NUM_JOBS - 1 == counter.valid);
+    TEST_ASSERT(1 == counter.invalid);
+
+    pthread_mutex_destroy(&counter.lock);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void long_sk_revocation_list_split()
+{
+    printf("Starting verify_scheduler::long_sk_revocation_list_split...\n");
+
+    static scheduler_fixture fixture;
+    setup(&fixture);
+
+    static struct ecdaa_member_secret_key_ZZZ sk_list[LONG_SK_LIST_LENGTH];
+    for (size_t i = 0; i < LONG_SK_LIST_LENGTH; i++)
+        ecp_ZZZ_random_mod_order(&sk_list[i].sk, test_randomness);
+    fixture.revocations.sk_list = sk_list;
+    fixture.revocations.sk_length = LONG_SK_LIST_LENGTH;
+
+    struct ecdaa_verify_scheduler_ZZZ *scheduler;
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_new(&scheduler, 4));
+
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_submit(scheduler, &fixture.jobs[0]));
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_wait(scheduler, &fixture.jobs[0]));
+
+    // Revoke the signer, in the last (short) chunk
+    BIG_XXX_copy(sk_list[LONG_SK_LIST_LENGTH - 1].sk, fixture.sk.sk);
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_submit(scheduler, &fixture.jobs[1]));
+    TEST_ASSERT(-1 == ecdaa_verify_scheduler_ZZZ_wait(scheduler, &fixture.jobs[1]));
+
+    // ... and in a middle one
+    ecp_ZZZ_random_mod_order(&sk_list[LONG_SK_LIST_LENGTH - 1].sk, test_randomness);
+    BIG_XXX_copy(sk_list[ECDAA_VERIFY_SCHEDULER_SK_CHUNK_LENGTH + 3].sk, fixture.sk.sk);
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_submit(scheduler, &fixture.jobs[2]));
+    TEST_ASSERT(-1 == ecdaa_verify_scheduler_ZZZ_wait(scheduler, &fixture.jobs[2]));
+
+    // The scheduler agrees with the single-threaded verify
+    TEST_ASSERT(-1 == ecdaa_signature_ZZZ_verify(&fixture.sigs[2], &fixture.ipk.gpk, &fixture.revocations, fixture.msg, fixture.msg_len, fixture.basename, fixture.basename_len));
+
+    ecdaa_verify_scheduler_ZZZ_free(scheduler);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
+
+static void single_worker()
+{
+    printf("Starting verify_scheduler::single_worker...\n");
+
+    static scheduler_fixture fixture;
+    setup(&fixture);
+
+    static struct ecdaa_member_secret_key_ZZZ sk_list[LONG_SK_LIST_LENGTH];
+    for (size_t i = 0; i < LONG_SK_LIST_LENGTH; i++)
+        ecp_ZZZ_random_mod_order(&sk_list[i].sk, test_randomness);
+    fixture.revocations.sk_list = sk_list;
+    fixture.revocations.sk_length = LONG_SK_LIST_LENGTH;
+
+    struct ecdaa_verify_scheduler_ZZZ *scheduler;
+    TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_new(&scheduler, 1));
+
+    for (size_t i = 0; i < 3; i++)
+        TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_submit(scheduler, &fixture.jobs[i]));
+    for (size_t i = 0; i < 3; i++)
+        TEST_ASSERT(0 == ecdaa_verify_scheduler_ZZZ_wait(scheduler, &fixture.jobs[i]));
+
+    ecdaa_verify_scheduler_ZZZ_free(scheduler);
+
+    teardown(&fixture);
+
+    printf("\tsuccess\n");
+}
@@ -0,0 +1,574 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "tcti_mock_ZZZ.h"
+
+#include "amcl-extensions/big_XXX.h"
+#include "amcl-extensions/ecp_ZZZ.h"
+#include "internal-utilities/explicit_bzero.h"
+
+#include <amcl/fp_YYY.h>
+
+#include <string.h>
+#include <time.h>
+
+#define TCTI_MOCK_MAGIC 0x6d6f636b45434441ULL
+
+// Bounds-checked big-endian (un)marshalling of TPM command and response buffers.
+//  Any out-of-bounds access sets `error`, and later accesses are no-ops.
+struct cursor {
+    uint8_t *buffer;
+    size_t size;
+    size_t offset;
+    int error;
+};
+
+static uint8_t get_u8(struct cursor *cur);
+static uint16_t get_u16(struct cursor *cur);
+static uint32_t get_u32(struct cursor *cur);
+static const uint8_t *get_tpm2b(struct cursor *cur, uint16_t *size_out);
+
+static void put_u8(struct cursor *cur, uint8_t value);
+static void put_u16(struct cursor *cur, uint16_t value);
+static void put_u32(struct cursor *cur, uint32_t value);
+static void put_tpm2b(struct cursor *cur, const uint8_t *data, uint16_t size);
+
+static int get_point(ECP_ZZZ *point_out, struct cursor *cur, int *present_out);
+static void put_point(struct cursor *cur, ECP_ZZZ *point);
+
+static uint64_t now_ns(void);
+static void sleep_ns(uint64_t duration_ns);
+
+static TSS2_RC mock_transmit(TSS2_TCTI_CONTEXT *tcti_context, size_t size, uint8_t const *command);
+static TSS2_RC mock_receive(TSS2_TCTI_CONTEXT *tcti_context, size_t *size, uint8_t *response, int32_t timeout);
+static void mock_finalize(TSS2_TCTI_CONTEXT *tcti_context);
+static TSS2_RC mock_cancel(TSS2_TCTI_CONTEXT *tcti_context);
+static TSS2_RC mock_get_poll_handles(TSS2_TCTI_CONTEXT *tcti_context, TSS2_TCTI_POLL_HANDLE *handles, size_t *num_handles);
+static TSS2_RC mock_set_locality(TSS2_TCTI_CONTEXT *tcti_context, uint8_t locality);
+static TSS2_RC mock_make_sticky(TSS2_TCTI_CONTEXT *tcti_context, TPM2_HANDLE *handle, uint8_t sticky);
+
+static TPM2_RC check_authorization(struct tcti_mock_ZZZ *mock, struct cursor *cmd);
+static TPM2_RC execute_commit(struct tcti_mock_ZZZ *mock, struct cursor *cmd, struct cursor *params_out);
+static TPM2_RC execute_sign(struct tcti_mock_ZZZ *mock, struct cursor *cmd, struct cursor *params_out);
+
+int tcti_mock_ZZZ_init(struct tcti_mock_ZZZ *mock,
+                       TPM2_HANDLE key_handle,
+                       const char *password,
+                       uint16_t password_length,
+                       ecdaa_rand_func get_random)
+{
+    if (password_length > sizeof(mock->password))
+        return -1;
+    if (0 != password_length && NULL == password)
+        return -1;
+
+    memset(mock, 0, sizeof(struct tcti_mock_ZZZ));
+
+    mock->common.v1.magic = TCTI_MOCK_MAGIC;
+    mock->common.v1.version = 2;
+    mock->common.v1.transmit = mock_transmit;
+    mock->common.v1.receive = mock_receive;
+    mock->common.v1.finalize = mock_finalize;
+    mock->common.v1.cancel = mock_cancel;
+    mock->common.v1.getPollHandles = mock_get_poll_handles;
+    mock->common.v1.setLocality = mock_set_locality;
+    mock->common.makeSticky = mock_make_sticky;
+
+    mock->key_handle = key_handle;
+    if (0 != password_length)
+        memcpy(mock->password, password, password_length);
+    mock->password_length = password_length;
+    mock->get_random = get_random;
+
+    ecp_ZZZ_random_mod_order(&mock->private_key, get_random);
+    ecp_ZZZ_set_to_generator(&mock->public_key);
+    ECP_ZZZ_mul(&mock->public_key, mock->private_key);
+
+    return 0;
+}
+
+TSS2_TCTI_CONTEXT *tcti_mock_ZZZ_tcti(struct tcti_mock_ZZZ *mock)
+{
+    return (TSS2_TCTI_CONTEXT*)mock;
+}
+
+void tcti_mock_ZZZ_serialize_public_key(uint8_t *buffer_out, struct tcti_mock_ZZZ *mock)
+{
+    ecp_ZZZ_serialize(buffer_out, &mock->public_key);
+}
+
+void tcti_mock_ZZZ_set_latency(struct tcti_mock_ZZZ *mock,
+                               uint32_t commit_latency_usec,
+                               uint32_t sign_latency_usec)
+{
+    mock->commit_latency_usec = commit_latency_usec;
+    mock->sign_latency_usec = sign_latency_usec;
+}
+
+void tcti_mock_ZZZ_short_nonces(struct tcti_mock_ZZZ *mock, unsigned count)
+{
+    mock->short_nonces = count;
+}
+
+TSS2_RC mock_transmit(TSS2_TCTI_CONTEXT *tcti_context, size_t size, uint8_t const *command)
+{
+    struct tcti_mock_ZZZ *mock = (struct tcti_mock_ZZZ*)tcti_context;
+
+    if (NULL == mock || NULL == command)
+        return TSS2_TCTI_RC_BAD_REFERENCE;
+    if (mock->response_pending)
+        return TSS2_TCTI_RC_BAD_SEQUENCE;
+
+    ++mock->commands_received;
+
+    struct cursor cmd = {.buffer=(uint8_t*)command, .size=size, .offset=0, .error=0};
+    TPM2_ST tag = get_u16(&cmd);
+    uint32_t command_size = get_u32(&cmd);
+    TPM2_CC command_code = get_u32(&cmd);
+    if (cmd.error || command_size != size)
+        return TSS2_TCTI_RC_BAD_VALUE;
+
+    // Parameters are written after the 10-byte header and the 4-byte parameterSize
+    uint8_t params[TCTI_MOCK_BUFFER_SIZE];
+    struct cursor params_out = {.buffer=params, .size=sizeof(params) - 14 - 5, .offset=0, .error=0};
+
+    TPM2_RC rc;
+    uint32_t latency_usec = 0;
+    if (TPM2_ST_SESSIONS != tag) {
+        rc = TPM2_RC_AUTH_MISSING;
+    } else if (TPM2_CC_Commit == command_code) {
+        rc = execute_commit(mock, &cmd, &params_out);
+        latency_usec = mock->commit_latency_usec;
+    } else if (TPM2_CC_Sign == command_code) {
+        rc = execute_sign(mock, &cmd, &params_out);
+        latency_usec = mock->sign_latency_usec;
+    } else {
+        rc = TPM2_RC_COMMAND_CODE;
+    }
+
+    struct cursor rsp = {.buffer=mock->response, .size=sizeof(mock->response), .offset=0, .error=0};
+    if (TPM2_RC_SUCCESS == rc) {
+        put_u16(&rsp, TPM2_ST_SESSIONS);
+        put_u32(&rsp, 0);   // size, filled in below
+        put_u32(&rsp, TPM2_RC_SUCCESS);
+        put_u32(&rsp, (uint32_t)params_out.offset);
+        memcpy(mock->response + rsp.offset, params, params_out.offset);
+        rsp.offset += params_out.offset;
+
+        // Password session response: empty nonce, no attributes, empty hmac
+        put_tpm2b(&rsp, NULL, 0);
+        put_u8(&rsp, 0);
+        put_tpm2b(&rsp, NULL, 0);
+    } else {
+        put_u16(&rsp, TPM2_ST_NO_SESSIONS);
+        put_u32(&rsp, 0);
+        put_u32(&rsp, rc);
+    }
+    explicit_bzero(params, sizeof(params));
+
+    mock->response_size = rsp.offset;
+    rsp.offset = 2;
+    put_u32(&rsp, (uint32_t)mock->response_size);
+
+    mock->response_pending = 1;
+    mock->response_ready_ns = now_ns() + 1000ULL * latency_usec;
+
+    return TSS2_RC_SUCCESS;
+}
+
+TSS2_RC mock_receive(TSS2_TCTI_CONTEXT *tcti_context, size_t *size, uint8_t *response, int32_t timeout)
+{
+    struct tcti_mock_ZZZ *mock = (struct tcti_mock_ZZZ*)tcti_context;
+
+    if (NULL == mock || NULL == size)
+        return TSS2_TCTI_RC_BAD_REFERENCE;
+    if (!mock->response_pending)
+        return TSS2_TCTI_RC_BAD_SEQUENCE;
+
+    // A NULL response is a query for the response size
+    if (NULL == response) {
+        *size = mock->response_size;
+        return TSS2_RC_SUCCESS;
+    }
+    if (*size < mock->response_size)
+        return TSS2_TCTI_RC_INSUFFICIENT_BUFFER;
+
+    uint64_t now = now_ns();
+    if (now < mock->response_ready_ns) {
+        uint64_t remaining_ns = mock->response_ready_ns - now;
+        if (TSS2_TCTI_TIMEOUT_BLOCK == timeout) {
+            sleep_ns(remaining_ns);
+        } else if (1000000ULL * (uint64_t)timeout < remaining_ns) {
+            sleep_ns(1000000ULL * (uint64_t)timeout);
+            return TSS2_TCTI_RC_TRY_AGAIN;
+        } else {
+            sleep_ns(remaining_ns);
+        }
+    }
+
+    memcpy(response, mock->response, mock->response_size);
+    *size = mock->response_size;
+
+    explicit_bzero(mock->response, sizeof(mock->response));
+    mock->response_pending = 0;
+
+    return TSS2_RC_SUCCESS;
+}
+
+void mock_finalize(TSS2_TCTI_CONTEXT *tcti_context)
+{
+    struct tcti_mock_ZZZ *mock = (struct tcti_mock_ZZZ*)tcti_context;
+    if (NULL == mock)
+        return;
+
+    explicit_bzero(mock->password, sizeof(mock->password));
+    BIG_XXX_zero(mock->private_key);
+    explicit_bzero(mock->commits, sizeof(mock->commits));
+    explicit_bzero(mock->response, sizeof(mock->response));
+}
+
+TSS2_RC mock_cancel(TSS2_TCTI_CONTEXT *tcti_context)
+{
+    (void)tcti_context;
+    return TSS2_TCTI_RC_NOT_IMPLEMENTED;
+}
+
+TSS2_RC mock_get_poll_handles(TSS2_TCTI_CONTEXT *tcti_context, TSS2_TCTI_POLL_HANDLE *handles, size_t *num_handles)
+{
+    (void)tcti_context;
+    (void)handles;
+    (void)num_handles;
+    return TSS2_TCTI_RC_NOT_IMPLEMENTED;
+}
+
+TSS2_RC mock_set_locality(TSS2_TCTI_CONTEXT *tcti_context, uint8_t locality)
+{
+    (void)tcti_context;
+    (void)locality;
+    return TSS2_TCTI_RC_NOT_IMPLEMENTED;
+}
+
+TSS2_RC mock_make_sticky(TSS2_TCTI_CONTEXT *tcti_context, TPM2_HANDLE *handle, uint8_t sticky)
+{
+    (void)tcti_context;
+    (void)handle;
+    (void)sticky;
+    return TSS2_TCTI_RC_NOT_IMPLEMENTED;
+}
+
+TPM2_RC check_authorization(struct tcti_mock_ZZZ *mock, struct cursor *cmd)
+{
+    // One handle (the key), then one password session
+    TPM2_HANDLE handle = get_u32(cmd);
+    uint32_t auth_size = get_u32(cmd);
+    size_t auth_end = cmd->offset + auth_size;
+
+    TPM2_HANDLE session_handle = get_u32(cmd);
+    uint16_t nonce_size;
+    (void)get_tpm2b(cmd, &nonce_size);
+    (void)get_u8(cmd);
+    uint16_t hmac_size;
+    const uint8_t *hmac = get_tpm2b(cmd, &hmac_size);
+
+    if (cmd->error || cmd->offset != auth_end)
+        return TPM2_RC_SIZE;
+    if (handle != mock->key_handle)
+        return TPM2_RC_HANDLE;
+    if (TPM2_RS_PW != session_handle)
+        return TPM2_RC_AUTH_FAIL;
+    if (hmac_size != mock->password_length || 0 != memcmp(hmac, mock->password, hmac_size))
+        return TPM2_RC_AUTH_FAIL;
+
+    return TPM2_RC_SUCCESS;
+}
+
+TPM2_RC execute_commit(struct tcti_mock_ZZZ *mock, struct cursor *cmd, struct cursor *params_out)
+{
+    TPM2_RC rc = check_authorization(mock, cmd);
+    if (TPM2_RC_SUCCESS != rc)
+        return rc;
+
+    ECP_ZZZ P1;
+    int have_P1;
+    if (0 != get_point(&P1, cmd, &have_P1))
+        return TPM2_RC_ECC_POINT;
+
+    uint16_t s2_size;
+    const uint8_t *s2 = get_tpm2b(cmd, &s2_size);
+    uint16_t y2_size;
+    const uint8_t *y2_bytes = get_tpm2b(cmd, &y2_size);
+    if (cmd->error || cmd->offset != cmd->size)
+        return TPM2_RC_SIZE;
+    if ((0 == s2_size) != (0 == y2_size) || y2_size > MODBYTES_XXX)
+        return TPM2_RC_SIZE;
+
+    // P2 = (H(s2) mod p, y2)
+    ECP_ZZZ P2;
+    if (0 != s2_size) {
+        BIG_XXX x2;
+        big_XXX_from_two_message_hash(&x2, s2, s2_size, NULL, 0);
+        BIG_XXX modulus;
+        BIG_XXX_rcopy(modulus, Modulus_YYY);
+        BIG_XXX_mod(x2, modulus);
+
+        BIG_XXX y2;
+        BIG_XXX_fromBytesLen(y2, (char*)y2_bytes, y2_size);
+
+        if (1 != ECP_ZZZ_set(&P2, x2, y2))
+            return TPM2_RC_ECC_POINT;
+    }
+
+    // The commit array is indexed by the low bits of the counter,
+    //  so an unused commit is overwritten once the counter wraps around to its slot.
+    uint16_t counter = ++mock->commit_count;
+    unsigned slot = counter % TCTI_MOCK_MAX_COMMITS;
+    mock->commits[slot].in_use = 1;
+    mock->commits[slot].counter = counter;
+    ecp_ZZZ_random_mod_order(&mock->commits[slot].r, mock->get_random);
+
+    // K = [d]P2, L = [r]P2 (only with s2), E = [r]P1 (or [r]G)
+    ECP_ZZZ K, L, E;
+    if (0 != s2_size) {
+        ECP_ZZZ_copy(&K, &P2);
+        ECP_ZZZ_mul(&K, mock->private_key);
+        ECP_ZZZ_copy(&L, &P2);
+        ECP_ZZZ_mul(&L, mock->commits[slot].r);
+    }
+    if (have_P1)
+        ECP_ZZZ_copy(&E, &P1);
+    else
+        ecp_ZZZ_set_to_generator(&E);
+    ECP_ZZZ_mul(&E, mock->commits[slot].r);
+
+    if (0 != s2_size) {
+        put_point(params_out, &K);
+        put_point(params_out, &L);
+    } else {
+        put_tpm2b(params_out, NULL, 0);
+        put_tpm2b(params_out, NULL, 0);
+    }
+    put_point(params_out, &E);
+    put_u16(params_out, counter);
+
+    if (params_out->error)
+        return TPM2_RC_INSUFFICIENT;
+
+    return TPM2_RC_SUCCESS;
+}
+
+TPM2_RC execute_sign(struct tcti_mock_ZZZ *mock, struct cursor *cmd, struct cursor *params_out)
+{
+    TPM2_RC rc = check_authorization(mock, cmd);
+    if (TPM2_RC_SUCCESS != rc)
+        return rc;
+
+    uint16_t digest_size;
+    const uint8_t *digest = get_tpm2b(cmd, &digest_size);
+    uint16_t scheme = get_u16(cmd);
+    uint16_t hash_alg = get_u16(cmd);
+    uint16_t count = get_u16(cmd);
+    (void)get_u16(cmd);     // validation.tag
+    (void)get_u32(cmd);     // validation.hierarchy
+    uint16_t validation_digest_size;
+    (void)get_tpm2b(cmd, &validation_digest_size);
+    if (cmd->error || cmd->offset != cmd->size)
+        return TPM2_RC_SIZE;
+
+    if (TPM2_ALG_ECDAA != scheme)
+        return TPM2_RC_SCHEME;
+    if (TPM2_ALG_SHA256 != hash_alg)
+        return TPM2_RC_HASH;
+
+    // Each commit can be used for exactly one signature
+    unsigned slot = count % TCTI_MOCK_MAX_COMMITS;
+    if (!mock->commits[slot].in_use || count != mock->commits[slot].counter)
+        return TPM2_RC_VALUE;
+    mock->commits[slot].in_use = 0;
+
+    BIG_XXX curve_order;
+    BIG_XXX_rcopy(curve_order, CURVE_Order_ZZZ);
+
+    // n = RAND, a leading zero byte of which is trimmed off
+    BIG_XXX n;
+    ecp_ZZZ_random_mod_order(&n, mock->get_random);
+    uint8_t nonce[MODBYTES_XXX];
+    uint16_t nonce_size = MODBYTES_XXX;
+    BIG_XXX_toBytes((char*)nonce, n);
+    BIG_XXX_zero(n);
+    if (mock->short_nonces > 0) {
+        --mock->short_nonces;
+        nonce[0] = 0;
+    }
+    uint8_t *nonce_start = nonce;
+    while (nonce_size > 0 && 0 == *nonce_start) {
+        ++nonce_start;
+        --nonce_size;
+    }
+
+    // s = r + H(n | digest) * d
+    BIG_XXX T;
+    big_XXX_from_two_message_hash(&T, nonce_start, nonce_size, digest, digest_size);
+    BIG_XXX_mod(T, curve_order);
+    BIG_XXX s;
+    BIG_XXX_modmul(s, T, mock->private_key, curve_order);
+    BIG_XXX_add(s, s, mock->commits[slot].r);
+    BIG_XXX_mod(s, curve_order);
+    BIG_XXX_zero(mock->commits[slot].r);
+
+    uint8_t s_bytes[MODBYTES_XXX];
+    BIG_XXX_toBytes((char*)s_bytes, s);
+
+    put_u16(params_out, TPM2_ALG_ECDAA);
+    put_u16(params_out, TPM2_ALG_SHA256);
+    put_tpm2b(params_out, nonce_start, nonce_size);
+    put_tpm2b(params_out, s_bytes, MODBYTES_XXX);
+
+    BIG_XXX_zero(s);
+    explicit_bzero(s_bytes, sizeof(s_bytes));
+
+    if (params_out->error)
+        return TPM2_RC_INSUFFICIENT;
+
+    return TPM2_RC_SUCCESS;
+}
+
+int get_point(ECP_ZZZ *point_out, struct cursor *cur, int *present_out)
+{
+    uint16_t size = get_u16(cur);
+    *present_out = 0;
+    if (cur->error)
+        return -1;
+    if (0 == size)
+        return 0;
+
+    uint16_t x_size, y_size;
+    const uint8_t *x_bytes = get_tpm2b(cur, &x_size);
+    const uint8_t *y_bytes = get_tpm2b(cur, &y_size);
+    if (cur->error || x_size > MODBYTES_XXX || y_size > MODBYTES_XXX)
+        return -1;
+    if (0 == x_size && 0 == y_size)
+        return 0;
+
+    BIG_XXX x, y;
+    BIG_XXX_fromBytesLen(x, (char*)x_bytes, x_size);
+    BIG_XXX_fromBytesLen(y, (char*)y_bytes, y_size);
+    if (1 != ECP_ZZZ_set(point_out, x, y))
+        return -1;
+
+    *present_out = 1;
+    return 0;
+}
+
+void put_point(struct cursor *cur, ECP_ZZZ *point)
+{
+    BIG_XXX x, y;
+    ECP_ZZZ_get(x, y, point);
+
+    uint8_t x_bytes[MODBYTES_XXX];
+    uint8_t y_bytes[MODBYTES_XXX];
+    BIG_XXX_toBytes((char*)x_bytes, x);
+    BIG_XXX_toBytes((char*)y_bytes, y);
+
+    put_u16(cur, 4 + 2*MODBYTES_XXX);
+    put_tpm2b(cur, x_bytes, MODBYTES_XXX);
+    put_tpm2b(cur, y_bytes, MODBYTES_XXX);
+}
+
+uint8_t get_u8(struct cursor *cur)
+{
+    if (cur->error || cur->offset + 1 > cur->size) {
+        cur->error = 1;
+        return 0;
+    }
+    return cur->buffer[cur->offset++];
+}
+
+uint16_t get_u16(struct cursor *cur)
+{
+    uint16_t high = get_u8(cur);
+    return (uint16_t)((high << 8) | get_u8(cur));
+}
+
+uint32_t get_u32(struct cursor *cur)
+{
+    uint32_t high = get_u16(cur);
+    return (high << 16) | get_u16(cur);
+}
+
+const uint8_t *get_tpm2b(struct cursor *cur, uint16_t *size_out)
+{
+    *size_out = get_u16(cur);
+    if (cur->error || cur->offset + *size_out > cur->size) {
+        cur->error = 1;
+        *size_out = 0;
+        return NULL;
+    }
+    const uint8_t *data = cur->buffer + cur->offset;
+    cur->offset += *size_out;
+    return data;
+}
+
+void put_u8(struct cursor *cur, uint8_t value)
+{
+    if (cur->error || cur->offset + 1 > cur->size) {
+        cur->error = 1;
+        return;
+    }
+    cur->buffer[cur->offset++] = value;
+}
+
+void put_u16(struct cursor *cur, uint16_t value)
+{
+    put_u8(cur, (uint8_t)(value >> 8));
+    put_u8(cur, (uint8_t)value);
+}
+
+void put_u32(struct cursor *cur, uint32_t value)
+{
+    put_u16(cur, (uint16_t)(value >> 16));
+    put_u16(cur, (uint16_t)value);
+}
+
+void put_tpm2b(struct cursor *cur, const uint8_t *data, uint16_t size)
+{
+    put_u16(cur, size);
+    if (cur->error || cur->offset + size > cur->size) {
+        cur->error = 1;
+        return;
+    }
+    if (0 != size)
+        memcpy(cur->buffer + cur->offset, data, size);
+    cur->offset += size;
+}
+
+uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void sleep_ns(uint64_t duration_ns)
+{
+    struct timespec ts = {.tv_sec=(time_t)(duration_ns / 1000000000ULL),
+                          .tv_nsec=(long)(duration_ns % 1000000000ULL)};
+    while (0 != nanosleep(&ts, &ts))
+        ;
+}
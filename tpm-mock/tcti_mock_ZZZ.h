@@ -0,0 +1,123 @@
+/******************************************************************************
+ *
+ * Copyright 2017 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef ECDAA_TCTI_MOCK_ZZZ_H
+#define ECDAA_TCTI_MOCK_ZZZ_H
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ecdaa/rand.h>
+
+#include <tss2/tss2_tcti.h>
+
+#include <amcl/big_XXX.h>
+#include <amcl/ecp_ZZZ.h>
+
+#include <stdint.h>
+
+#ifndef TCTI_MOCK_MAX_COMMITS
+#define TCTI_MOCK_MAX_COMMITS 64
+#endif
+
+#define TCTI_MOCK_BUFFER_SIZE 4096
+
+/*
+ * In-process TCTI emulating the parts of a TPM used by libecdaa-tpm
+ *  (TPM2_Commit and TPM2_Sign, for one ECDAA key on TPM_ECC_BN_P256),
+ *  so the TPM code paths can be tested and benchmarked without a TPM or simulator.
+ *
+ * Responses become available `*_latency_usec` microseconds after the command is transmitted,
+ *  to mimic a real TPM's command latency.
+ *
+ * Pass `tcti_mock_ZZZ_tcti(&mock)` to `ecdaa_tpm_context_init` in place of a real TCTI context.
+ */
+struct tcti_mock_ZZZ {
+    TSS2_TCTI_CONTEXT_COMMON_V2 common;     // must be first
+
+    TPM2_HANDLE key_handle;
+    uint8_t password[64];
+    uint16_t password_length;
+    BIG_XXX private_key;
+    ECP_ZZZ public_key;
+    ecdaa_rand_func get_random;
+
+    uint32_t commit_latency_usec;
+    uint32_t sign_latency_usec;
+    unsigned short_nonces;
+
+    uint16_t commit_count;
+    struct {
+        int in_use;
+        uint16_t counter;
+        BIG_XXX r;
+    } commits[TCTI_MOCK_MAX_COMMITS];
+
+    uint8_t response[TCTI_MOCK_BUFFER_SIZE];
+    size_t response_size;
+    int response_pending;
+    uint64_t response_ready_ns;
+
+    unsigned long commands_received;
+};
+
+/*
+ * Create a mock TPM holding a fresh ECDAA key (chosen using `get_random`),
+ *  loaded at `key_handle` and authorized by `password`.
+ *
+ * Latencies default to 0.
+ *
+ * Returns:
+ * 0 on success
+ * -1 if `password_length` is too long
+ */
+int tcti_mock_ZZZ_init(struct tcti_mock_ZZZ *mock,
+                       TPM2_HANDLE key_handle,
+                       const char *password,
+                       uint16_t password_length,
+                       ecdaa_rand_func get_random);
+
+TSS2_TCTI_CONTEXT *tcti_mock_ZZZ_tcti(struct tcti_mock_ZZZ *mock);
+
+/*
+ * Serialize the mock TPM key's public key (as read from `pub_key.txt` for a real TPM).
+ *
+ * `buffer_out` must hold ECP_ZZZ_LENGTH bytes.
+ */
+void tcti_mock_ZZZ_serialize_public_key(uint8_t *buffer_out, struct tcti_mock_ZZZ *mock);
+
+/*
+ * Set the emulated latency of TPM2_Commit and TPM2_Sign.
+ */
+void tcti_mock_ZZZ_set_latency(struct tcti_mock_ZZZ *mock,
+                               uint32_t commit_latency_usec,
+                               uint32_t sign_latency_usec);
+
+/*
+ * Make the next `count` TPM2_Sign responses use a nonce that's one byte short
+ *  (as a real TPM does whenever the nonce's leading byte is zero).
+ */
+void tcti_mock_ZZZ_short_nonces(struct tcti_mock_ZZZ *mock, unsigned count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif